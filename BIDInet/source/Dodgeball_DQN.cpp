@@ -1,298 +1,183 @@
-#include "Settings.h"
-
-#if EXPERIMENT_SELECTION == EXPERIMENT_DODGEBALL_DQN
-
-#include <SFML/Window.hpp>
-#include <SFML/Graphics.hpp>
-
-#include <system/ComputeSystem.h>
-#include <system/ComputeProgram.h>
-
-#include <runner/Runner.h>
-
-#include <bidinet/BIDInet.h>
-
-#include <deep/CSRL.h>
-
-#include <convnet/DQN.h>
-#include <convnet/layers/InputLayer.h>
-#include <convnet/layers/ConvLayer.h>
-#include <convnet/layers/MaxPoolingLayer.h>
-
-#include <time.h>
-#include <iostream>
-#include <random>
-
-#include <deep/FERL.h>
-
-const float ballSpeed = 0.02f;
-const float ballRadius = 0.12f;
-const float agentRadius = 0.05f;
-const float agentSpeed = 0.03f;
-const float agentFieldRadius = 0.3f;
-const float agentFieldOutlineWidth = 0.005f;
-const float attraction = -0.0005f;//0.002f;
-const float ballVelocityDecay = 0.1f;// 0.04f;
-
-std::vector<sf::Vector2f> dodgeballPositions;
-std::vector<sf::Vector2f> dodgeballVelocities;
-sf::Vector2f agentPosition;
-
-void renderScene(sf::RenderTarget &rt) {
-	sf::Vector2f size = sf::Vector2f(rt.getSize().x, rt.getSize().y);
-
-	sf::RectangleShape r;
-
-	r.setFillColor(sf::Color::Transparent);
-	r.setOutlineColor(sf::Color::Green);
-	r.setOutlineThickness(size.x * agentFieldOutlineWidth);
-	r.setSize(sf::Vector2f(agentFieldRadius * size.x * 2.0f, agentFieldRadius * size.y * 2.0f));
-
-	r.setOrigin(r.getSize() * 0.5f);
-	r.setPosition(0.5f * size.x, 0.5f * size.y);
-
-	rt.draw(r);
-
-	for (int i = 0; i < dodgeballPositions.size(); i++) {
-		sf::CircleShape c;
-
-		c.setRadius(1.0f);
-		c.setOrigin(1.0f, 1.0f);
-		c.setScale(ballRadius * size.x, ballRadius * size.y);
-		c.setPosition(dodgeballPositions[i].x * size.x, rt.getSize().y - dodgeballPositions[i].y * size.y);
-		c.setFillColor(sf::Color::Red);
-
-		rt.draw(c);
-	}
-
-	{
-		sf::CircleShape c;
-
-		c.setRadius(1.0f);
-		c.setOrigin(1.0f, 1.0f);
-		c.setScale(agentRadius * size.x, agentRadius * size.y);
-		c.setPosition(agentPosition.x * size.x, rt.getSize().y - agentPosition.y * size.y);
-		c.setFillColor(sf::Color::Green);
-
-		rt.draw(c);
-	}
-}
-
-int main() {
-	std::mt19937 generator(time(nullptr));
-
-	dodgeballPositions.resize(1);
-	dodgeballVelocities.resize(dodgeballPositions.size());
-
-	std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
-
-	for (int i = 0; i < dodgeballPositions.size(); i++) {
-		dodgeballPositions[i] = sf::Vector2f(dist01(generator), dist01(generator));
-
-		dodgeballVelocities[i].x = dist01(generator) * 2.0f - 1.0f;
-		dodgeballVelocities[i].y = dist01(generator) * 2.0f - 1.0f;
-
-		dodgeballVelocities[i] = dodgeballVelocities[i] * (ballSpeed / std::sqrt(dodgeballVelocities[i].x * dodgeballVelocities[i].x + dodgeballVelocities[i].y * dodgeballVelocities[i].y));
-	}
-
-	agentPosition = sf::Vector2f(0.5f, 0.5f);
-
-	sf::RenderWindow window;
-
-	window.create(sf::VideoMode(800, 800), "BIDInet", sf::Style::Default);
-
-	window.setFramerateLimit(60);
-	window.setVerticalSyncEnabled(true);
-
-	sf::RenderTexture visionRT;
-
-	visionRT.create(16, 16);
-
-	convnet::DQN agent;
-
-	std::shared_ptr<convnet::InputLayer> inputLayer = std::make_shared<convnet::InputLayer>();
-	std::shared_ptr<convnet::ConvLayer> conv1 = std::make_shared<convnet::ConvLayer>();
-	std::shared_ptr<convnet::MaxPoolingLayer> max1 = std::make_shared<convnet::MaxPoolingLayer>();
-	std::shared_ptr<convnet::ConvLayer> conv2 = std::make_shared<convnet::ConvLayer>();
-	std::shared_ptr<convnet::MaxPoolingLayer> max2 = std::make_shared<convnet::MaxPoolingLayer>();
-
-	inputLayer->create(16, 16, 1);
-	conv1->create(*inputLayer, 8, 8, 4, 4, 2, -0.01f, 0.01f, generator);
-	max1->create(*conv1, 4, 4, 3, 2, 2);
-	conv2->create(*max1, 2, 2, 5, 5, 5, -0.01f, 0.01f, generator);
-	max2->create(*conv2, 2, 2, 5, 2, 2);
-
-	agent._net.addLayer(inputLayer);
-	agent._net.addLayer(conv1);
-	agent._net.addLayer(max1);
-	agent._net.addLayer(conv2);
-	agent._net.addLayer(max2);
-
-	agent._net.create(32, 3, -0.01f, 0.01f, generator);
-
-	// ---------------------------- Game Loop -----------------------------
-
-	bool quit = false;
-
-	sf::Clock clock;
-
-	float dt = 0.017f;
-
-	float averageReward = 0.0f;
-	const float averageRewardDecay = 0.003f;
-
-	int steps = 0;
-
-	do {
-		clock.restart();
-
-		// ----------------------------- Input -----------------------------
-
-		sf::Event windowEvent;
-
-		while (window.pollEvent(windowEvent))
-		{
-			switch (windowEvent.type)
-			{
-			case sf::Event::Closed:
-				quit = true;
-				break;
-			}
-		}
-
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
-			quit = true;
-
-		visionRT.clear();
-
-		renderScene(visionRT);
-
-		visionRT.display();
-
-		sf::Image img = visionRT.getTexture().copyToImage();
-
-		std::vector<float> inputs(256);
-
-		for (int x = 0; x < img.getSize().x; x++)
-			for (int y = 0; y < img.getSize().y; y++) {
-				sf::Color c = img.getPixel(x, y);
-
-				float val = 0.0f;
-
-				if (c.r > 0)
-					val = 0.5f;
-
-				if (c.g > 0)
-					val = 1.0f;
-
-				inputs[x + y * img.getSize().x] = val;
-
-				inputLayer->getOutputMaps().front().atXY(x, y) = val;
-			}
-
-		float reward = 0.5f;
-
-		for (int i = 0; i < dodgeballPositions.size(); i++) {
-			sf::Vector2f delta = dodgeballPositions[i] - agentPosition;
-
-			float dist = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-
-			//if (dist < (ballRadius + agentRadius)) {
-			reward += -dist;
-			//}
-		}
-
-		averageReward = (1.0f - averageRewardDecay) * averageReward + averageRewardDecay * reward;
-
-		agent.simStep(reward, generator);
-
-		agentPosition.x += agentSpeed * (agent.getExploratoryAction(0));
-		agentPosition.y += agentSpeed * (agent.getExploratoryAction(1));
-
-		agentPosition.x = std::min(0.5f + agentFieldRadius - agentRadius, std::max(0.5f - agentFieldRadius + agentRadius, agentPosition.x));
-		agentPosition.y = std::min(0.5f + agentFieldRadius - agentRadius, std::max(0.5f - agentFieldRadius + agentRadius, agentPosition.y));
-
-		for (int i = 0; i < dodgeballPositions.size(); i++) {
-			sf::Vector2f delta = agentPosition - dodgeballPositions[i];
-
-			float dist = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-
-			dodgeballVelocities[i] += -dodgeballVelocities[i] * ballVelocityDecay + delta / dist * attraction;
-
-			dodgeballPositions[i] += dodgeballVelocities[i];
-
-			if (dodgeballPositions[i].x < 0.5f - agentFieldRadius + ballRadius) {
-				dodgeballPositions[i].x = 0.5f - agentFieldRadius + ballRadius;
-				dodgeballVelocities[i].x *= -1.0f;
-			}
-			else if (dodgeballPositions[i].x > 0.5f + agentFieldRadius - ballRadius) {
-				dodgeballPositions[i].x = 0.5f + agentFieldRadius - ballRadius;
-				dodgeballVelocities[i].x *= -1.0f;
-			}
-
-			if (dodgeballPositions[i].y < 0.5f - agentFieldRadius + ballRadius) {
-				dodgeballPositions[i].y = 0.5f - agentFieldRadius + ballRadius;
-				dodgeballVelocities[i].y *= -1.0f;
-			}
-			else if (dodgeballPositions[i].y > 0.5f + agentFieldRadius - ballRadius) {
-				dodgeballPositions[i].y = 0.5f + agentFieldRadius - ballRadius;
-				dodgeballVelocities[i].y *= -1.0f;
-			}
-		}
-
-		if (!sf::Keyboard::isKeyPressed(sf::Keyboard::T)) {
-			window.clear();
-
-			renderScene(window);
-
-			sf::Sprite vis;
-
-			vis.setTexture(visionRT.getTexture());
-
-			vis.setScale(4.0f, 4.0f);
-
-			window.draw(vis);
-
-			sf::Image img;
-
-			img.create(agent._net.getLayer(1)->getOutputMaps()[0].getWidth(), agent._net.getLayer(1)->getOutputMaps()[0].getHeight());
-
-			for (int x = 0; x < 8; x++)
-				for (int y = 0; y < 8; y++) {
-					sf::Color c = sf::Color::White;
-
-					c.r = c.g = c.b = 255.0f * std::min(1.0f, std::max(0.0f, 2.0f * agent._net.getLayer(1)->getOutputMaps()[0].atXY(x, y)));
-
-					img.setPixel(x, y, c);
-				}
-
-			sf::Texture tex;
-
-			tex.loadFromImage(img);
-
-			sf::Sprite t;
-
-			t.setTexture(tex);
-
-			t.setPosition(sf::Vector2f(0.0f, window.getSize().y - 16 * 4.0f));
-
-			t.setScale(4.0f, 4.0f);
-
-			window.draw(t);
-			
-			window.display();
-		}
-
-		if (steps % 100 == 0)
-			std::cout << "Steps: " << steps << " Average Reward: " << averageReward << std::endl;
-
-		//dt = clock.getElapsedTime().asSeconds();
-
-		steps++;
-
-	} while (!quit);
-
-	return 0;
-}
-
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_DODGEBALL_DQN
+
+#include <SFML/Window.hpp>
+#include <SFML/Graphics.hpp>
+
+#include <system/ComputeSystem.h>
+#include <system/ComputeProgram.h>
+#include <system/ThreadPool.h>
+
+#include <runner/Runner.h>
+
+#include <bidinet/BIDInet.h>
+
+#include <deep/CSRL.h>
+
+#include <convnet/DQN.h>
+#include <convnet/layers/InputLayer.h>
+#include <convnet/layers/ConvPoolLayer.h>
+
+#include <time.h>
+#include <iostream>
+#include <random>
+
+#include <deep/FERL.h>
+
+#include <dodgeball/Dodgeball.h>
+#include <vis/DodgeballVisualizer.h>
+#include <vis/VisualizationThread.h>
+
+struct Snapshot {
+	vis::DodgeballSnapshot _game;
+
+	// First map of the first hidden layer
+	std::vector<float> _features;
+	int _featuresWidth, _featuresHeight;
+};
+
+int main() {
+	std::mt19937 generator(time(nullptr));
+
+	Dodgeball dodgeball;
+
+	dodgeball.reset(1, generator);
+
+	const int visionSize = 16;
+
+	vis::VisualizationThread<Snapshot> visualizer;
+
+	visualizer.start(800, 800, "BIDInet", nullptr, [](sf::RenderWindow &window, const Snapshot &snapshot) {
+		vis::renderDodgeballSnapshot(window, snapshot._game, 4.0f);
+
+		sf::Image img;
+
+		img.create(snapshot._featuresWidth, snapshot._featuresHeight);
+
+		for (int x = 0; x < img.getSize().x; x++)
+			for (int y = 0; y < img.getSize().y; y++) {
+				sf::Color c = sf::Color::White;
+
+				c.r = c.g = c.b = 255.0f * std::min(1.0f, std::max(0.0f, 2.0f * snapshot._features[x + y * snapshot._featuresWidth]));
+
+				img.setPixel(x, y, c);
+			}
+
+		sf::Texture tex;
+
+		tex.loadFromImage(img);
+
+		sf::Sprite t;
+
+		t.setTexture(tex);
+
+		t.setPosition(sf::Vector2f(0.0f, window.getSize().y - 16 * 4.0f));
+
+		t.setScale(4.0f, 4.0f);
+
+		window.draw(t);
+	});
+
+	convnet::DQN agent;
+
+	std::shared_ptr<convnet::InputLayer> inputLayer = std::make_shared<convnet::InputLayer>();
+	std::shared_ptr<convnet::ConvPoolLayer> convPool1 = std::make_shared<convnet::ConvPoolLayer>();
+	std::shared_ptr<convnet::ConvPoolLayer> convPool2 = std::make_shared<convnet::ConvPoolLayer>();
+
+	inputLayer->create(16, 16, 1);
+	convPool1->create(*inputLayer, 8, 8, 4, 4, 2, 4, 4, 3, 2, 2, -0.01f, 0.01f, generator);
+	convPool2->create(*convPool1, 2, 2, 5, 5, 5, 2, 2, 5, 2, 2, -0.01f, 0.01f, generator);
+
+	agent._net.addLayer(inputLayer);
+	agent._net.addLayer(convPool1);
+	agent._net.addLayer(convPool2);
+
+	agent._net.create(32, 3, -0.01f, 0.01f, generator);
+
+	// Action selection is a single sample, so spread each pass over all cores
+	std::shared_ptr<sys::ThreadPool> threadPool = std::make_shared<sys::ThreadPool>();
+
+	threadPool->create();
+
+	agent._net.setThreadPool(threadPool);
+
+	// ---------------------------- Game Loop -----------------------------
+
+	bool quit = false;
+
+	sf::Clock clock;
+
+	float dt = 0.017f;
+
+	float averageReward = 0.0f;
+	const float averageRewardDecay = 0.003f;
+
+	int steps = 0;
+
+	do {
+		clock.restart();
+
+		// ----------------------------- Input -----------------------------
+
+		if (visualizer.isClosed())
+			quit = true;
+
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
+			quit = true;
+
+		std::vector<float> observation(visionSize * visionSize);
+
+		dodgeball.render(observation.data(), visionSize, visionSize);
+
+		std::vector<float> inputs(256);
+
+		for (int x = 0; x < visionSize; x++)
+			for (int y = 0; y < visionSize; y++) {
+				float val = observation[x + y * visionSize];
+
+				inputs[x + y * visionSize] = val;
+
+				inputLayer->getOutputMaps().front().atXY(x, y) = val;
+			}
+
+		float reward = dodgeball.getReward();
+
+		averageReward = (1.0f - averageRewardDecay) * averageReward + averageRewardDecay * reward;
+
+		agent.simStep(reward, generator);
+
+		dodgeball.step(agent.getExploratoryAction(0), agent.getExploratoryAction(1));
+
+		if (visualizer.wantsSnapshot()) {
+			Snapshot &snapshot = visualizer.getSnapshot();
+
+			snapshot._game.set(dodgeball, observation, visionSize, visionSize);
+
+			const convnet::Map &features = agent._net.getLayer(1)->getOutputMaps()[0];
+
+			snapshot._featuresWidth = features.getWidth();
+			snapshot._featuresHeight = features.getHeight();
+
+			snapshot._features.resize(snapshot._featuresWidth * snapshot._featuresHeight);
+
+			for (int x = 0; x < snapshot._featuresWidth; x++)
+				for (int y = 0; y < snapshot._featuresHeight; y++)
+					snapshot._features[x + y * snapshot._featuresWidth] = features.atXY(x, y);
+
+			visualizer.publish();
+		}
+
+		if (steps % 100 == 0)
+			std::cout << "Steps: " << steps << " Average Reward: " << averageReward << std::endl;
+
+		//dt = clock.getElapsedTime().asSeconds();
+
+		steps++;
+
+	} while (!quit);
+
+	return 0;
+}
+
 #endif
\ No newline at end of file
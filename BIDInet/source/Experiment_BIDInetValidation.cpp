@@ -0,0 +1,176 @@
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_BIDINET_VALIDATION
+
+#include <bidinet/BIDInet.h>
+#include <bidinet/BIDInetHost.h>
+
+#include <system/ComputeSystem.h>
+#include <system/ComputeProgram.h>
+#include <system/ThreadPool.h>
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+static float maxDifference(const std::vector<float> &a, const std::vector<float> &b) {
+	float difference = 0.0f;
+
+	for (int i = 0; i < a.size(); i++)
+		difference = std::max(difference, std::abs(a[i] - b[i]));
+
+	return difference;
+}
+
+// Runs the OpenCL hierarchy (preferably on a CPU device such as PoCL) next to its host reference on the same inputs
+// and random streams, and reports how far apart they are. Returns 2 if any difference exceeded its tolerance
+int main() {
+	sys::ComputeSystem cs;
+
+	if (!cs.create(sys::ComputeSystem::_cpu) && !cs.create(sys::ComputeSystem::_all))
+		return 1;
+
+	std::cout << "Device: " << cs.getDeviceName() << std::endl;
+
+	sys::ComputeProgram program;
+
+	if (!program.loadFromFile("resources/bidinet.cl", cs))
+		return 1;
+
+	const int inputWidth = 16;
+	const int inputHeight = 16;
+
+	std::vector<bidi::InputType> inputTypes(inputWidth * inputHeight, bidi::_state);
+
+	// Last row is driven by the actions
+	for (int x = 0; x < inputWidth; x++)
+		inputTypes[x + (inputHeight - 1) * inputWidth] = bidi::_action;
+
+	std::vector<bidi::LayerDesc> layerDescs(3);
+
+	layerDescs[0]._width = 32;
+	layerDescs[0]._height = 32;
+
+	layerDescs[1]._width = 16;
+	layerDescs[1]._height = 16;
+
+	layerDescs[2]._width = 8;
+	layerDescs[2]._height = 8;
+
+	bidi::InputDesc inputDesc;
+
+	std::mt19937 clGenerator(1234);
+	std::mt19937 hostGenerator(1234);
+
+	bidi::BIDInet bidinet;
+
+	if (!bidinet.createRandom(cs, program, inputWidth, inputHeight, inputTypes, inputDesc, layerDescs, -0.1f, 0.1f, clGenerator))
+		return 1;
+
+	bidi::BIDInetHost reference;
+
+	reference.createRandom(inputWidth, inputHeight, inputTypes, inputDesc, layerDescs, -0.1f, 0.1f, hostGenerator);
+
+	std::shared_ptr<sys::ThreadPool> threadPool = std::make_shared<sys::ThreadPool>();
+
+	threadPool->create();
+
+	reference.setThreadPool(threadPool);
+
+	const int numSteps = 200;
+
+	// Both sides compute the same expressions in the same order, so only rounding in the device's math functions is allowed
+	// for. A flipped feed forward bit is a threshold landing on the other side, which should stay rare
+	const float predictionTolerance = 0.001f;
+	const float actionTolerance = 0.001f;
+	const float fbTolerance = 0.001f;
+	const float maxFlipRate = 0.005f;
+
+	float worstPrediction = 0.0f;
+	float worstAction = 0.0f;
+	float worstFB = 0.0f;
+	float worstFlipRate = 0.0f;
+
+	std::vector<float> inputs(inputWidth * inputHeight);
+	std::vector<float> states;
+
+	double clSeconds = 0.0;
+	double hostSeconds = 0.0;
+
+	for (int s = 0; s < numSteps; s++) {
+		// Bar sweeping across the inputs
+		for (int x = 0; x < inputWidth; x++)
+			for (int y = 0; y < inputHeight; y++)
+				inputs[x + y * inputWidth] = std::abs(x - (s % inputWidth)) <= 1 ? 1.0f : 0.0f;
+
+		float reward = bidinet.getAction(s % inputWidth + (inputHeight - 1) * inputWidth);
+
+		bidinet.setInputs(inputs.data());
+		reference.setInputs(inputs.data());
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		bidinet.simStep(cs, reward, clGenerator);
+
+		std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+
+		reference.simStep(reward, hostGenerator);
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		clSeconds += std::chrono::duration<double>(middle - start).count();
+		hostSeconds += std::chrono::duration<double>(end - middle).count();
+
+		bool report = s % 20 == 0 || s == numSteps - 1;
+
+		float predictionDifference = maxDifference(bidinet.getPredictions(), reference.getPredictions());
+		float actionDifference = maxDifference(bidinet.getActions(), reference.getActions());
+
+		worstPrediction = std::max(worstPrediction, predictionDifference);
+		worstAction = std::max(worstAction, actionDifference);
+
+		if (report)
+			std::cout << "Step " << s << ": predictions " << predictionDifference << " actions " << actionDifference;
+
+		for (int l = 0; l < layerDescs.size(); l++) {
+			bidinet.readFFStates(cs, l, states);
+
+			int numFlipped = 0;
+
+			for (int i = 0; i < states.size(); i++)
+				if (states[i] != reference.getLayers()[l]._ffStates[i])
+					numFlipped++;
+
+			worstFlipRate = std::max(worstFlipRate, static_cast<float>(numFlipped) / states.size());
+
+			bidinet.readFBStates(cs, l, states);
+
+			float fbDifference = maxDifference(states, reference.getLayers()[l]._fbStates);
+
+			worstFB = std::max(worstFB, fbDifference);
+
+			if (report)
+				std::cout << " | layer " << l << ": " << numFlipped << " ff flips, fb " << fbDifference;
+		}
+
+		if (report)
+			std::cout << std::endl;
+	}
+
+	std::cout << "OpenCL: " << clSeconds * 1000.0 / numSteps << " ms/step, host (" << threadPool->getNumThreads() << " threads): " << hostSeconds * 1000.0 / numSteps << " ms/step" << std::endl;
+
+	std::cout << "Worst: predictions " << worstPrediction << " actions " << worstAction << " fb " << worstFB << " ff flip rate " << worstFlipRate << std::endl;
+
+	if (worstPrediction > predictionTolerance || worstAction > actionTolerance || worstFB > fbTolerance || worstFlipRate > maxFlipRate) {
+		std::cerr << "OpenCL backend diverges from the host reference" << std::endl;
+
+		return 2;
+	}
+
+	std::cout << "OpenCL backend matches the host reference" << std::endl;
+
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_EVALUATION
+
+#include <sdr/PredictionEvaluator.h>
+
+#include <data/TimeSeries.h>
+
+#include <system/ThreadPool.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+
+// Headless sweep over hierarchy settings, the results table goes to resources/evaluation.csv
+int main() {
+	data::TimeSeries dataset;
+
+	if (!dataset.load("resources/data.txt", "resources/data.bin")) {
+		std::cerr << "Could not open data.txt!" << std::endl;
+
+		return 1;
+	}
+
+	dataset.normalize();
+
+	std::cout << "Loaded " << dataset.getNumRows() << " rows of " << dataset.getNumColumns() << " columns" << std::endl;
+
+	// Smallest square input that holds a row
+	int inputSize = 1;
+
+	while (inputSize * inputSize < dataset.getNumColumns())
+		inputSize++;
+
+	const int settleIters[] = { 10, 20, 30 };
+	const int layerSizes[] = { 8, 12, 16 };
+	const int radii[] = { 2, 3 };
+
+	std::vector<sdr::PredictionEvaluator::Config> configs;
+
+	for (int s = 0; s < 3; s++)
+		for (int w = 0; w < 3; w++)
+			for (int r = 0; r < 2; r++) {
+				sdr::PredictionEvaluator::Config config;
+
+				config._inputWidth = inputSize;
+				config._inputHeight = inputSize;
+
+				for (int l = 0; l < config._layerDescs.size(); l++) {
+					config._layerDescs[l]._width = config._layerDescs[l]._height = std::max(4, layerSizes[w] - 4 * l);
+
+					config._layerDescs[l]._sdrIterSettle = settleIters[s];
+
+					config._layerDescs[l]._receptiveRadius = radii[r];
+					config._layerDescs[l]._recurrentRadius = radii[r];
+					config._layerDescs[l]._lateralRadius = radii[r];
+				}
+
+				std::ostringstream name;
+
+				name << "settle" << settleIters[s] << "_size" << layerSizes[w] << "_radius" << radii[r];
+
+				config._name = name.str();
+
+				configs.push_back(config);
+			}
+
+	sys::ThreadPool pool;
+
+	pool.create();
+
+	std::cout << "Evaluating " << configs.size() << " configurations on " << pool.getNumThreads() << " threads" << std::endl;
+
+	sdr::PredictionEvaluator evaluator;
+
+	evaluator._numPasses = 2;
+
+	std::vector<sdr::PredictionEvaluator::Result> results;
+
+	evaluator.evaluate(configs, dataset, results, &pool);
+
+	sdr::PredictionEvaluator::writeResults(std::cout, results);
+
+	std::ofstream toFile("resources/evaluation.csv");
+
+	sdr::PredictionEvaluator::writeResults(toFile, results);
+
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_EVOLUTION
+
+#include <runner/Runner.h>
+
+#include <deep/FERLEvolver.h>
+
+#include <time.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <random>
+#include <algorithm>
+
+// Headless Runner episode, fitness is the distance covered
+float evaluateRunner(deep::FERL &agent, std::mt19937 &generator) {
+	const int episodeSteps = 600;
+	const int clockCount = 4;
+
+	const float maxRunnerBodyAngle = 0.3f;
+	const float runnerBodyAngleStab = 10.0f;
+
+	std::shared_ptr<b2World> world = std::make_shared<b2World>(b2Vec2(0.0f, -9.81f));
+
+	const float groundWidth = 5000.0f;
+	const float groundHeight = 5.0f;
+
+	b2BodyDef groundBodyDef;
+	groundBodyDef.position.Set(0.0f, 0.0f);
+
+	b2Body* groundBody = world->CreateBody(&groundBodyDef);
+
+	b2PolygonShape groundBox;
+	groundBox.SetAsBox(groundWidth * 0.5f, groundHeight * 0.5f);
+
+	groundBody->CreateFixture(&groundBox, 0.0f);
+
+	Runner runner;
+
+	runner.createDefault(world, b2Vec2(0.0f, 2.762f), 0.0f, 1);
+
+	float startX = runner._pBody->GetPosition().x;
+
+	std::vector<float> state;
+	std::vector<float> action(agent.getNumAction());
+
+	for (int steps = 0; steps < episodeSteps; steps++) {
+		float reward = runner._pBody->GetLinearVelocity().x;
+
+		runner.getStateVector(state);
+
+		for (int a = 0; a < clockCount; a++)
+			state.push_back(std::sin(steps / 60.0f * 2.0f * a * 2.0f * 3.141596f));
+
+		// Bias
+		state.push_back(1.0f);
+
+		agent.step(state, action, reward, 0.5f, 0.99f, 0.98f, 0.05f, 16, 8, 0.05f, 0.01f, 0.05f, 600, 16, 0.01f, generator, true);
+
+		for (int i = 0; i < action.size(); i++)
+			action[i] = action[i] * 0.5f + 0.5f;
+
+		runner.motorUpdate(action, 12.0f);
+
+		// Keep upright
+		if (std::abs(runner._pBody->GetAngle()) > maxRunnerBodyAngle)
+			runner._pBody->SetAngularVelocity(-runnerBodyAngleStab * runner._pBody->GetAngle());
+
+		world->ClearForces();
+
+		world->Step(1.0f / 60.0f, 64, 64);
+	}
+
+	return runner._pBody->GetPosition().x - startX;
+}
+
+int main() {
+	std::mt19937 generator(time(nullptr));
+
+	const int populationSize = 64;
+	const int numGenerations = 1000;
+	const int checkpointInterval = 10;
+
+	const int numState = 3 + 3 + 2 + 2 + 1 + 2 + 2 + 4 + 1;
+	const int numAction = 3 + 3 + 2 + 2;
+
+	std::shared_ptr<sys::ThreadPool> threadPool = std::make_shared<sys::ThreadPool>();
+
+	threadPool->create();
+
+	deep::FERLEvolver evolver;
+
+	evolver.setThreadPool(threadPool);
+
+	// Continue from the last checkpoint if there is one
+	std::ifstream fromFile("resources/evolution.bin", std::ios::binary);
+
+	if (fromFile.is_open() && evolver.loadFromFile(fromFile))
+		std::cout << "Resuming at generation " << evolver.getGeneration() << std::endl;
+	else
+		evolver.createRandom(populationSize, numState, numAction, 32, 0.05f, generator);
+
+	fromFile.close();
+
+	std::cout << "Evaluating on " << threadPool->getNumThreads() << " threads" << std::endl;
+
+	while (evolver.getGeneration() < numGenerations) {
+		evolver.evaluate(evaluateRunner);
+
+		float averageFitness = 0.0f;
+
+		for (int i = 0; i < evolver.getPopulationSize(); i++)
+			averageFitness += evolver.getIndividual(i)._fitness;
+
+		averageFitness /= evolver.getPopulationSize();
+
+		std::cout << "Generation " << evolver.getGeneration() << " best " << evolver.getBest()._fitness << " average " << averageFitness << std::endl;
+
+		if (evolver.getGeneration() % checkpointInterval == 0) {
+			std::ofstream toFile("resources/evolution.bin", std::ios::binary);
+
+			evolver.saveToFile(toFile);
+
+			std::ofstream bestToFile("resources/evolution_gen" + std::to_string(evolver.getGeneration()) + "_best.bin", std::ios::binary);
+
+			evolver.getBest()._agent.saveToFile(bestToFile);
+		}
+
+		evolver.nextGeneration(generator);
+	}
+
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_POLICY_ROLLOUTS
+
+#include <deep/CSRL.h>
+#include <deep/CSRLPolicy.h>
+#include <neo/AgentPolicy.h>
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+// Steps a branch for the given number of steps on the same state inputs as every other branch, taking action (if not
+// negative) on every action input instead of the policy's own predictions
+static void rollout(deep::CSRLPolicy &branch, const std::vector<deep::CSRL::InputType> &inputTypes, int start, int steps, float action) {
+	for (int t = start; t < start + steps; t++) {
+		for (int i = 0; i < inputTypes.size(); i++)
+			if (inputTypes[i] == deep::CSRL::_state)
+				branch.setInput(i, std::sin(t * 0.1f + i * 0.3f) * 0.5f + 0.5f);
+
+		branch.simStep(0.0f);
+
+		if (action >= 0.0f)
+			for (int i = 0; i < inputTypes.size(); i++)
+				if (inputTypes[i] == deep::CSRL::_action)
+					branch.setAction(i, action);
+	}
+}
+
+// Same for a neo::AgentPolicy, which has no action inputs: the first row is set to action instead
+static void rollout(neo::AgentPolicy &branch, int width, int start, int steps, float action) {
+	for (int t = start; t < start + steps; t++) {
+		for (int i = width; i < branch.getNumInputs(); i++)
+			branch.setInput(i, std::sin(t * 0.1f + i * 0.3f) * 0.5f + 0.5f);
+
+		branch.simStep();
+
+		if (action >= 0.0f)
+			for (int i = 0; i < width; i++)
+				branch.setInput(i, action);
+	}
+}
+
+template<class T>
+static float maxDifference(const T &a, const T &b) {
+	float difference = 0.0f;
+
+	for (int i = 0; i < a.getNumInputs(); i++)
+		difference = std::max(difference, std::abs(a.getPrediction(i) - b.getPrediction(i)));
+
+	return difference;
+}
+
+// Forks of one exported policy that are given different action sequences must diverge, forks that follow the policy must not
+int main() {
+	std::mt19937 generator(1234);
+
+	const int inputWidth = 8;
+	const int inputHeight = 8;
+
+	std::vector<deep::CSRL::InputType> inputTypes(inputWidth * inputHeight, deep::CSRL::_state);
+
+	// Last row is driven by the actions
+	for (int x = 0; x < inputWidth; x++)
+		inputTypes[x + (inputHeight - 1) * inputWidth] = deep::CSRL::_action;
+
+	std::vector<deep::CSRL::LayerDesc> layerDescs(2);
+
+	layerDescs[0]._width = 8;
+	layerDescs[0]._height = 8;
+
+	layerDescs[1]._width = 6;
+	layerDescs[1]._height = 6;
+
+	deep::CSRL agent;
+
+	agent.createRandom(inputWidth, inputHeight, 4, inputTypes, layerDescs, -0.01f, 0.01f, 0.01f, 0.05f, 0.1f, generator);
+
+	const int trainSteps = 200;
+
+	for (int t = 0; t < trainSteps; t++) {
+		for (int i = 0; i < inputTypes.size(); i++)
+			if (inputTypes[i] == deep::CSRL::_state)
+				agent.setInput(i, std::sin(t * 0.1f + i * 0.3f) * 0.5f + 0.5f);
+
+		agent.simStep(std::sin(t * 0.05f), generator);
+	}
+
+	deep::CSRLPolicy policy;
+
+	agent.exportPolicy(policy);
+
+	const int rolloutSteps = 20;
+
+	deep::CSRLPolicy greedy0, greedy1, low, high;
+
+	policy.fork(greedy0);
+	policy.fork(greedy1);
+	policy.fork(low);
+	policy.fork(high);
+
+	rollout(greedy0, inputTypes, trainSteps, rolloutSteps, -1.0f);
+	rollout(greedy1, inputTypes, trainSteps, rolloutSteps, -1.0f);
+	rollout(low, inputTypes, trainSteps, rolloutSteps, 0.0f);
+	rollout(high, inputTypes, trainSteps, rolloutSteps, 1.0f);
+
+	float greedyDifference = maxDifference(greedy0, greedy1);
+	float actionDifference = maxDifference(low, high);
+
+	std::cout << "Greedy forks differ by " << greedyDifference << ", forks with different actions by " << actionDifference << std::endl;
+
+	// Same check on a neo::Agent
+	neo::Agent neoAgent;
+
+	neoAgent.createRandom(inputWidth, inputHeight, 4, std::vector<neo::Agent::LayerDesc>(layerDescs.size()), -0.01f, 0.01f, 0.01f, 0.05f, 0.1f, generator);
+
+	for (int t = 0; t < trainSteps; t++) {
+		for (int i = 0; i < neoAgent.getNumInputs(); i++)
+			neoAgent.setInput(i, std::sin(t * 0.1f + i * 0.3f) * 0.5f + 0.5f);
+
+		neoAgent.simStep(std::sin(t * 0.05f), generator);
+	}
+
+	neo::AgentPolicy neoPolicy;
+
+	neoAgent.exportPolicy(neoPolicy);
+
+	neo::AgentPolicy neoGreedy0, neoGreedy1, neoLow, neoHigh;
+
+	neoPolicy.fork(neoGreedy0);
+	neoPolicy.fork(neoGreedy1);
+	neoPolicy.fork(neoLow);
+	neoPolicy.fork(neoHigh);
+
+	rollout(neoGreedy0, inputWidth, trainSteps, rolloutSteps, -1.0f);
+	rollout(neoGreedy1, inputWidth, trainSteps, rolloutSteps, -1.0f);
+	rollout(neoLow, inputWidth, trainSteps, rolloutSteps, 0.0f);
+	rollout(neoHigh, inputWidth, trainSteps, rolloutSteps, 1.0f);
+
+	float neoGreedyDifference = maxDifference(neoGreedy0, neoGreedy1);
+	float neoActionDifference = maxDifference(neoLow, neoHigh);
+
+	std::cout << "Agent greedy forks differ by " << neoGreedyDifference << ", forks with different actions by " << neoActionDifference << std::endl;
+
+	if (greedyDifference != 0.0f || actionDifference == 0.0f || neoGreedyDifference != 0.0f || neoActionDifference == 0.0f) {
+		std::cout << "Rollout check failed" << std::endl;
+
+		return 1;
+	}
+
+	std::cout << "Rollout check passed" << std::endl;
+
+	return 0;
+}
+
+#endif
\ No newline at end of file
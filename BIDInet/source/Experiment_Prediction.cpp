@@ -1,159 +1,94 @@
-#include "Settings.h"
-
-#if EXPERIMENT_SELECTION == EXPERIMENT_PREDICTION
-
-#include <sdr/IPredictiveRSDR.h>
-
-#include <time.h>
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <sstream>
-#include <random>
-#include <algorithm>
-
-int main() {
-	std::mt19937 generator(time(nullptr));
-
-	std::vector<std::vector<double>> timeSeries;
-
-	std::ifstream fromFile("resources/data.txt");
-
-	if (!fromFile.is_open()) {
-		std::cerr << "Could not open data.txt!" << std::endl;
-
-		return 1;
-	}
-
-	// Skip first line
-	std::string line;
-
-	std::getline(fromFile, line);
-
-	int numEntries = 1;
-
-	for (int i = 0; i < line.size(); i++)
-		if (line[i] == ',')
-			numEntries++;
-
-	int numSkipEntries = 1;
-
-	int numEntriesUse = numEntries - numSkipEntries;
-
-	std::vector<double> minimums(numEntriesUse, 999999999.0);
-	std::vector<double> maximums(numEntriesUse, -999999999.0);
-
-	while (fromFile.good() && !fromFile.eof()) {
-		std::vector<double> entries(numEntriesUse);
-
-		std::string line;
-
-		std::getline(fromFile, line);
-
-		std::istringstream fromLine(line);
-
-		std::string param;
-
-		// Skip entries
-		for (int i = 0; i < numSkipEntries; i++) {
-			std::string entry;
-
-			std::getline(fromLine, entry, ',');
-		}
-
-		for (int i = 0; i < numEntriesUse; i++) {
-			std::string entry;
-
-			std::getline(fromLine, entry, ',');
-
-			if (entry == "")
-				entries[i] = 0.0;
-			else {
-				double value = std::stod(entry);
-
-				maximums[i] = std::max(maximums[i], value);
-				minimums[i] = std::min(minimums[i], value);
-
-				entries[i] = value;
-			}
-		}
-
-		timeSeries.push_back(entries);
-	}
-
-	// Rescale
-	for (int i = 0; i < timeSeries.size(); i++) {
-		for (int j = 0; j < timeSeries[i].size(); j++) {
-			timeSeries[i][j] = (timeSeries[i][j] - minimums[j]) / std::max(0.0001, (maximums[j] - minimums[j]));
-		}
-	}
-
-	timeSeries.clear();
-
-	timeSeries.resize(10);
-	timeSeries[0] = { 0.0f, 1.0f, 0.0f };
-	timeSeries[1] = { 0.0f, 0.0f, 0.0f };
-	timeSeries[2] = { 1.0f, 1.0f, 0.0f };
-	timeSeries[3] = { 0.0f, 0.0f, 1.0f };
-	timeSeries[4] = { 0.0f, 1.0f, 0.0f };
-	timeSeries[5] = { 0.0f, 0.0f, 1.0f };
-	timeSeries[6] = { 0.0f, 0.0f, 0.0f };
-	timeSeries[7] = { 0.0f, 0.0f, 0.0f };
-	timeSeries[8] = { 0.0f, 1.0f, 0.0f };
-	timeSeries[9] = { 0.0f, 1.0f, 1.0f };
-
-	/*sys::ComputeSystem cs;
-
-	cs.create(sys::ComputeSystem::_gpu);
-
-	sys::ComputeProgram prog;
-
-	prog.loadFromFile("resources/bidinet.cl", cs);*/
-
-	std::vector<sdr::IPredictiveRSDR::LayerDesc> layerDescs(3);
-
-	layerDescs[0]._width = 16;
-	layerDescs[0]._height = 16;
-
-	layerDescs[1]._width = 12;
-	layerDescs[1]._height = 12;
-
-	layerDescs[2]._width = 8;
-	layerDescs[2]._height = 8;
-
-	sdr::IPredictiveRSDR prsdr;
-
-	prsdr.createRandom(2, 2, 16, layerDescs, -0.01f, 0.01f, 0.01f, 0.05f, 0.0f, generator);
-
-	float avgError = 1.0f;
-
-	float avgErrorDecay = 0.01f;
-
-	for (int iter = 0; iter < 1000; iter++) {
-		for (int i = 0; i < timeSeries.size(); i++) {
-			float error = 0.0f;
-
-			for (int j = 0; j < timeSeries[i].size(); j++) {
-				error += std::pow(prsdr.getPrediction(j) - timeSeries[i][j], 2);
-
-				prsdr.setInput(j, timeSeries[i][j]);
-
-				//std::cout << prsdr.getOutputExploratory(j) << " ";
-			}
-
-			//std::cout << std::endl;
-
-			avgError = (1.0f - avgErrorDecay) * avgError + avgErrorDecay * error;
-
-			prsdr.simStep(generator);
-
-			if (i % 10 == 0) {
-				std::cout << "Iteration " << i << ": " << avgError << std::endl;
-			}
-		}
-	}
-
-	return 0;
-}
-
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_PREDICTION
+
+#include <sdr/IPredictiveRSDR.h>
+
+#include <data/TimeSeries.h>
+
+#include <time.h>
+#include <iostream>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+int main() {
+	std::mt19937 generator(time(nullptr));
+
+	data::TimeSeries dataset;
+
+	if (!dataset.load("resources/data.txt", "resources/data.bin")) {
+		std::cerr << "Could not open data.txt!" << std::endl;
+
+		return 1;
+	}
+
+	dataset.normalize();
+
+	std::cout << "Loaded " << dataset.getNumRows() << " rows of " << dataset.getNumColumns() << " columns" << std::endl;
+
+	const int numColumns = dataset.getNumColumns();
+
+	// Columns laid out on the smallest square input grid, the remaining inputs stay 0
+	const int inputWidth = std::ceil(std::sqrt(static_cast<float>(numColumns)));
+	const int inputHeight = (numColumns + inputWidth - 1) / inputWidth;
+
+	// Rows are fed in order, one window at a time
+	const int windowLength = 64;
+	const int numPasses = 10;
+
+	/*sys::ComputeSystem cs;
+
+	cs.create(sys::ComputeSystem::_gpu);
+
+	sys::ComputeProgram prog;
+
+	prog.loadFromFile("resources/bidinet.cl", cs);*/
+
+	std::vector<sdr::IPredictiveRSDR::LayerDesc> layerDescs(3);
+
+	layerDescs[0]._width = 16;
+	layerDescs[0]._height = 16;
+
+	layerDescs[1]._width = 12;
+	layerDescs[1]._height = 12;
+
+	layerDescs[2]._width = 8;
+	layerDescs[2]._height = 8;
+
+	sdr::IPredictiveRSDR prsdr;
+
+	prsdr.createRandom(inputWidth, inputHeight, 16, layerDescs, -0.01f, 0.01f, 0.01f, 0.05f, 0.0f, generator);
+
+	float avgError = 1.0f;
+
+	float avgErrorDecay = 0.01f;
+
+	for (int pass = 0; pass < numPasses; pass++) {
+		dataset.forEachWindow(windowLength, windowLength, [&](size_t start, const std::vector<float> &window) {
+			for (int t = 0; t < windowLength; t++) {
+				const float* frame = &window[t * numColumns];
+
+				float error = 0.0f;
+
+				for (int j = 0; j < numColumns; j++) {
+					error += std::pow(prsdr.getPrediction(j) - frame[j], 2);
+
+					prsdr.setInput(j, frame[j]);
+				}
+
+				avgError = (1.0f - avgErrorDecay) * avgError + avgErrorDecay * error;
+
+				prsdr.simStep(generator);
+			}
+
+			if ((start / windowLength) % 100 == 0)
+				std::cout << "Pass " << pass << " row " << start << ": " << avgError << std::endl;
+		});
+	}
+
+	return 0;
+}
+
 #endif
\ No newline at end of file
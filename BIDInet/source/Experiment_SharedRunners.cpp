@@ -0,0 +1,110 @@
+#include "Settings.h"
+
+#if EXPERIMENT_SELECTION == EXPERIMENT_SHARED_RUNNERS
+
+#include <runner/RunnerBatch.h>
+
+#include <deep/CSRLBatch.h>
+
+#include <system/ThreadPool.h>
+
+#include <time.h>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+// Many headless runners controlled by one shared CSRL. Every runner is an agent of the batch with its own encoder, prediction
+// and column state, all of them use the model's weights, which learn from the averaged updates of all runners once per step
+int main() {
+	std::mt19937 generator(time(nullptr));
+
+	const int numRunners = 128;
+	const int episodeSteps = 1200;
+	const int clockCount = 4;
+
+	// Runner state and clocks, followed by the actions. The rest of the 7 x 7 input is unused
+	const int inputCount = Runner::_stateSize + clockCount;
+	const int outputCount = Runner::_actionSize;
+
+	std::shared_ptr<sys::ThreadPool> threadPool = std::make_shared<sys::ThreadPool>();
+
+	threadPool->create();
+
+	RunnerBatch runners;
+
+	runners.setThreadPool(threadPool);
+
+	runners.create(numRunners);
+
+	std::vector<deep::CSRL::LayerDesc> layerDescs(2);
+
+	layerDescs[0]._width = 4;
+	layerDescs[0]._height = 4;
+
+	layerDescs[1]._width = 3;
+	layerDescs[1]._height = 3;
+
+	std::vector<deep::CSRL::InputType> inputTypes(7 * 7, deep::CSRL::_state);
+
+	for (int i = 0; i < outputCount; i++)
+		inputTypes[inputCount + i] = deep::CSRL::_action;
+
+	deep::CSRL model;
+
+	model.createRandom(7, 7, 8, inputTypes, layerDescs, -0.01f, 0.01f, 0.01f, 0.05f, 0.5f, generator);
+
+	deep::CSRLBatch agents;
+
+	agents.create(model, numRunners);
+
+	agents.setThreadPool(threadPool);
+
+	std::vector<float> rewards(numRunners);
+	std::vector<float> actions(numRunners * Runner::_actionSize);
+
+	std::cout << "Running " << numRunners << " runners on " << threadPool->getNumThreads() << " threads" << std::endl;
+
+	for (int episode = 0;; episode++) {
+		float distance = 0.0f;
+
+		for (int i = 0; i < numRunners; i++) {
+			runners.reset(i);
+
+			distance -= runners.getRunner(i)._pBody->GetPosition().x;
+		}
+
+		for (int steps = 0; steps < episodeSteps; steps++) {
+			for (int i = 0; i < numRunners; i++) {
+				const float* state = runners.getState(i);
+
+				int inputIndex = 0;
+
+				for (int s = 0; s < Runner::_stateSize; s++)
+					agents.setInput(i, inputIndex++, state[s]);
+
+				for (int a = 0; a < clockCount; a++)
+					agents.setInput(i, inputIndex++, std::sin(steps / 60.0f * 2.0f * a * 2.0f * 3.141596f) * 0.5f + 0.5f);
+
+				rewards[i] = runners.getVelocity(i);
+			}
+
+			agents.simStep(rewards, generator);
+
+			for (int i = 0; i < numRunners; i++)
+				for (int a = 0; a < Runner::_actionSize; a++)
+					actions[i * Runner::_actionSize + a] = std::min(1.0f, std::max(0.0f, agents.getPrediction(i, inputCount + a) * 0.5f + 0.5f));
+
+			runners.step(actions);
+		}
+
+		for (int i = 0; i < numRunners; i++)
+			distance += runners.getRunner(i)._pBody->GetPosition().x;
+
+		std::cout << "Episode " << episode << " average distance " << distance / numRunners << std::endl;
+	}
+
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -1,14 +1,19 @@
-#pragma once
-
-#define EXPERIMENT_RUNNER 0
-#define EXPERIMENT_DODGEBALL_SDDRL 1
-#define EXPERIMENT_DODGEBALL_FERL 2
-#define EXPERIMENT_DODGEBALL_DQN 3
-#define EXPERIMENT_DODGEBALL_CSRL 4
-#define EXPERIMENT_PONG 5
-#define EXPERIMENT_DODGEBALL_QPRSDR 6
-#define EXPERIMENT_VIDEO_TEST 7
-#define EXPERIMENT_DODGEBALL_PRSDRRL 8
-#define EXPERIMENT_PREDICTION 9
-
-#define EXPERIMENT_SELECTION EXPERIMENT_RUNNER
+#pragma once
+
+#define EXPERIMENT_RUNNER 0
+#define EXPERIMENT_DODGEBALL_SDDRL 1
+#define EXPERIMENT_DODGEBALL_FERL 2
+#define EXPERIMENT_DODGEBALL_DQN 3
+#define EXPERIMENT_DODGEBALL_CSRL 4
+#define EXPERIMENT_PONG 5
+#define EXPERIMENT_DODGEBALL_QPRSDR 6
+#define EXPERIMENT_VIDEO_TEST 7
+#define EXPERIMENT_DODGEBALL_PRSDRRL 8
+#define EXPERIMENT_PREDICTION 9
+#define EXPERIMENT_EVOLUTION 10
+#define EXPERIMENT_EVALUATION 11
+#define EXPERIMENT_BIDINET_VALIDATION 12
+#define EXPERIMENT_SHARED_RUNNERS 13
+#define EXPERIMENT_POLICY_ROLLOUTS 14
+
+#define EXPERIMENT_SELECTION EXPERIMENT_RUNNER
\ No newline at end of file
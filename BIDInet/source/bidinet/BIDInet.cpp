@@ -0,0 +1,432 @@
+#include "BIDInet.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bidi;
+
+static cl_int2 toInt2(int x, int y) {
+	cl_int2 v;
+
+	v.s[0] = x;
+	v.s[1] = y;
+
+	return v;
+}
+
+static cl_float2 toFloat2(float x, float y) {
+	cl_float2 v;
+
+	v.s[0] = x;
+	v.s[1] = y;
+
+	return v;
+}
+
+static cl_uint2 randomSeed(std::mt19937 &generator) {
+	std::uniform_int_distribution<int> seedDist(0, 99999);
+
+	cl_uint2 v;
+
+	v.s[0] = seedDist(generator);
+	v.s[1] = seedDist(generator);
+
+	return v;
+}
+
+static cl::size_t<3> toSize3(int x, int y, int z) {
+	cl::size_t<3> v;
+
+	v[0] = x;
+	v[1] = y;
+	v[2] = z;
+
+	return v;
+}
+
+cl::Image2D BIDInet::createImage2D(sys::ComputeSystem &cs, int width, int height) {
+	cl::Image2D image(cs.getContext(), CL_MEM_READ_WRITE, cl::ImageFormat(CL_R, CL_FLOAT), width, height);
+
+	cl_float4 zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	cs.getQueue().enqueueFillImage(image, zero, toSize3(0, 0, 0), toSize3(width, height, 1));
+
+	return image;
+}
+
+BIDInet::DoubleBuffer3D BIDInet::createConnections(sys::ComputeSystem &cs, int width, int height, int numConnections, bool traces) {
+	DoubleBuffer3D connections;
+
+	cl_float4 zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (int i = 0; i < 2; i++) {
+		connections[i] = cl::Image3D(cs.getContext(), CL_MEM_READ_WRITE, cl::ImageFormat(traces ? CL_RG : CL_R, CL_FLOAT), width, height, numConnections);
+
+		cs.getQueue().enqueueFillImage(connections[i], zero, toSize3(0, 0, 0), toSize3(width, height, numConnections));
+	}
+
+	return connections;
+}
+
+void BIDInet::initializeConnections(sys::ComputeSystem &cs, cl::Image3D &connections, int width, int height, int numConnections, float initMinWeight, float initMaxWeight, std::mt19937 &generator) {
+	int argIndex = 0;
+
+	_initializeConnectionsKernel.setArg(argIndex++, connections);
+	_initializeConnectionsKernel.setArg(argIndex++, numConnections);
+	_initializeConnectionsKernel.setArg(argIndex++, randomSeed(generator));
+	_initializeConnectionsKernel.setArg(argIndex++, initMinWeight);
+	_initializeConnectionsKernel.setArg(argIndex++, initMaxWeight);
+
+	cs.getQueue().enqueueNDRangeKernel(_initializeConnectionsKernel, cl::NullRange, cl::NDRange(width, height));
+}
+
+bool BIDInet::createRandom(sys::ComputeSystem &cs, sys::ComputeProgram &program, int inputWidth, int inputHeight, const std::vector<InputType> &inputTypes,
+	const InputDesc &inputDesc, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, std::mt19937 &generator)
+{
+	_initializeConnectionsKernel = program.createKernel("initializeConnections");
+	_ffActivateKernel = program.createKernel("ffActivate");
+	_ffInhibitKernel = program.createKernel("ffInhibit");
+	_fbActivateKernel = program.createKernel("fbActivate");
+	_fbActivateFirstKernel = program.createKernel("fbActivateFirst");
+	_ffReconstructKernel = program.createKernel("ffReconstruct");
+	_recReconstructKernel = program.createKernel("recReconstruct");
+	_ffConnectionUpdateKernel = program.createKernel("ffConnectionUpdate");
+	_recConnectionUpdateKernel = program.createKernel("recConnectionUpdate");
+	_fbConnectionUpdateKernel = program.createKernel("fbConnectionUpdate");
+	_predConnectionUpdateKernel = program.createKernel("predConnectionUpdate");
+
+	if (_initializeConnectionsKernel() == nullptr || _ffActivateKernel() == nullptr || _ffInhibitKernel() == nullptr ||
+		_fbActivateKernel() == nullptr || _fbActivateFirstKernel() == nullptr ||
+		_ffReconstructKernel() == nullptr || _recReconstructKernel() == nullptr ||
+		_ffConnectionUpdateKernel() == nullptr || _recConnectionUpdateKernel() == nullptr ||
+		_fbConnectionUpdateKernel() == nullptr || _predConnectionUpdateKernel() == nullptr)
+		return false;
+
+	_inputWidth = inputWidth;
+	_inputHeight = inputHeight;
+	_inputTypes = inputTypes;
+	_inputDesc = inputDesc;
+	_layerDescs = layerDescs;
+
+	_layers.resize(_layerDescs.size());
+
+	for (int l = 0; l < _layers.size(); l++) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		int inputsWidth = l == 0 ? _inputWidth : _layerDescs[l - 1]._width;
+		int inputsHeight = l == 0 ? _inputHeight : _layerDescs[l - 1]._height;
+
+		layer._ffActivations = createImage2D(cs, desc._width, desc._height);
+		layer._ffStates = createImage2D(cs, desc._width, desc._height);
+		layer._ffStatesPrev = createImage2D(cs, desc._width, desc._height);
+		layer._ffReconstruction = createImage2D(cs, inputsWidth, inputsHeight);
+		layer._recReconstruction = createImage2D(cs, desc._width, desc._height);
+		layer._fbStates = createImage2D(cs, desc._width, desc._height);
+		layer._fbStatesPrev = createImage2D(cs, desc._width, desc._height);
+		layer._fbStatesExploratory = createImage2D(cs, desc._width, desc._height);
+		layer._fbStatesExploratoryPrev = createImage2D(cs, desc._width, desc._height);
+
+		int ffSize = (2 * desc._ffRadius + 1) * (2 * desc._ffRadius + 1) + 1;
+		int recSize = (2 * desc._recRadius + 1) * (2 * desc._recRadius + 1);
+		int fbSize = (2 * desc._fbRadius + 1) * (2 * desc._fbRadius + 1) + 1;
+		int predSize = (2 * desc._predRadius + 1) * (2 * desc._predRadius + 1) + 1;
+
+		layer._ffConnections = createConnections(cs, desc._width, desc._height, ffSize, false);
+		layer._recConnections = createConnections(cs, desc._width, desc._height, recSize, false);
+		layer._fbConnections = createConnections(cs, desc._width, desc._height, fbSize, true);
+		layer._predConnections = createConnections(cs, desc._width, desc._height, predSize, true);
+
+		initializeConnections(cs, layer._ffConnections[_front], desc._width, desc._height, ffSize, initMinWeight, initMaxWeight, generator);
+		initializeConnections(cs, layer._recConnections[_front], desc._width, desc._height, recSize, initMinWeight, initMaxWeight, generator);
+		initializeConnections(cs, layer._fbConnections[_front], desc._width, desc._height, fbSize, initMinWeight, initMaxWeight, generator);
+		initializeConnections(cs, layer._predConnections[_front], desc._width, desc._height, predSize, initMinWeight, initMaxWeight, generator);
+	}
+
+	_inputImage = createImage2D(cs, _inputWidth, _inputHeight);
+	_inputImagePrev = createImage2D(cs, _inputWidth, _inputHeight);
+	_predictionImage = createImage2D(cs, _inputWidth, _inputHeight);
+	_predictionImagePrev = createImage2D(cs, _inputWidth, _inputHeight);
+	_predictionImageExploratory = createImage2D(cs, _inputWidth, _inputHeight);
+
+	int inputFbSize = (2 * _inputDesc._fbRadius + 1) * (2 * _inputDesc._fbRadius + 1) + 1;
+	int inputPredSize = (2 * _inputDesc._predRadius + 1) * (2 * _inputDesc._predRadius + 1) + 1;
+
+	_inputFbConnections = createConnections(cs, _inputWidth, _inputHeight, inputFbSize, true);
+	_inputPredConnections = createConnections(cs, _inputWidth, _inputHeight, inputPredSize, true);
+
+	initializeConnections(cs, _inputFbConnections[_front], _inputWidth, _inputHeight, inputFbSize, initMinWeight, initMaxWeight, generator);
+	initializeConnections(cs, _inputPredConnections[_front], _inputWidth, _inputHeight, inputPredSize, initMinWeight, initMaxWeight, generator);
+
+	_inputs.assign(_inputWidth * _inputHeight, 0.0f);
+	_predictions.assign(_inputs.size(), 0.0f);
+	_actions.assign(_inputs.size(), 0.0f);
+
+	_averageReward = 0.0f;
+
+	cs.getQueue().finish();
+
+	return true;
+}
+
+void BIDInet::fbStep(sys::ComputeSystem &cs, const cl::Image2D &inputs, const cl::Image2D &inputsPrev, const cl::Image2D &ffStates, const cl::Image2D &ffStatesPrev,
+	cl::Image2D &fbStates, const cl::Image2D &fbStatesPrev, cl::Image2D &fbStatesExploratory,
+	DoubleBuffer3D &fbConnections, DoubleBuffer3D &predConnections,
+	int inputsWidth, int inputsHeight, int width, int height,
+	int fbRadius, int predRadius, float fbPredAlpha, float fbRLAlpha, float fbLambdaGamma, float breakChance,
+	bool first, float rlError, std::mt19937 &generator, bool learn)
+{
+	cl_float2 layerToInputsScalar = toFloat2(static_cast<float>(inputsWidth) / width, static_cast<float>(inputsHeight) / height);
+
+	// The first (top) layer only has its own feed forward states to go on
+	cl::Kernel &activateKernel = first ? _fbActivateFirstKernel : _fbActivateKernel;
+
+	int argIndex = 0;
+
+	activateKernel.setArg(argIndex++, inputs);
+
+	if (!first)
+		activateKernel.setArg(argIndex++, ffStates);
+
+	activateKernel.setArg(argIndex++, fbConnections[_front]);
+	activateKernel.setArg(argIndex++, predConnections[_front]);
+	activateKernel.setArg(argIndex++, fbStates);
+	activateKernel.setArg(argIndex++, fbStatesExploratory);
+	activateKernel.setArg(argIndex++, toInt2(inputsWidth, inputsHeight));
+	activateKernel.setArg(argIndex++, toInt2(width, height));
+	activateKernel.setArg(argIndex++, fbRadius);
+	activateKernel.setArg(argIndex++, predRadius);
+	activateKernel.setArg(argIndex++, layerToInputsScalar);
+	activateKernel.setArg(argIndex++, breakChance);
+	activateKernel.setArg(argIndex++, randomSeed(generator));
+
+	cs.getQueue().enqueueNDRangeKernel(activateKernel, cl::NullRange, cl::NDRange(width, height));
+
+	if (!learn)
+		return;
+
+	argIndex = 0;
+
+	_fbConnectionUpdateKernel.setArg(argIndex++, inputsPrev);
+	_fbConnectionUpdateKernel.setArg(argIndex++, inputs);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbConnections[_front]);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbConnections[_back]);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbStatesPrev);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbStates);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbStatesExploratory);
+	_fbConnectionUpdateKernel.setArg(argIndex++, ffStates);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbStates);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbStatesExploratory);
+	_fbConnectionUpdateKernel.setArg(argIndex++, toInt2(inputsWidth, inputsHeight));
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbRadius);
+	_fbConnectionUpdateKernel.setArg(argIndex++, layerToInputsScalar);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbPredAlpha);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbRLAlpha);
+	_fbConnectionUpdateKernel.setArg(argIndex++, fbLambdaGamma);
+	_fbConnectionUpdateKernel.setArg(argIndex++, rlError);
+
+	cs.getQueue().enqueueNDRangeKernel(_fbConnectionUpdateKernel, cl::NullRange, cl::NDRange(width, height));
+
+	std::swap(fbConnections[_front], fbConnections[_back]);
+
+	if (first)
+		return;
+
+	argIndex = 0;
+
+	_predConnectionUpdateKernel.setArg(argIndex++, predConnections[_front]);
+	_predConnectionUpdateKernel.setArg(argIndex++, predConnections[_back]);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbStatesPrev);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbStates);
+	_predConnectionUpdateKernel.setArg(argIndex++, ffStatesPrev);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbStatesExploratory);
+	_predConnectionUpdateKernel.setArg(argIndex++, ffStates);
+	_predConnectionUpdateKernel.setArg(argIndex++, toInt2(width, height));
+	_predConnectionUpdateKernel.setArg(argIndex++, predRadius);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbPredAlpha);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbRLAlpha);
+	_predConnectionUpdateKernel.setArg(argIndex++, fbLambdaGamma);
+	_predConnectionUpdateKernel.setArg(argIndex++, rlError);
+
+	cs.getQueue().enqueueNDRangeKernel(_predConnectionUpdateKernel, cl::NullRange, cl::NDRange(width, height));
+
+	std::swap(predConnections[_front], predConnections[_back]);
+}
+
+void BIDInet::simStep(sys::ComputeSystem &cs, float reward, std::mt19937 &generator, bool learn) {
+	// Actions of the last step become the action inputs
+	for (int i = 0; i < _inputs.size(); i++)
+		if (_inputTypes[i] == _action)
+			_inputs[i] = _actions[i];
+
+	std::swap(_inputImage, _inputImagePrev);
+	std::swap(_predictionImage, _predictionImagePrev);
+
+	for (int l = 0; l < _layers.size(); l++) {
+		std::swap(_layers[l]._ffStates, _layers[l]._ffStatesPrev);
+		std::swap(_layers[l]._fbStates, _layers[l]._fbStatesPrev);
+		std::swap(_layers[l]._fbStatesExploratory, _layers[l]._fbStatesExploratoryPrev);
+	}
+
+	cs.getQueue().enqueueWriteImage(_inputImage, CL_FALSE, toSize3(0, 0, 0), toSize3(_inputWidth, _inputHeight, 1), 0, 0, _inputs.data());
+
+	float rlError = reward - _averageReward;
+
+	_averageReward += _rewardAverageDecay * (reward - _averageReward);
+
+	// Feed forward
+	for (int l = 0; l < _layers.size(); l++) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		const cl::Image2D &inputs = l == 0 ? _inputImage : _layers[l - 1]._ffStates;
+
+		int inputsWidth = l == 0 ? _inputWidth : _layerDescs[l - 1]._width;
+		int inputsHeight = l == 0 ? _inputHeight : _layerDescs[l - 1]._height;
+
+		cl_float2 layerToInputsScalar = toFloat2(static_cast<float>(inputsWidth) / desc._width, static_cast<float>(inputsHeight) / desc._height);
+		cl_float2 inputsToLayerScalar = toFloat2(static_cast<float>(desc._width) / inputsWidth, static_cast<float>(desc._height) / inputsHeight);
+
+		int argIndex = 0;
+
+		_ffActivateKernel.setArg(argIndex++, inputs);
+		_ffActivateKernel.setArg(argIndex++, layer._ffStatesPrev);
+		_ffActivateKernel.setArg(argIndex++, layer._ffConnections[_front]);
+		_ffActivateKernel.setArg(argIndex++, layer._recConnections[_front]);
+		_ffActivateKernel.setArg(argIndex++, layer._ffActivations);
+		_ffActivateKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+		_ffActivateKernel.setArg(argIndex++, toInt2(inputsWidth, inputsHeight));
+		_ffActivateKernel.setArg(argIndex++, desc._ffRadius);
+		_ffActivateKernel.setArg(argIndex++, desc._recRadius);
+		_ffActivateKernel.setArg(argIndex++, layerToInputsScalar);
+
+		cs.getQueue().enqueueNDRangeKernel(_ffActivateKernel, cl::NullRange, cl::NDRange(desc._width, desc._height));
+
+		float lDiam = 2 * desc._lRadius + 1;
+
+		argIndex = 0;
+
+		_ffInhibitKernel.setArg(argIndex++, layer._ffActivations);
+		_ffInhibitKernel.setArg(argIndex++, layer._ffStates);
+		_ffInhibitKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+		_ffInhibitKernel.setArg(argIndex++, desc._lRadius);
+		_ffInhibitKernel.setArg(argIndex++, desc._sparsity * lDiam * lDiam);
+		_ffInhibitKernel.setArg(argIndex++, desc._sparsity);
+
+		cs.getQueue().enqueueNDRangeKernel(_ffInhibitKernel, cl::NullRange, cl::NDRange(desc._width, desc._height));
+
+		if (!learn)
+			continue;
+
+		// Reconstruct inputs and previous states from the new states, learn on the difference
+		cl_int2 ffReverseRadius = toInt2(static_cast<int>(std::ceil(inputsToLayerScalar.s[0] * (desc._ffRadius + 0.5f))) + 1,
+			static_cast<int>(std::ceil(inputsToLayerScalar.s[1] * (desc._ffRadius + 0.5f))) + 1);
+
+		argIndex = 0;
+
+		_ffReconstructKernel.setArg(argIndex++, layer._ffStates);
+		_ffReconstructKernel.setArg(argIndex++, layer._ffConnections[_front]);
+		_ffReconstructKernel.setArg(argIndex++, layer._ffReconstruction);
+		_ffReconstructKernel.setArg(argIndex++, desc._ffRadius);
+		_ffReconstructKernel.setArg(argIndex++, ffReverseRadius);
+		_ffReconstructKernel.setArg(argIndex++, toInt2(inputsWidth, inputsHeight));
+		_ffReconstructKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+		_ffReconstructKernel.setArg(argIndex++, layerToInputsScalar);
+		_ffReconstructKernel.setArg(argIndex++, inputsToLayerScalar);
+
+		cs.getQueue().enqueueNDRangeKernel(_ffReconstructKernel, cl::NullRange, cl::NDRange(inputsWidth, inputsHeight));
+
+		argIndex = 0;
+
+		_recReconstructKernel.setArg(argIndex++, layer._ffStates);
+		_recReconstructKernel.setArg(argIndex++, layer._recConnections[_front]);
+		_recReconstructKernel.setArg(argIndex++, layer._recReconstruction);
+		_recReconstructKernel.setArg(argIndex++, desc._recRadius);
+		_recReconstructKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+
+		cs.getQueue().enqueueNDRangeKernel(_recReconstructKernel, cl::NullRange, cl::NDRange(desc._width, desc._height));
+
+		argIndex = 0;
+
+		_ffConnectionUpdateKernel.setArg(argIndex++, inputs);
+		_ffConnectionUpdateKernel.setArg(argIndex++, layer._ffConnections[_front]);
+		_ffConnectionUpdateKernel.setArg(argIndex++, layer._ffConnections[_back]);
+		_ffConnectionUpdateKernel.setArg(argIndex++, layer._ffReconstruction);
+		_ffConnectionUpdateKernel.setArg(argIndex++, layer._ffStates);
+		_ffConnectionUpdateKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+		_ffConnectionUpdateKernel.setArg(argIndex++, toInt2(inputsWidth, inputsHeight));
+		_ffConnectionUpdateKernel.setArg(argIndex++, desc._ffRadius);
+		_ffConnectionUpdateKernel.setArg(argIndex++, layerToInputsScalar);
+		_ffConnectionUpdateKernel.setArg(argIndex++, desc._ffAlpha);
+		_ffConnectionUpdateKernel.setArg(argIndex++, desc._ffGamma);
+		_ffConnectionUpdateKernel.setArg(argIndex++, desc._sparsity);
+
+		cs.getQueue().enqueueNDRangeKernel(_ffConnectionUpdateKernel, cl::NullRange, cl::NDRange(desc._width, desc._height));
+
+		argIndex = 0;
+
+		_recConnectionUpdateKernel.setArg(argIndex++, layer._ffStatesPrev);
+		_recConnectionUpdateKernel.setArg(argIndex++, layer._recConnections[_front]);
+		_recConnectionUpdateKernel.setArg(argIndex++, layer._recConnections[_back]);
+		_recConnectionUpdateKernel.setArg(argIndex++, layer._recReconstruction);
+		_recConnectionUpdateKernel.setArg(argIndex++, layer._ffStates);
+		_recConnectionUpdateKernel.setArg(argIndex++, toInt2(desc._width, desc._height));
+		_recConnectionUpdateKernel.setArg(argIndex++, desc._recRadius);
+		_recConnectionUpdateKernel.setArg(argIndex++, desc._ffAlpha);
+
+		cs.getQueue().enqueueNDRangeKernel(_recConnectionUpdateKernel, cl::NullRange, cl::NDRange(desc._width, desc._height));
+
+		std::swap(layer._ffConnections[_front], layer._ffConnections[_back]);
+		std::swap(layer._recConnections[_front], layer._recConnections[_back]);
+	}
+
+	// Feed back, from the top down
+	for (int l = _layers.size() - 1; l >= 0; l--) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		bool first = l == _layers.size() - 1;
+
+		if (first)
+			fbStep(cs, layer._ffStates, layer._ffStatesPrev, layer._ffStates, layer._ffStatesPrev,
+			layer._fbStates, layer._fbStatesPrev, layer._fbStatesExploratory,
+			layer._fbConnections, layer._predConnections,
+			desc._width, desc._height, desc._width, desc._height,
+			desc._fbRadius, desc._predRadius, desc._fbPredAlpha, desc._fbRLAlpha, desc._fbLambdaGamma, desc._breakChance,
+			true, rlError, generator, learn);
+		else
+			fbStep(cs, _layers[l + 1]._fbStatesExploratory, _layers[l + 1]._fbStatesExploratoryPrev, layer._ffStates, layer._ffStatesPrev,
+			layer._fbStates, layer._fbStatesPrev, layer._fbStatesExploratory,
+			layer._fbConnections, layer._predConnections,
+			_layerDescs[l + 1]._width, _layerDescs[l + 1]._height, desc._width, desc._height,
+			desc._fbRadius, desc._predRadius, desc._fbPredAlpha, desc._fbRLAlpha, desc._fbLambdaGamma, desc._breakChance,
+			false, rlError, generator, learn);
+	}
+
+	// Predictions of the next inputs
+	fbStep(cs, _layers.front()._fbStatesExploratory, _layers.front()._fbStatesExploratoryPrev, _inputImage, _inputImagePrev,
+		_predictionImage, _predictionImagePrev, _predictionImageExploratory,
+		_inputFbConnections, _inputPredConnections,
+		_layerDescs.front()._width, _layerDescs.front()._height, _inputWidth, _inputHeight,
+		_inputDesc._fbRadius, _inputDesc._predRadius, _inputDesc._fbPredAlpha, _inputDesc._fbRLAlpha, _inputDesc._fbLambdaGamma, _inputDesc._breakChance,
+		false, rlError, generator, learn);
+
+	cs.getQueue().enqueueReadImage(_predictionImage, CL_FALSE, toSize3(0, 0, 0), toSize3(_inputWidth, _inputHeight, 1), 0, 0, _predictions.data());
+	cs.getQueue().enqueueReadImage(_predictionImageExploratory, CL_TRUE, toSize3(0, 0, 0), toSize3(_inputWidth, _inputHeight, 1), 0, 0, _actions.data());
+}
+
+void BIDInet::readFFStates(sys::ComputeSystem &cs, int layer, std::vector<float> &states) {
+	const LayerDesc &desc = _layerDescs[layer];
+
+	states.resize(desc._width * desc._height);
+
+	cs.getQueue().enqueueReadImage(_layers[layer]._ffStates, CL_TRUE, toSize3(0, 0, 0), toSize3(desc._width, desc._height, 1), 0, 0, states.data());
+}
+
+void BIDInet::readFBStates(sys::ComputeSystem &cs, int layer, std::vector<float> &states) {
+	const LayerDesc &desc = _layerDescs[layer];
+
+	states.resize(desc._width * desc._height);
+
+	cs.getQueue().enqueueReadImage(_layers[layer]._fbStates, CL_TRUE, toSize3(0, 0, 0), toSize3(desc._width, desc._height, 1), 0, 0, states.data());
+}
\ No newline at end of file
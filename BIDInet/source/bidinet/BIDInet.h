@@ -0,0 +1,155 @@
+#pragma once
+
+#include "BIDInetDescs.h"
+
+#include <system/ComputeProgram.h>
+
+#include <array>
+#include <random>
+
+namespace bidi {
+	// Bidirectional hierarchy on the image kernels in resources/bidinet.cl. Every layer is a sheet of units with
+	// a feed forward (sparse, k-winners) pass upwards and a feed back (predictive, exploratory) pass downwards.
+	// The feed back onto the inputs gives the predictions of the next inputs, and the actions for _action inputs
+	class BIDInet {
+	public:
+		typedef bidi::InputType InputType;
+		typedef bidi::LayerDesc LayerDesc;
+		typedef bidi::InputDesc InputDesc;
+
+		// Connections are read from the front and written to the back, then swapped
+		typedef std::array<cl::Image3D, 2> DoubleBuffer3D;
+
+		enum {
+			_front = 0, _back = 1
+		};
+
+		struct Layer {
+			cl::Image2D _ffActivations;
+			cl::Image2D _ffStates, _ffStatesPrev;
+
+			cl::Image2D _ffReconstruction;
+			cl::Image2D _recReconstruction;
+
+			cl::Image2D _fbStates, _fbStatesPrev;
+			cl::Image2D _fbStatesExploratory, _fbStatesExploratoryPrev;
+
+			// Weights only
+			DoubleBuffer3D _ffConnections;
+			DoubleBuffer3D _recConnections;
+
+			// Weights and eligibility traces
+			DoubleBuffer3D _fbConnections;
+			DoubleBuffer3D _predConnections;
+		};
+
+	private:
+		int _inputWidth, _inputHeight;
+
+		std::vector<InputType> _inputTypes;
+
+		InputDesc _inputDesc;
+		std::vector<LayerDesc> _layerDescs;
+		std::vector<Layer> _layers;
+
+		cl::Image2D _inputImage, _inputImagePrev;
+
+		cl::Image2D _predictionImage, _predictionImagePrev;
+		cl::Image2D _predictionImageExploratory;
+
+		DoubleBuffer3D _inputFbConnections;
+		DoubleBuffer3D _inputPredConnections;
+
+		// Host side copies
+		std::vector<float> _inputs;
+		std::vector<float> _predictions;
+		std::vector<float> _actions;
+
+		float _averageReward;
+
+		cl::Kernel _initializeConnectionsKernel;
+		cl::Kernel _ffActivateKernel;
+		cl::Kernel _ffInhibitKernel;
+		cl::Kernel _fbActivateKernel;
+		cl::Kernel _fbActivateFirstKernel;
+		cl::Kernel _ffReconstructKernel;
+		cl::Kernel _recReconstructKernel;
+		cl::Kernel _ffConnectionUpdateKernel;
+		cl::Kernel _recConnectionUpdateKernel;
+		cl::Kernel _fbConnectionUpdateKernel;
+		cl::Kernel _predConnectionUpdateKernel;
+
+		cl::Image2D createImage2D(sys::ComputeSystem &cs, int width, int height);
+		DoubleBuffer3D createConnections(sys::ComputeSystem &cs, int width, int height, int numConnections, bool traces);
+
+		void initializeConnections(sys::ComputeSystem &cs, cl::Image3D &connections, int width, int height, int numConnections, float initMinWeight, float initMaxWeight, std::mt19937 &generator);
+
+		void fbStep(sys::ComputeSystem &cs, const cl::Image2D &inputs, const cl::Image2D &inputsPrev, const cl::Image2D &ffStates, const cl::Image2D &ffStatesPrev,
+			cl::Image2D &fbStates, const cl::Image2D &fbStatesPrev, cl::Image2D &fbStatesExploratory,
+			DoubleBuffer3D &fbConnections, DoubleBuffer3D &predConnections,
+			int inputsWidth, int inputsHeight, int width, int height,
+			int fbRadius, int predRadius, float fbPredAlpha, float fbRLAlpha, float fbLambdaGamma, float breakChance,
+			bool first, float rlError, std::mt19937 &generator, bool learn);
+
+	public:
+		// Decay of the reward average that the reward is compared against
+		float _rewardAverageDecay;
+
+		BIDInet()
+			: _inputWidth(0), _inputHeight(0), _averageReward(0.0f), _rewardAverageDecay(0.01f)
+		{}
+
+		// inputTypes holds inputWidth * inputHeight entries, row by row. Returns false if a kernel is missing from program
+		bool createRandom(sys::ComputeSystem &cs, sys::ComputeProgram &program, int inputWidth, int inputHeight, const std::vector<InputType> &inputTypes,
+			const InputDesc &inputDesc, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, std::mt19937 &generator);
+
+		// _action inputs are replaced by the actions of the previous step
+		void simStep(sys::ComputeSystem &cs, float reward, std::mt19937 &generator, bool learn = true);
+
+		void setInput(int index, float value) {
+			_inputs[index] = value;
+		}
+
+		void setInput(int x, int y, float value) {
+			setInput(x + y * _inputWidth, value);
+		}
+
+		void setInputs(const float* inputs) {
+			for (int i = 0; i < _inputs.size(); i++)
+				_inputs[i] = inputs[i];
+		}
+
+		float getPrediction(int index) const {
+			return _predictions[index];
+		}
+
+		// Exploratory predictions
+		float getAction(int index) const {
+			return _actions[index];
+		}
+
+		const std::vector<float> &getPredictions() const {
+			return _predictions;
+		}
+
+		const std::vector<float> &getActions() const {
+			return _actions;
+		}
+
+		int getNumInputs() const {
+			return _inputs.size();
+		}
+
+		// Blocking reads of layer images, for visualization and validation
+		void readFFStates(sys::ComputeSystem &cs, int layer, std::vector<float> &states);
+		void readFBStates(sys::ComputeSystem &cs, int layer, std::vector<float> &states);
+
+		const std::vector<LayerDesc> &getLayerDescs() const {
+			return _layerDescs;
+		}
+
+		const std::vector<Layer> &getLayers() const {
+			return _layers;
+		}
+	};
+}
\ No newline at end of file
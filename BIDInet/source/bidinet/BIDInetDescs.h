@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+namespace bidi {
+	// Descriptions shared by the OpenCL hierarchy (BIDInet) and its host reference (BIDInetHost),
+	// so both can be created from the same settings and compared step by step
+	enum InputType {
+		_state, _action
+	};
+
+	struct LayerDesc {
+		int _width, _height;
+
+		// Feed forward, recurrent, inhibition, feed back and predictive radii
+		int _ffRadius, _recRadius, _lRadius, _fbRadius, _predRadius;
+
+		float _sparsity;
+
+		float _ffAlpha, _ffGamma;
+
+		float _fbPredAlpha, _fbRLAlpha, _fbLambdaGamma;
+
+		float _breakChance;
+
+		LayerDesc()
+			: _width(16), _height(16),
+			_ffRadius(4), _recRadius(3), _lRadius(3), _fbRadius(4), _predRadius(3),
+			_sparsity(0.1f),
+			_ffAlpha(0.01f), _ffGamma(0.01f),
+			_fbPredAlpha(0.05f), _fbRLAlpha(0.05f), _fbLambdaGamma(0.95f),
+			_breakChance(0.01f)
+		{}
+	};
+
+	// Feed back from the first layer onto the inputs, which produces the predictions and actions
+	struct InputDesc {
+		int _fbRadius, _predRadius;
+
+		float _fbPredAlpha, _fbRLAlpha, _fbLambdaGamma;
+
+		float _breakChance;
+
+		InputDesc()
+			: _fbRadius(4), _predRadius(2),
+			_fbPredAlpha(0.05f), _fbRLAlpha(0.05f), _fbLambdaGamma(0.95f),
+			_breakChance(0.01f)
+		{}
+	};
+}
\ No newline at end of file
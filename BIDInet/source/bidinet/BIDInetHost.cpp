@@ -0,0 +1,697 @@
+#include "BIDInetHost.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace bidi;
+
+// Same generator as randFloat in bidinet.cl
+static float randFloat(uint32_t &stateX, uint32_t &stateY) {
+	const float invMaxInt = 1.0f / 4294967296.0f;
+
+	uint32_t x = stateX * 17 + stateY * 13123;
+
+	stateX = (x << 13) ^ x;
+	stateY ^= (x << 7);
+
+	uint32_t tmp = x * (x * x * 15731 + 74323) + 871483;
+
+	return static_cast<float>(tmp) * invMaxInt;
+}
+
+static float sigmoid(float x) {
+	return 1.0f / (1.0f + std::exp(-x));
+}
+
+static void randomSeed(std::mt19937 &generator, uint32_t &seedX, uint32_t &seedY) {
+	std::uniform_int_distribution<int> seedDist(0, 99999);
+
+	seedX = seedDist(generator);
+	seedY = seedDist(generator);
+}
+
+static bool inBounds(int x, int y, int width, int height) {
+	return x >= 0 && x < width && y >= 0 && y < height;
+}
+
+// Offsets in [-radius, radius] that keep center + offset inside [0, size). Iterating only over these visits
+// the in-bounds part of a receptive field in the same order as the kernels, without a test per connection
+static void clipRange(int center, int radius, int size, int &lower, int &upper) {
+	lower = std::max(-radius, -center);
+	upper = std::min(radius, size - 1 - center);
+}
+
+static void initializeConnections(float* connections, int width, int height, int numConnections, float minWeight, float maxWeight, int stride, std::mt19937 &generator) {
+	uint32_t seedX, seedY;
+
+	randomSeed(generator, seedX, seedY);
+
+	for (int x = 0; x < width; x++)
+		for (int y = 0; y < height; y++) {
+			uint32_t stateX = seedX + (x * 29 + 12) * 36;
+			uint32_t stateY = seedY + (y * 16 + 23) * 36;
+
+			float* unitConnections = connections + (x + y * width) * numConnections * stride;
+
+			for (int ci = 0; ci < numConnections; ci++)
+				unitConnections[ci * stride] = randFloat(stateX, stateY) * (maxWeight - minWeight) + minWeight;
+		}
+}
+
+// Every kernel runs one task per column of units. Units only write their own outputs and connections, so the results
+// do not depend on the number of threads. Zero inputs are skipped where they would only add zero to a sum
+
+static void ffActivate(const std::vector<float> &inputs, const std::vector<float> &ffStatesPrev,
+	const std::vector<float> &ffConnections, const std::vector<float> &recConnections,
+	std::vector<float> &ffActivations,
+	int width, int height, int inputsWidth, int inputsHeight,
+	int ffRadius, int recRadius,
+	float scalarX, float scalarY,
+	sys::ThreadPool* pool)
+{
+	int ffDiam = 2 * ffRadius + 1;
+	int recDiam = 2 * recRadius + 1;
+
+	int ffSize = ffDiam * ffDiam + 1;
+	int recSize = recDiam * recDiam;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int centerX = static_cast<int>(x * scalarX + 0.5f);
+
+		int dxLower, dxUpper;
+		clipRange(centerX, ffRadius, inputsWidth, dxLower, dxUpper);
+
+		int rxLower, rxUpper;
+		clipRange(x, recRadius, width, rxLower, rxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int unit = x + y * width;
+
+			int centerY = static_cast<int>(y * scalarY + 0.5f);
+
+			int dyLower, dyUpper;
+			clipRange(centerY, ffRadius, inputsHeight, dyLower, dyUpper);
+
+			const float* ffUnit = &ffConnections[unit * ffSize];
+			const float* recUnit = &recConnections[unit * recSize];
+
+			float activation = 0.0f;
+
+			for (int dx = dxLower; dx <= dxUpper; dx++) {
+				const float* column = &inputs[centerX + dx + centerY * inputsWidth];
+				const float* weights = ffUnit + (dx + ffRadius) * ffDiam + ffRadius;
+
+				for (int dy = dyLower; dy <= dyUpper; dy++) {
+					float input = column[dy * inputsWidth];
+
+					if (input != 0.0f)
+						activation += input * weights[dy];
+				}
+			}
+
+			// Bias
+			activation += ffUnit[ffSize - 1];
+
+			int ryLower, ryUpper;
+			clipRange(y, recRadius, height, ryLower, ryUpper);
+
+			for (int dx = rxLower; dx <= rxUpper; dx++) {
+				const float* column = &ffStatesPrev[x + dx + y * width];
+				const float* weights = recUnit + (dx + recRadius) * recDiam + recRadius;
+
+				for (int dy = ryLower; dy <= ryUpper; dy++) {
+					float input = column[dy * width];
+
+					if (input != 0.0f)
+						activation += input * weights[dy];
+				}
+			}
+
+			ffActivations[unit] = activation;
+		}
+	});
+}
+
+static void ffInhibit(const std::vector<float> &ffActivations, std::vector<float> &ffStates,
+	int width, int height, int lRadius, float numActive, float sparsity,
+	sys::ThreadPool* pool)
+{
+	sys::parallelFor(pool, width, [&](int x) {
+		bool interiorX = x >= lRadius && x < width - lRadius;
+
+		for (int y = 0; y < height; y++) {
+			float thisActivation = ffActivations[x + y * width];
+
+			float inhibition = 0.0f;
+
+			if (interiorX && y >= lRadius && y < height - lRadius) {
+				// Only whole counts are added, which integers hold exactly
+				int count = 0;
+
+				for (int dx = -lRadius; dx <= lRadius; dx++) {
+					const float* column = &ffActivations[x + dx + y * width];
+
+					for (int dy = -lRadius; dy <= lRadius; dy++)
+						count += column[dy * width] >= thisActivation ? 1 : 0;
+				}
+
+				// The unit itself always counts
+				inhibition = count - 1;
+			}
+			else {
+				// Border units add the sparsity for every neighbour outside of the layer, in kernel order
+				for (int dx = -lRadius; dx <= lRadius; dx++)
+					for (int dy = -lRadius; dy <= lRadius; dy++) {
+						if (dx == 0 && dy == 0)
+							continue;
+
+						int lx = x + dx;
+						int ly = y + dy;
+
+						if (inBounds(lx, ly, width, height))
+							inhibition += ffActivations[lx + ly * width] >= thisActivation ? 1.0f : 0.0f;
+						else
+							inhibition += sparsity;
+					}
+			}
+
+			ffStates[x + y * width] = inhibition > numActive ? 0.0f : 1.0f;
+		}
+	});
+}
+
+// fbActivate and fbActivateFirst, the latter has no ffStates and no bias
+static void fbActivate(const std::vector<float> &inputs, const std::vector<float>* ffStates,
+	const std::vector<BIDInetHost::Connection> &fbConnections, const std::vector<BIDInetHost::Connection> &predConnections,
+	std::vector<float> &fbStates, std::vector<float> &fbStatesExploratory,
+	int inputsWidth, int inputsHeight, int width, int height,
+	int fbRadius, int predRadius,
+	float scalarX, float scalarY,
+	float breakChance,
+	uint32_t seedX, uint32_t seedY,
+	sys::ThreadPool* pool)
+{
+	int fbDiam = 2 * fbRadius + 1;
+	int predDiam = 2 * predRadius + 1;
+
+	int fbSize = fbDiam * fbDiam + 1;
+	int predSize = predDiam * predDiam + 1;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int centerX = static_cast<int>(x * scalarX + 0.5f);
+
+		int dxLower, dxUpper;
+		clipRange(centerX, fbRadius, inputsWidth, dxLower, dxUpper);
+
+		int pxLower, pxUpper;
+		clipRange(x, predRadius, width, pxLower, pxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int unit = x + y * width;
+
+			uint32_t stateX = seedX + (x * 23 + 4) * 4;
+			uint32_t stateY = seedY + (y * 7 + 56) * 4;
+
+			int centerY = static_cast<int>(y * scalarY + 0.5f);
+
+			int dyLower, dyUpper;
+			clipRange(centerY, fbRadius, inputsHeight, dyLower, dyUpper);
+
+			const BIDInetHost::Connection* fbUnit = &fbConnections[unit * fbSize];
+
+			float activation = 0.0f;
+
+			for (int dx = dxLower; dx <= dxUpper; dx++) {
+				const float* column = &inputs[centerX + dx + centerY * inputsWidth];
+				const BIDInetHost::Connection* weights = fbUnit + (dx + fbRadius) * fbDiam + fbRadius;
+
+				for (int dy = dyLower; dy <= dyUpper; dy++)
+					activation += weights[dy]._weight * column[dy * inputsWidth];
+			}
+
+			if (ffStates != nullptr) {
+				activation += fbUnit[fbSize - 1]._weight;
+
+				const BIDInetHost::Connection* predUnit = &predConnections[unit * predSize];
+
+				int pyLower, pyUpper;
+				clipRange(y, predRadius, height, pyLower, pyUpper);
+
+				for (int dx = pxLower; dx <= pxUpper; dx++) {
+					const float* column = &(*ffStates)[x + dx + y * width];
+					const BIDInetHost::Connection* weights = predUnit + (dx + predRadius) * predDiam + predRadius;
+
+					for (int dy = pyLower; dy <= pyUpper; dy++) {
+						float input = column[dy * width];
+
+						if (input != 0.0f)
+							activation += weights[dy]._weight * input;
+					}
+				}
+			}
+
+			float state = sigmoid(activation);
+
+			float stateExp = state;
+
+			if (randFloat(stateX, stateY) < breakChance)
+				stateExp = randFloat(stateX, stateY);
+
+			fbStates[unit] = state;
+			fbStatesExploratory[unit] = stateExp;
+		}
+	});
+}
+
+static void ffReconstruct(const std::vector<float> &ffStates, const std::vector<float> &ffConnections, std::vector<float> &reconstruction,
+	int ffRadius, int reverseRadiusX, int reverseRadiusY,
+	int inputsWidth, int inputsHeight, int width, int height,
+	float layerToInputsX, float layerToInputsY, float inputsToLayerX, float inputsToLayerY,
+	sys::ThreadPool* pool)
+{
+	int ffDiam = 2 * ffRadius + 1;
+	int ffSize = ffDiam * ffDiam + 1;
+
+	sys::parallelFor(pool, inputsWidth, [&](int x) {
+		int layerCenterX = static_cast<int>(x * inputsToLayerX + 0.5f);
+
+		int dxLower, dxUpper;
+		clipRange(layerCenterX, reverseRadiusX, width, dxLower, dxUpper);
+
+		for (int y = 0; y < inputsHeight; y++) {
+			int layerCenterY = static_cast<int>(y * inputsToLayerY + 0.5f);
+
+			int dyLower, dyUpper;
+			clipRange(layerCenterY, reverseRadiusY, height, dyLower, dyUpper);
+
+			float recon = 0.0f;
+
+			for (int dx = dxLower; dx <= dxUpper; dx++) {
+				int lx = layerCenterX + dx;
+
+				// Next layer node's receptive field
+				int rdx = x - (static_cast<int>(lx * layerToInputsX + 0.5f) - ffRadius);
+
+				if (rdx < 0 || rdx >= ffDiam)
+					continue;
+
+				for (int dy = dyLower; dy <= dyUpper; dy++) {
+					int ly = layerCenterY + dy;
+
+					int unit = lx + ly * width;
+
+					if (ffStates[unit] == 0.0f)
+						continue;
+
+					int rdy = y - (static_cast<int>(ly * layerToInputsY + 0.5f) - ffRadius);
+
+					if (rdy >= 0 && rdy < ffDiam)
+						recon += ffStates[unit] * ffConnections[unit * ffSize + rdy + rdx * ffDiam];
+				}
+			}
+
+			reconstruction[x + y * inputsWidth] = recon;
+		}
+	});
+}
+
+static void recReconstruct(const std::vector<float> &ffStates, const std::vector<float> &recConnections, std::vector<float> &reconstruction,
+	int recRadius, int width, int height,
+	sys::ThreadPool* pool)
+{
+	int recDiam = 2 * recRadius + 1;
+	int recSize = recDiam * recDiam;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int dxLower, dxUpper;
+		clipRange(x, recRadius, width, dxLower, dxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int dyLower, dyUpper;
+			clipRange(y, recRadius, height, dyLower, dyUpper);
+
+			float recon = 0.0f;
+
+			for (int dx = dxLower; dx <= dxUpper; dx++)
+				for (int dy = dyLower; dy <= dyUpper; dy++) {
+					int unit = (x + dx) + (y + dy) * width;
+
+					if (ffStates[unit] != 0.0f)
+						recon += ffStates[unit] * recConnections[unit * recSize + (recRadius - dy) + (recRadius - dx) * recDiam];
+				}
+
+			reconstruction[x + y * width] = recon;
+		}
+	});
+}
+
+static void ffConnectionUpdate(const std::vector<float> &inputs, std::vector<float> &ffConnections,
+	const std::vector<float> &ffReconstruction, const std::vector<float> &ffStates,
+	int width, int height, int inputsWidth, int inputsHeight,
+	int ffRadius, float scalarX, float scalarY,
+	float ffAlpha, float ffGamma, float sparsity,
+	sys::ThreadPool* pool)
+{
+	int ffDiam = 2 * ffRadius + 1;
+	int ffSize = ffDiam * ffDiam + 1;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int centerX = static_cast<int>(x * scalarX + 0.5f);
+
+		int dxLower, dxUpper;
+		clipRange(centerX, ffRadius, inputsWidth, dxLower, dxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int unit = x + y * width;
+
+			float ffState = ffStates[unit];
+
+			float* ffUnit = &ffConnections[unit * ffSize];
+
+			// Inactive units have nothing to learn but their bias
+			if (ffState != 0.0f) {
+				int centerY = static_cast<int>(y * scalarY + 0.5f);
+
+				int dyLower, dyUpper;
+				clipRange(centerY, ffRadius, inputsHeight, dyLower, dyUpper);
+
+				float rate = ffAlpha * ffState;
+
+				for (int dx = dxLower; dx <= dxUpper; dx++) {
+					int offset = centerX + dx + centerY * inputsWidth;
+
+					const float* inputColumn = &inputs[offset];
+					const float* reconColumn = &ffReconstruction[offset];
+
+					float* weights = ffUnit + (dx + ffRadius) * ffDiam + ffRadius;
+
+					for (int dy = dyLower; dy <= dyUpper; dy++)
+						weights[dy] += rate * (inputColumn[dy * inputsWidth] - reconColumn[dy * inputsWidth]);
+				}
+			}
+
+			// Bias
+			ffUnit[ffSize - 1] += ffGamma * (sparsity - ffState);
+		}
+	});
+}
+
+static void recConnectionUpdate(const std::vector<float> &ffStatesPrev, std::vector<float> &recConnections,
+	const std::vector<float> &recReconstruction, const std::vector<float> &ffStates,
+	int width, int height, int recRadius, float ffAlpha,
+	sys::ThreadPool* pool)
+{
+	int recDiam = 2 * recRadius + 1;
+	int recSize = recDiam * recDiam;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int dxLower, dxUpper;
+		clipRange(x, recRadius, width, dxLower, dxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int unit = x + y * width;
+
+			float ffState = ffStates[unit];
+
+			if (ffState == 0.0f)
+				continue;
+
+			int dyLower, dyUpper;
+			clipRange(y, recRadius, height, dyLower, dyUpper);
+
+			float rate = ffAlpha * ffState;
+
+			float* recUnit = &recConnections[unit * recSize];
+
+			for (int dx = dxLower; dx <= dxUpper; dx++) {
+				int offset = x + dx + y * width;
+
+				const float* inputColumn = &ffStatesPrev[offset];
+				const float* reconColumn = &recReconstruction[offset];
+
+				float* weights = recUnit + (dx + recRadius) * recDiam + recRadius;
+
+				for (int dy = dyLower; dy <= dyUpper; dy++)
+					weights[dy] += rate * (inputColumn[dy * width] - reconColumn[dy * width]);
+			}
+		}
+	});
+}
+
+// fbConnectionUpdate and predConnectionUpdate share everything but where the inputs come from
+static void traceConnectionUpdate(const std::vector<float> &inputsPrev, const std::vector<float> &inputs,
+	std::vector<BIDInetHost::Connection> &connections,
+	const std::vector<float> &fbStatesPrev, const std::vector<float> &fbStates, const std::vector<float> &fbStatesExploratory,
+	const std::vector<float> &ffStates,
+	int inputsWidth, int inputsHeight, int width, int height,
+	int radius, bool centered, float scalarX, float scalarY,
+	float fbPredAlpha, float fbRLAlpha, float fbLambdaGamma,
+	float rlError,
+	sys::ThreadPool* pool)
+{
+	int diam = 2 * radius + 1;
+	int size = diam * diam + 1;
+
+	float rlRate = fbRLAlpha * rlError;
+
+	sys::parallelFor(pool, width, [&](int x) {
+		int centerX = centered ? x : static_cast<int>(x * scalarX + 0.5f);
+
+		int dxLower, dxUpper;
+		clipRange(centerX, radius, inputsWidth, dxLower, dxUpper);
+
+		for (int y = 0; y < height; y++) {
+			int unit = x + y * width;
+
+			int centerY = centered ? y : static_cast<int>(y * scalarY + 0.5f);
+
+			int dyLower, dyUpper;
+			clipRange(centerY, radius, inputsHeight, dyLower, dyUpper);
+
+			float fbState = fbStates[unit];
+
+			float delta = fbStatesExploratory[unit] - fbState;
+
+			float predError = ffStates[unit] - fbStatesPrev[unit];
+
+			float predRate = fbPredAlpha * predError;
+
+			BIDInetHost::Connection* unitConnections = &connections[unit * size];
+
+			for (int dx = dxLower; dx <= dxUpper; dx++) {
+				int offset = centerX + dx + centerY * inputsWidth;
+
+				const float* inputColumn = &inputs[offset];
+				const float* inputPrevColumn = &inputsPrev[offset];
+
+				BIDInetHost::Connection* column = unitConnections + (dx + radius) * diam + radius;
+
+				for (int dy = dyLower; dy <= dyUpper; dy++) {
+					BIDInetHost::Connection &c = column[dy];
+
+					float weight = c._weight + rlRate * c._trace + predRate * inputPrevColumn[dy * inputsWidth];
+
+					c._trace = c._trace * fbLambdaGamma + delta * inputColumn[dy * inputsWidth];
+					c._weight = weight;
+				}
+			}
+
+			BIDInetHost::Connection &bias = unitConnections[size - 1];
+
+			float weight = bias._weight + rlRate * bias._trace + predRate;
+
+			bias._trace = bias._trace * fbLambdaGamma + delta;
+			bias._weight = weight;
+		}
+	});
+}
+
+void BIDInetHost::createRandom(int inputWidth, int inputHeight, const std::vector<InputType> &inputTypes,
+	const InputDesc &inputDesc, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, std::mt19937 &generator)
+{
+	_inputWidth = inputWidth;
+	_inputHeight = inputHeight;
+	_inputTypes = inputTypes;
+	_inputDesc = inputDesc;
+	_layerDescs = layerDescs;
+
+	_layers.resize(_layerDescs.size());
+
+	for (int l = 0; l < _layers.size(); l++) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		int inputsWidth = l == 0 ? _inputWidth : _layerDescs[l - 1]._width;
+		int inputsHeight = l == 0 ? _inputHeight : _layerDescs[l - 1]._height;
+
+		int numUnits = desc._width * desc._height;
+
+		layer._ffActivations.assign(numUnits, 0.0f);
+		layer._ffStates.assign(numUnits, 0.0f);
+		layer._ffStatesPrev.assign(numUnits, 0.0f);
+		layer._ffReconstruction.assign(inputsWidth * inputsHeight, 0.0f);
+		layer._recReconstruction.assign(numUnits, 0.0f);
+		layer._fbStates.assign(numUnits, 0.0f);
+		layer._fbStatesPrev.assign(numUnits, 0.0f);
+		layer._fbStatesExploratory.assign(numUnits, 0.0f);
+		layer._fbStatesExploratoryPrev.assign(numUnits, 0.0f);
+
+		int ffSize = (2 * desc._ffRadius + 1) * (2 * desc._ffRadius + 1) + 1;
+		int recSize = (2 * desc._recRadius + 1) * (2 * desc._recRadius + 1);
+		int fbSize = (2 * desc._fbRadius + 1) * (2 * desc._fbRadius + 1) + 1;
+		int predSize = (2 * desc._predRadius + 1) * (2 * desc._predRadius + 1) + 1;
+
+		layer._ffConnections.assign(numUnits * ffSize, 0.0f);
+		layer._recConnections.assign(numUnits * recSize, 0.0f);
+		layer._fbConnections.assign(numUnits * fbSize, Connection());
+		layer._predConnections.assign(numUnits * predSize, Connection());
+
+		initializeConnections(layer._ffConnections.data(), desc._width, desc._height, ffSize, initMinWeight, initMaxWeight, 1, generator);
+		initializeConnections(layer._recConnections.data(), desc._width, desc._height, recSize, initMinWeight, initMaxWeight, 1, generator);
+		initializeConnections(&layer._fbConnections[0]._weight, desc._width, desc._height, fbSize, initMinWeight, initMaxWeight, 2, generator);
+		initializeConnections(&layer._predConnections[0]._weight, desc._width, desc._height, predSize, initMinWeight, initMaxWeight, 2, generator);
+	}
+
+	int numInputs = _inputWidth * _inputHeight;
+
+	_inputs.assign(numInputs, 0.0f);
+	_inputsPrev.assign(numInputs, 0.0f);
+	_predictions.assign(numInputs, 0.0f);
+	_predictionsPrev.assign(numInputs, 0.0f);
+	_actions.assign(numInputs, 0.0f);
+
+	int inputFbSize = (2 * _inputDesc._fbRadius + 1) * (2 * _inputDesc._fbRadius + 1) + 1;
+	int inputPredSize = (2 * _inputDesc._predRadius + 1) * (2 * _inputDesc._predRadius + 1) + 1;
+
+	_inputFbConnections.assign(numInputs * inputFbSize, Connection());
+	_inputPredConnections.assign(numInputs * inputPredSize, Connection());
+
+	initializeConnections(&_inputFbConnections[0]._weight, _inputWidth, _inputHeight, inputFbSize, initMinWeight, initMaxWeight, 2, generator);
+	initializeConnections(&_inputPredConnections[0]._weight, _inputWidth, _inputHeight, inputPredSize, initMinWeight, initMaxWeight, 2, generator);
+
+	_averageReward = 0.0f;
+}
+
+void BIDInetHost::fbStep(const std::vector<float> &inputs, const std::vector<float> &inputsPrev, const std::vector<float> &ffStates, const std::vector<float> &ffStatesPrev,
+	std::vector<float> &fbStates, const std::vector<float> &fbStatesPrev, std::vector<float> &fbStatesExploratory,
+	std::vector<Connection> &fbConnections, std::vector<Connection> &predConnections,
+	int inputsWidth, int inputsHeight, int width, int height,
+	int fbRadius, int predRadius, float fbPredAlpha, float fbRLAlpha, float fbLambdaGamma, float breakChance,
+	bool first, float rlError, std::mt19937 &generator, bool learn)
+{
+	float scalarX = static_cast<float>(inputsWidth) / width;
+	float scalarY = static_cast<float>(inputsHeight) / height;
+
+	uint32_t seedX, seedY;
+
+	randomSeed(generator, seedX, seedY);
+
+	fbActivate(inputs, first ? nullptr : &ffStates, fbConnections, predConnections, fbStates, fbStatesExploratory,
+		inputsWidth, inputsHeight, width, height, fbRadius, predRadius, scalarX, scalarY, breakChance, seedX, seedY, _threadPool.get());
+
+	if (!learn)
+		return;
+
+	traceConnectionUpdate(inputsPrev, inputs, fbConnections, fbStatesPrev, fbStates, fbStatesExploratory, ffStates,
+		inputsWidth, inputsHeight, width, height, fbRadius, false, scalarX, scalarY, fbPredAlpha, fbRLAlpha, fbLambdaGamma, rlError, _threadPool.get());
+
+	if (first)
+		return;
+
+	traceConnectionUpdate(ffStatesPrev, ffStates, predConnections, fbStatesPrev, fbStates, fbStatesExploratory, ffStates,
+		width, height, width, height, predRadius, true, 1.0f, 1.0f, fbPredAlpha, fbRLAlpha, fbLambdaGamma, rlError, _threadPool.get());
+}
+
+void BIDInetHost::simStep(float reward, std::mt19937 &generator, bool learn) {
+	// Actions of the last step become the action inputs
+	for (int i = 0; i < _inputs.size(); i++)
+		if (_inputTypes[i] == _action)
+			_inputs[i] = _actions[i];
+
+	std::swap(_predictions, _predictionsPrev);
+
+	for (int l = 0; l < _layers.size(); l++) {
+		std::swap(_layers[l]._ffStates, _layers[l]._ffStatesPrev);
+		std::swap(_layers[l]._fbStates, _layers[l]._fbStatesPrev);
+		std::swap(_layers[l]._fbStatesExploratory, _layers[l]._fbStatesExploratoryPrev);
+	}
+
+	float rlError = reward - _averageReward;
+
+	_averageReward += _rewardAverageDecay * (reward - _averageReward);
+
+	// Feed forward
+	for (int l = 0; l < _layers.size(); l++) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		const std::vector<float> &inputs = l == 0 ? _inputs : _layers[l - 1]._ffStates;
+
+		int inputsWidth = l == 0 ? _inputWidth : _layerDescs[l - 1]._width;
+		int inputsHeight = l == 0 ? _inputHeight : _layerDescs[l - 1]._height;
+
+		float layerToInputsX = static_cast<float>(inputsWidth) / desc._width;
+		float layerToInputsY = static_cast<float>(inputsHeight) / desc._height;
+		float inputsToLayerX = static_cast<float>(desc._width) / inputsWidth;
+		float inputsToLayerY = static_cast<float>(desc._height) / inputsHeight;
+
+		ffActivate(inputs, layer._ffStatesPrev, layer._ffConnections, layer._recConnections, layer._ffActivations,
+			desc._width, desc._height, inputsWidth, inputsHeight, desc._ffRadius, desc._recRadius, layerToInputsX, layerToInputsY, _threadPool.get());
+
+		float lDiam = 2 * desc._lRadius + 1;
+
+		ffInhibit(layer._ffActivations, layer._ffStates, desc._width, desc._height, desc._lRadius, desc._sparsity * lDiam * lDiam, desc._sparsity, _threadPool.get());
+
+		if (!learn)
+			continue;
+
+		int reverseRadiusX = static_cast<int>(std::ceil(inputsToLayerX * (desc._ffRadius + 0.5f))) + 1;
+		int reverseRadiusY = static_cast<int>(std::ceil(inputsToLayerY * (desc._ffRadius + 0.5f))) + 1;
+
+		ffReconstruct(layer._ffStates, layer._ffConnections, layer._ffReconstruction, desc._ffRadius, reverseRadiusX, reverseRadiusY,
+			inputsWidth, inputsHeight, desc._width, desc._height, layerToInputsX, layerToInputsY, inputsToLayerX, inputsToLayerY, _threadPool.get());
+
+		recReconstruct(layer._ffStates, layer._recConnections, layer._recReconstruction, desc._recRadius, desc._width, desc._height, _threadPool.get());
+
+		ffConnectionUpdate(inputs, layer._ffConnections, layer._ffReconstruction, layer._ffStates,
+			desc._width, desc._height, inputsWidth, inputsHeight, desc._ffRadius, layerToInputsX, layerToInputsY,
+			desc._ffAlpha, desc._ffGamma, desc._sparsity, _threadPool.get());
+
+		recConnectionUpdate(layer._ffStatesPrev, layer._recConnections, layer._recReconstruction, layer._ffStates,
+			desc._width, desc._height, desc._recRadius, desc._ffAlpha, _threadPool.get());
+	}
+
+	// Feed back, from the top down
+	for (int l = _layers.size() - 1; l >= 0; l--) {
+		const LayerDesc &desc = _layerDescs[l];
+		Layer &layer = _layers[l];
+
+		bool first = l == _layers.size() - 1;
+
+		if (first)
+			fbStep(layer._ffStates, layer._ffStatesPrev, layer._ffStates, layer._ffStatesPrev,
+			layer._fbStates, layer._fbStatesPrev, layer._fbStatesExploratory,
+			layer._fbConnections, layer._predConnections,
+			desc._width, desc._height, desc._width, desc._height,
+			desc._fbRadius, desc._predRadius, desc._fbPredAlpha, desc._fbRLAlpha, desc._fbLambdaGamma, desc._breakChance,
+			true, rlError, generator, learn);
+		else
+			fbStep(_layers[l + 1]._fbStatesExploratory, _layers[l + 1]._fbStatesExploratoryPrev, layer._ffStates, layer._ffStatesPrev,
+			layer._fbStates, layer._fbStatesPrev, layer._fbStatesExploratory,
+			layer._fbConnections, layer._predConnections,
+			_layerDescs[l + 1]._width, _layerDescs[l + 1]._height, desc._width, desc._height,
+			desc._fbRadius, desc._predRadius, desc._fbPredAlpha, desc._fbRLAlpha, desc._fbLambdaGamma, desc._breakChance,
+			false, rlError, generator, learn);
+	}
+
+	// Predictions of the next inputs
+	fbStep(_layers.front()._fbStatesExploratory, _layers.front()._fbStatesExploratoryPrev, _inputs, _inputsPrev,
+		_predictions, _predictionsPrev, _actions,
+		_inputFbConnections, _inputPredConnections,
+		_layerDescs.front()._width, _layerDescs.front()._height, _inputWidth, _inputHeight,
+		_inputDesc._fbRadius, _inputDesc._predRadius, _inputDesc._fbPredAlpha, _inputDesc._fbRLAlpha, _inputDesc._fbLambdaGamma, _inputDesc._breakChance,
+		false, rlError, generator, learn);
+
+	_inputsPrev = _inputs;
+}
\ No newline at end of file
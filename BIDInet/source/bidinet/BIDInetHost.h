@@ -0,0 +1,134 @@
+#pragma once
+
+#include "BIDInetDescs.h"
+
+#include <system/ThreadPool.h>
+
+#include <random>
+#include <memory>
+
+namespace bidi {
+	// Native C++ execution of BIDInet, for hosts without an OpenCL driver and as the reference the OpenCL results are checked against.
+	// Every kernel of resources/bidinet.cl runs as a parallel loop over units, summing each receptive field in the same order
+	// and drawing from the same random streams, so results do not depend on the number of threads
+	class BIDInetHost {
+	public:
+		typedef bidi::InputType InputType;
+		typedef bidi::LayerDesc LayerDesc;
+		typedef bidi::InputDesc InputDesc;
+
+		struct Connection {
+			float _weight;
+			float _trace;
+
+			Connection()
+				: _weight(0.0f), _trace(0.0f)
+			{}
+		};
+
+		// Sheets are stored row by row. Connections are stored per unit, numConnections apart
+		struct Layer {
+			std::vector<float> _ffActivations;
+			std::vector<float> _ffStates, _ffStatesPrev;
+
+			std::vector<float> _ffReconstruction;
+			std::vector<float> _recReconstruction;
+
+			std::vector<float> _fbStates, _fbStatesPrev;
+			std::vector<float> _fbStatesExploratory, _fbStatesExploratoryPrev;
+
+			std::vector<float> _ffConnections;
+			std::vector<float> _recConnections;
+
+			std::vector<Connection> _fbConnections;
+			std::vector<Connection> _predConnections;
+		};
+
+	private:
+		int _inputWidth, _inputHeight;
+
+		std::vector<InputType> _inputTypes;
+
+		InputDesc _inputDesc;
+		std::vector<LayerDesc> _layerDescs;
+		std::vector<Layer> _layers;
+
+		std::vector<float> _inputs, _inputsPrev;
+
+		std::vector<float> _predictions, _predictionsPrev;
+		std::vector<float> _actions;
+
+		std::vector<Connection> _inputFbConnections;
+		std::vector<Connection> _inputPredConnections;
+
+		float _averageReward;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+		void fbStep(const std::vector<float> &inputs, const std::vector<float> &inputsPrev, const std::vector<float> &ffStates, const std::vector<float> &ffStatesPrev,
+			std::vector<float> &fbStates, const std::vector<float> &fbStatesPrev, std::vector<float> &fbStatesExploratory,
+			std::vector<Connection> &fbConnections, std::vector<Connection> &predConnections,
+			int inputsWidth, int inputsHeight, int width, int height,
+			int fbRadius, int predRadius, float fbPredAlpha, float fbRLAlpha, float fbLambdaGamma, float breakChance,
+			bool first, float rlError, std::mt19937 &generator, bool learn);
+
+	public:
+		float _rewardAverageDecay;
+
+		BIDInetHost()
+			: _inputWidth(0), _inputHeight(0), _averageReward(0.0f), _rewardAverageDecay(0.01f)
+		{}
+
+		// Same arguments and random draws as BIDInet::createRandom, without the compute system
+		void createRandom(int inputWidth, int inputHeight, const std::vector<InputType> &inputTypes,
+			const InputDesc &inputDesc, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, std::mt19937 &generator);
+
+		void simStep(float reward, std::mt19937 &generator, bool learn = true);
+
+		// Runs every kernel on the pool, serially without one
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		void setInput(int index, float value) {
+			_inputs[index] = value;
+		}
+
+		void setInput(int x, int y, float value) {
+			setInput(x + y * _inputWidth, value);
+		}
+
+		void setInputs(const float* inputs) {
+			for (int i = 0; i < _inputs.size(); i++)
+				_inputs[i] = inputs[i];
+		}
+
+		float getPrediction(int index) const {
+			return _predictions[index];
+		}
+
+		float getAction(int index) const {
+			return _actions[index];
+		}
+
+		const std::vector<float> &getPredictions() const {
+			return _predictions;
+		}
+
+		const std::vector<float> &getActions() const {
+			return _actions;
+		}
+
+		int getNumInputs() const {
+			return _inputs.size();
+		}
+
+		const std::vector<LayerDesc> &getLayerDescs() const {
+			return _layerDescs;
+		}
+
+		const std::vector<Layer> &getLayers() const {
+			return _layers;
+		}
+	};
+}
\ No newline at end of file
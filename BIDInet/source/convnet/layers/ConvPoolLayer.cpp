@@ -0,0 +1,244 @@
+#include "ConvPoolLayer.h"
+
+#include <algorithm>
+
+#include <assert.h>
+
+using namespace convnet;
+
+void ConvPoolLayer::create(Layer &input, int convOutputWidth, int convOutputHeight, int convOutputNumMaps, int convWidth, int convHeight,
+	int width, int height, int numMaps, int poolWidth, int poolHeight,
+	float initMinWeight, float initMaxWeight, std::mt19937 &generator)
+{
+	_outputMaps.resize(numMaps);
+
+	_errorMaps.resize(numMaps);
+
+	for (int m = 0; m < _outputMaps.size(); m++)
+		_outputMaps[m].create(width, height);
+
+	for (int m = 0; m < _errorMaps.size(); m++)
+		_errorMaps[m].create(width, height);
+
+	_convWidth = convWidth;
+	_convHeight = convHeight;
+	_convNumMaps = input.getNumMaps();
+
+	_convOutputWidth = convOutputWidth;
+	_convOutputHeight = convOutputHeight;
+	_convOutputNumMaps = convOutputNumMaps;
+
+	_poolWidth = poolWidth;
+	_poolHeight = poolHeight;
+
+	_maxIndices.assign(width * height, -1);
+	_maxActivations.assign(width * height, 0.0f);
+	_maxErrors.assign(width * height, 0.0f);
+
+	// Create kernels
+	_mapKernels.resize(_convOutputNumMaps);
+
+	int connectionsSize = _convWidth * _convHeight * _convNumMaps;
+
+	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
+
+	for (int m = 0; m < _mapKernels.size(); m++) {
+		_mapKernels[m]._connections.resize(connectionsSize);
+
+		for (int c = 0; c < connectionsSize; c++)
+			_mapKernels[m]._connections[c]._weight = weightDist(generator);
+	}
+}
+
+float ConvPoolLayer::convolve(const std::vector<Map> &inputMaps, int m, int cx, int cy) const {
+	float convToInputX = static_cast<float>(inputMaps.front().getWidth()) / _convOutputWidth;
+	float convToInputY = static_cast<float>(inputMaps.front().getHeight()) / _convOutputHeight;
+
+	int lowerX = std::ceil(-_convWidth * 0.5f);
+	int upperX = std::ceil(_convWidth * 0.5f);
+	int lowerY = std::ceil(-_convHeight * 0.5f);
+	int upperY = std::ceil(_convHeight * 0.5f);
+
+	int centerX = std::round(convToInputX * cx);
+	int centerY = std::round(convToInputY * cy);
+
+	const std::vector<Connection> &connections = _mapKernels[m]._connections;
+
+	float sum = 0.0f;
+
+	int wi = 0;
+
+	for (int dx = lowerX; dx < upperX; dx++)
+		for (int dy = lowerY; dy < upperY; dy++) {
+			int xo = centerX + dx;
+			int yo = centerY + dy;
+
+			if (xo >= 0 && xo < inputMaps.front().getWidth() && yo >= 0 && yo < inputMaps.front().getHeight()) {
+				for (int mo = 0; mo < inputMaps.size(); mo++) {
+					sum += connections[wi]._weight * inputMaps[mo].atXY(xo, yo);
+
+					wi++;
+				}
+			}
+			else
+				wi += inputMaps.size();
+		}
+
+	return sum;
+}
+
+void ConvPoolLayer::forward(const std::vector<Map> &inputMaps) {
+	float poolToConvX = static_cast<float>(_convOutputWidth) / _outputMaps.front().getWidth();
+	float poolToConvY = static_cast<float>(_convOutputHeight) / _outputMaps.front().getHeight();
+
+	int lowerX = std::ceil(-_poolWidth * 0.5f);
+	int upperX = std::ceil(_poolWidth * 0.5f);
+	int lowerY = std::ceil(-_poolHeight * 0.5f);
+	int upperY = std::ceil(_poolHeight * 0.5f);
+
+	int width = _outputMaps.front().getWidth();
+	int height = _outputMaps.front().getHeight();
+
+	sys::parallelFor(_threadPool, width, [&](int x) {
+		for (int y = 0; y < height; y++) {
+			float pool = -999999.0f;
+
+			int maxIndex = -1;
+
+			int centerX = std::round(poolToConvX * x);
+			int centerY = std::round(poolToConvY * y);
+
+			// Pool over pre-activations, ReLU is monotonic so the maximum is the same
+			for (int dx = lowerX; dx < upperX; dx++)
+				for (int dy = lowerY; dy < upperY; dy++) {
+					int cx = centerX + dx;
+					int cy = centerY + dy;
+
+					if (cx >= 0 && cx < _convOutputWidth && cy >= 0 && cy < _convOutputHeight) {
+						for (int m = 0; m < _convOutputNumMaps; m++) {
+							float sum = convolve(inputMaps, m, cx, cy);
+
+							if (sum > pool) {
+								pool = sum;
+
+								maxIndex = m + (cx + cy * _convOutputWidth) * _convOutputNumMaps;
+							}
+						}
+					}
+				}
+
+			assert(maxIndex != -1);
+
+			int pi = x + y * width;
+
+			_maxIndices[pi] = maxIndex;
+			_maxActivations[pi] = pool;
+
+			// Pooling runs over all convolution maps, so every pooled map receives the same value
+			float output = relu(pool, _reluLeak);
+
+			for (int m = 0; m < _outputMaps.size(); m++)
+				_outputMaps[m][pi] = output;
+		}
+	});
+}
+
+void ConvPoolLayer::gatherErrors() {
+	for (int pi = 0; pi < _maxErrors.size(); pi++) {
+		float sum = 0.0f;
+
+		for (int m = 0; m < _errorMaps.size(); m++)
+			sum += _errorMaps[m][pi];
+
+		_maxErrors[pi] = sum * relud(_maxActivations[pi], _reluLeak);
+	}
+}
+
+void ConvPoolLayer::backward(std::vector<Map> &errorMaps) {
+	gatherErrors();
+
+	float convToInputX = static_cast<float>(errorMaps.front().getWidth()) / _convOutputWidth;
+	float convToInputY = static_cast<float>(errorMaps.front().getHeight()) / _convOutputHeight;
+
+	int lowerX = std::ceil(-_convWidth * 0.5f);
+	int upperX = std::ceil(_convWidth * 0.5f);
+	int lowerY = std::ceil(-_convHeight * 0.5f);
+	int upperY = std::ceil(_convHeight * 0.5f);
+
+	// One task per input error map, only the pooled maxima carry error so only their kernels are scattered
+	sys::parallelFor(_threadPool, errorMaps.size(), [&](int mo) {
+		errorMaps[mo].clear(0.0f);
+
+		for (int pi = 0; pi < _maxIndices.size(); pi++) {
+			float error = _maxErrors[pi];
+
+			if (error == 0.0f)
+				continue;
+
+			int m = _maxIndices[pi] % _convOutputNumMaps;
+			int ci = _maxIndices[pi] / _convOutputNumMaps;
+
+			int centerX = std::round(convToInputX * (ci % _convOutputWidth));
+			int centerY = std::round(convToInputY * (ci / _convOutputWidth));
+
+			int wi = mo;
+
+			for (int dx = lowerX; dx < upperX; dx++)
+				for (int dy = lowerY; dy < upperY; dy++) {
+					int xo = centerX + dx;
+					int yo = centerY + dy;
+
+					if (xo >= 0 && xo < errorMaps.front().getWidth() && yo >= 0 && yo < errorMaps.front().getHeight())
+						errorMaps[mo].atXY(xo, yo) += _mapKernels[m]._connections[wi]._weight * error;
+
+					wi += errorMaps.size();
+				}
+		}
+	});
+}
+
+void ConvPoolLayer::update(const std::vector<Map> &inputMaps) {
+	// Backward is skipped for the first layer after the input, so errors are gathered again here
+	gatherErrors();
+
+	float convToInputX = static_cast<float>(inputMaps.front().getWidth()) / _convOutputWidth;
+	float convToInputY = static_cast<float>(inputMaps.front().getHeight()) / _convOutputHeight;
+
+	int lowerX = std::ceil(-_convWidth * 0.5f);
+	int upperX = std::ceil(_convWidth * 0.5f);
+	int lowerY = std::ceil(-_convHeight * 0.5f);
+	int upperY = std::ceil(_convHeight * 0.5f);
+
+	// Each kernel is only touched by maxima from its own map, so maps update independently
+	sys::parallelFor(_threadPool, _convOutputNumMaps, [&](int m) {
+		for (int pi = 0; pi < _maxIndices.size(); pi++) {
+			float error = _maxErrors[pi];
+
+			if (error == 0.0f || _maxIndices[pi] % _convOutputNumMaps != m)
+				continue;
+
+			int ci = _maxIndices[pi] / _convOutputNumMaps;
+
+			int centerX = std::round(convToInputX * (ci % _convOutputWidth));
+			int centerY = std::round(convToInputY * (ci / _convOutputWidth));
+
+			int wi = 0;
+
+			for (int dx = lowerX; dx < upperX; dx++)
+				for (int dy = lowerY; dy < upperY; dy++) {
+					int xo = centerX + dx;
+					int yo = centerY + dy;
+
+					if (xo >= 0 && xo < inputMaps.front().getWidth() && yo >= 0 && yo < inputMaps.front().getHeight()) {
+						for (int mo = 0; mo < inputMaps.size(); mo++) {
+							_mapKernels[m]._connections[wi]._weight += _alpha * error * inputMaps[mo].atXY(xo, yo);
+
+							wi++;
+						}
+					}
+					else
+						wi += inputMaps.size();
+				}
+		}
+	});
+}
\ No newline at end of file
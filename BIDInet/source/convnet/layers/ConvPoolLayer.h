@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../Layer.h"
+
+namespace convnet {
+	// Convolution, ReLU and max pooling fused into one layer. Same result as a ConvLayer followed by a MaxPoolingLayer,
+	// but the convolution output is never stored - only the pooled maxima and where they came from.
+	class ConvPoolLayer : public Layer {
+	private:
+		struct Connection {
+			float _weight;
+		};
+
+		struct Kernel {
+			std::vector<Connection> _connections;
+		};
+
+		std::vector<Kernel> _mapKernels;
+
+		int _convWidth, _convHeight, _convNumMaps;
+		int _convOutputWidth, _convOutputHeight, _convOutputNumMaps;
+		int _poolWidth, _poolHeight;
+
+		// Per pooled position: convolution map + position of the maximum, its pre-activation and its backpropagated error
+		std::vector<int> _maxIndices;
+		std::vector<float> _maxActivations;
+		std::vector<float> _maxErrors;
+
+		float convolve(const std::vector<Map> &inputMaps, int m, int cx, int cy) const;
+		void gatherErrors();
+
+	public:
+		float _reluLeak;
+
+		float _alpha;
+
+		ConvPoolLayer()
+			: _reluLeak(0.01f), _alpha(0.001f)
+		{}
+
+		// convOutputWidth/Height/NumMaps describe the (never stored) convolution output, width/height/numMaps the pooled output
+		void create(Layer &input, int convOutputWidth, int convOutputHeight, int convOutputNumMaps, int convWidth, int convHeight,
+			int width, int height, int numMaps, int poolWidth, int poolHeight,
+			float initMinWeight, float initMaxWeight, std::mt19937 &generator);
+
+		virtual void forward(const std::vector<Map> &inputMaps);
+		virtual void backward(std::vector<Map> &errorMaps);
+
+		virtual void update(const std::vector<Map> &inputMaps);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "TimeSeries.h"
+
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace data;
+
+namespace data {
+	// Read-only view of a whole file, memory mapped where available
+	class MappedFile {
+	private:
+		const char* _pData;
+		size_t _size;
+
+#ifdef _WIN32
+		std::vector<char> _buffer;
+#endif
+
+	public:
+		MappedFile()
+			: _pData(nullptr), _size(0)
+		{}
+
+		~MappedFile() {
+#ifndef _WIN32
+			if (_pData != nullptr && _size > 0)
+				munmap(const_cast<char*>(_pData), _size);
+#endif
+		}
+
+		bool open(const std::string &fileName) {
+#ifdef _WIN32
+			std::ifstream fromFile(fileName, std::ios::binary);
+
+			if (!fromFile.is_open())
+				return false;
+
+			_buffer.assign(std::istreambuf_iterator<char>(fromFile), std::istreambuf_iterator<char>());
+
+			_pData = _buffer.data();
+			_size = _buffer.size();
+
+			return true;
+#else
+			int fd = ::open(fileName.c_str(), O_RDONLY);
+
+			if (fd < 0)
+				return false;
+
+			struct stat fileStat;
+
+			if (fstat(fd, &fileStat) != 0) {
+				close(fd);
+
+				return false;
+			}
+
+			_size = fileStat.st_size;
+
+			if (_size > 0) {
+				void* pMapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if (pMapped == MAP_FAILED) {
+					close(fd);
+
+					_size = 0;
+
+					return false;
+				}
+
+				madvise(pMapped, _size, MADV_SEQUENTIAL);
+
+				_pData = static_cast<const char*>(pMapped);
+			}
+
+			close(fd);
+
+			return true;
+#endif
+		}
+
+		const char* getData() const {
+			return _pData;
+		}
+
+		size_t getSize() const {
+			return _size;
+		}
+	};
+}
+
+// Parses a decimal number from [pStart, pEnd). Plain decimals (sign, digits, fraction, exponent) are handled directly,
+// anything else (nan, inf, hex, very long mantissas) falls back to strtod
+static double parseNumber(const char* pStart, const char* pEnd) {
+	static const double powersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const char* p = pStart;
+
+	while (p < pEnd && (*p == ' ' || *p == '\t'))
+		p++;
+
+	bool negative = false;
+
+	if (p < pEnd && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+
+		p++;
+	}
+
+	unsigned long long mantissa = 0;
+	int numDigits = 0;
+	int exponent = 0;
+
+	while (p < pEnd && *p >= '0' && *p <= '9') {
+		mantissa = mantissa * 10 + (*p - '0');
+		numDigits++;
+		p++;
+	}
+
+	if (p < pEnd && *p == '.') {
+		p++;
+
+		while (p < pEnd && *p >= '0' && *p <= '9') {
+			mantissa = mantissa * 10 + (*p - '0');
+			numDigits++;
+			exponent--;
+			p++;
+		}
+	}
+
+	if (numDigits > 0 && p < pEnd && (*p == 'e' || *p == 'E')) {
+		p++;
+
+		bool exponentNegative = false;
+
+		if (p < pEnd && (*p == '-' || *p == '+')) {
+			exponentNegative = *p == '-';
+
+			p++;
+		}
+
+		int explicitExponent = 0;
+
+		while (p < pEnd && *p >= '0' && *p <= '9') {
+			explicitExponent = std::min(explicitExponent * 10 + (*p - '0'), 100000);
+			p++;
+		}
+
+		exponent += exponentNegative ? -explicitExponent : explicitExponent;
+	}
+
+	while (p < pEnd && (*p == ' ' || *p == '\t'))
+		p++;
+
+	if (numDigits == 0 || numDigits > 19 || p != pEnd) {
+		char buffer[128];
+
+		size_t length = std::min<size_t>(pEnd - pStart, sizeof(buffer) - 1);
+
+		std::memcpy(buffer, pStart, length);
+		buffer[length] = '\0';
+
+		return std::strtod(buffer, nullptr);
+	}
+
+	double value = static_cast<double>(mantissa);
+
+	if (exponent < 0)
+		value = exponent >= -22 ? value / powersOf10[-exponent] : value * std::pow(10.0, exponent);
+	else if (exponent > 0)
+		value = exponent <= 22 ? value * powersOf10[exponent] : value * std::pow(10.0, exponent);
+
+	return negative ? -value : value;
+}
+
+bool TimeSeries::loadCSV(const std::string &fileName, int numSkipColumns, bool skipHeader) {
+	MappedFile file;
+
+	if (!file.open(fileName))
+		return false;
+
+	const char* p = file.getData();
+	const char* pEnd = p + file.getSize();
+
+	// Number of columns from the first line
+	const char* pLineEnd = p != nullptr ? static_cast<const char*>(std::memchr(p, '\n', pEnd - p)) : nullptr;
+
+	if (pLineEnd == nullptr)
+		pLineEnd = pEnd;
+
+	int numEntries = p != nullptr ? 1 + std::count(p, pLineEnd, ',') : 0;
+
+	_numColumns = std::max(0, numEntries - numSkipColumns);
+
+	if (skipHeader)
+		p = pLineEnd < pEnd ? pLineEnd + 1 : pEnd;
+
+	// Upper bound on the number of rows, so the columns can be laid out before parsing
+	size_t maxRows = 0;
+
+	for (const char* q = p; q < pEnd; maxRows++) {
+		const char* pNext = static_cast<const char*>(std::memchr(q, '\n', pEnd - q));
+
+		q = pNext == nullptr ? pEnd : pNext + 1;
+	}
+
+	_data.assign(_numColumns * maxRows, 0.0f);
+
+	_minimums.assign(_numColumns, std::numeric_limits<float>::max());
+	_maximums.assign(_numColumns, -std::numeric_limits<float>::max());
+
+	size_t row = 0;
+
+	while (p < pEnd) {
+		pLineEnd = static_cast<const char*>(std::memchr(p, '\n', pEnd - p));
+
+		if (pLineEnd == nullptr)
+			pLineEnd = pEnd;
+
+		const char* pContentEnd = pLineEnd;
+
+		if (pContentEnd > p && *(pContentEnd - 1) == '\r')
+			pContentEnd--;
+
+		// Blank lines are not rows
+		if (pContentEnd > p) {
+			const char* pEntry = p;
+
+			for (int e = 0; e < numSkipColumns + _numColumns && pEntry <= pContentEnd; e++) {
+				const char* pEntryEnd = static_cast<const char*>(std::memchr(pEntry, ',', pContentEnd - pEntry));
+
+				if (pEntryEnd == nullptr)
+					pEntryEnd = pContentEnd;
+
+				int c = e - numSkipColumns;
+
+				if (c >= 0 && pEntryEnd > pEntry) {
+					float value = parseNumber(pEntry, pEntryEnd);
+
+					_data[c * maxRows + row] = value;
+
+					_minimums[c] = std::min(_minimums[c], value);
+					_maximums[c] = std::max(_maximums[c], value);
+				}
+
+				pEntry = pEntryEnd + 1;
+			}
+
+			row++;
+		}
+
+		p = pLineEnd + 1;
+	}
+
+	_numRows = row;
+
+	// Close the gaps left by blank lines
+	if (_numRows < maxRows) {
+		for (int c = 1; c < _numColumns; c++)
+			std::memmove(&_data[c * _numRows], &_data[c * maxRows], _numRows * sizeof(float));
+
+		_data.resize(_numColumns * _numRows);
+	}
+
+	return true;
+}
+
+bool TimeSeries::saveCache(const std::string &fileName) const {
+	std::ofstream toFile(fileName, std::ios::binary);
+
+	if (!toFile.is_open())
+		return false;
+
+	unsigned int version = _cacheVersion;
+	unsigned long long numRows = _numRows;
+
+	toFile.write("TSER", 4);
+	toFile.write(reinterpret_cast<const char*>(&version), sizeof(unsigned int));
+	toFile.write(reinterpret_cast<const char*>(&_numColumns), sizeof(int));
+	toFile.write(reinterpret_cast<const char*>(&numRows), sizeof(unsigned long long));
+
+	toFile.write(reinterpret_cast<const char*>(_minimums.data()), _numColumns * sizeof(float));
+	toFile.write(reinterpret_cast<const char*>(_maximums.data()), _numColumns * sizeof(float));
+
+	toFile.write(reinterpret_cast<const char*>(_data.data()), _data.size() * sizeof(float));
+
+	return toFile.good();
+}
+
+bool TimeSeries::loadCache(const std::string &fileName) {
+	std::ifstream fromFile(fileName, std::ios::binary);
+
+	if (!fromFile.is_open())
+		return false;
+
+	char magic[4];
+	unsigned int version;
+	int numColumns;
+	unsigned long long numRows;
+
+	fromFile.read(magic, 4);
+	fromFile.read(reinterpret_cast<char*>(&version), sizeof(unsigned int));
+	fromFile.read(reinterpret_cast<char*>(&numColumns), sizeof(int));
+	fromFile.read(reinterpret_cast<char*>(&numRows), sizeof(unsigned long long));
+
+	if (!fromFile || std::memcmp(magic, "TSER", 4) != 0 || version != _cacheVersion || numColumns < 0)
+		return false;
+
+	// Reject sizes that do not match the file before allocating anything
+	std::streamoff headerSize = fromFile.tellg();
+
+	fromFile.seekg(0, std::ios::end);
+
+	std::streamoff fileSize = fromFile.tellg();
+
+	fromFile.seekg(headerSize);
+
+	if (fileSize - headerSize != static_cast<std::streamoff>((2 + numRows) * numColumns * sizeof(float)))
+		return false;
+
+	_numColumns = numColumns;
+	_numRows = numRows;
+
+	_minimums.resize(_numColumns);
+	_maximums.resize(_numColumns);
+	_data.resize(_numColumns * _numRows);
+
+	fromFile.read(reinterpret_cast<char*>(_minimums.data()), _numColumns * sizeof(float));
+	fromFile.read(reinterpret_cast<char*>(_maximums.data()), _numColumns * sizeof(float));
+	fromFile.read(reinterpret_cast<char*>(_data.data()), _data.size() * sizeof(float));
+
+	return fromFile.good();
+}
+
+bool TimeSeries::load(const std::string &csvFileName, const std::string &cacheFileName, int numSkipColumns) {
+	if (loadCache(cacheFileName))
+		return true;
+
+	if (!loadCSV(csvFileName, numSkipColumns))
+		return false;
+
+	saveCache(cacheFileName);
+
+	return true;
+}
+
+void TimeSeries::normalize() {
+	for (int c = 0; c < _numColumns; c++) {
+		float* pColumn = &_data[c * _numRows];
+
+		// Columns without a single value are all zero already
+		if (_minimums[c] > _maximums[c])
+			continue;
+
+		float minimum = _minimums[c];
+		float rangeInv = 1.0f / std::max(0.0001f, _maximums[c] - _minimums[c]);
+
+		for (size_t r = 0; r < _numRows; r++)
+			pColumn[r] = (pColumn[r] - minimum) * rangeInv;
+	}
+}
+
+void TimeSeries::getWindow(size_t start, int length, std::vector<float> &window) const {
+	window.resize(length * _numColumns);
+
+	for (int c = 0; c < _numColumns; c++) {
+		const float* pColumn = &_data[c * _numRows + start];
+
+		for (int r = 0; r < length; r++)
+			window[r * _numColumns + c] = pColumn[r];
+	}
+}
+
+void TimeSeries::forEachWindow(int length, int stride, const std::function<void(size_t start, const std::vector<float> &window)> &func) const {
+	std::vector<float> window;
+
+	for (size_t start = 0; start + length <= _numRows; start += stride) {
+		getWindow(start, length, window);
+
+		func(start, window);
+	}
+}
\ No newline at end of file
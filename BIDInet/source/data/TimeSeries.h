@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+
+namespace data {
+	// Multi-column time series stored column-major as floats, with the minimum and maximum of every column.
+	// CSV files are memory mapped and parsed in a single pass, a binary cache skips parsing on the next run
+	class TimeSeries {
+	private:
+		int _numColumns;
+		size_t _numRows;
+
+		// Column c occupies [c * _numRows, (c + 1) * _numRows)
+		std::vector<float> _data;
+
+		std::vector<float> _minimums;
+		std::vector<float> _maximums;
+
+	public:
+		static const unsigned int _cacheVersion = 1;
+
+		TimeSeries()
+			: _numColumns(0), _numRows(0)
+		{}
+
+		// Skips the header line and the first numSkipColumns entries of every row. Empty entries become 0 and do not
+		// count towards the minimum and maximum. Returns false if the file could not be opened
+		bool loadCSV(const std::string &fileName, int numSkipColumns = 1, bool skipHeader = true);
+
+		bool saveCache(const std::string &fileName) const;
+		bool loadCache(const std::string &fileName);
+
+		// Loads the cache if there is a valid one, otherwise parses the CSV and writes the cache for next time.
+		// The cache is not checked against the CSV, delete it when the data changes
+		bool load(const std::string &csvFileName, const std::string &cacheFileName, int numSkipColumns = 1);
+
+		// Rescales every column to [0, 1] with its minimum and maximum
+		void normalize();
+
+		// Copies rows [start, start + length) into window as length frames of getNumColumns() values
+		void getWindow(size_t start, int length, std::vector<float> &window) const;
+
+		// Calls func(start, window) for every window of length rows, stride rows apart
+		void forEachWindow(int length, int stride, const std::function<void(size_t start, const std::vector<float> &window)> &func) const;
+
+		int getNumColumns() const {
+			return _numColumns;
+		}
+
+		size_t getNumRows() const {
+			return _numRows;
+		}
+
+		const float* getColumn(int column) const {
+			return &_data[column * _numRows];
+		}
+
+		float get(size_t row, int column) const {
+			return _data[column * _numRows + row];
+		}
+
+		float getMinimum(int column) const {
+			return _minimums[column];
+		}
+
+		float getMaximum(int column) const {
+			return _maximums[column];
+		}
+	};
+}
\ No newline at end of file
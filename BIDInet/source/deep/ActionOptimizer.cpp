@@ -0,0 +1,198 @@
+#include "ActionOptimizer.h"
+
+#include <algorithm>
+
+using namespace deep;
+
+void ActionOptimizer::clearCells(int numActions) {
+	_numActions = numActions;
+	_numCells = 0;
+}
+
+float* ActionOptimizer::addCell(float qWeight, float state) {
+	if (_rows.size() < (_numCells + 1) * _numActions) {
+		_rows.resize((_numCells + 1) * _numActions);
+		_qWeights.resize(_numCells + 1);
+		_states.resize(_numCells + 1);
+	}
+
+	_qWeights[_numCells] = qWeight;
+	_states[_numCells] = state;
+
+	return &_rows[_numCells++ * _numActions];
+}
+
+void ActionOptimizer::derive(float* actions, int iterations, float alpha, int numStarts, float minGradient) {
+	const int numHalfActions = _numActions / 2;
+
+	numStarts = std::max(1, numStarts);
+
+	_starts.resize(numStarts * _numActions);
+	_errors.resize(numStarts * _numActions);
+	_prevs.resize(numStarts * numHalfActions);
+	_prevs2.resize(numStarts * numHalfActions);
+	_done.assign(numStarts, 0);
+
+	// The given actions and points spread by the golden ratio
+	for (int s = 0; s < numStarts; s++) {
+		float* pStart = &_starts[s * _numActions];
+
+		for (int i = 0; i < numHalfActions; i++) {
+			if (s == 0)
+				pStart[i] = actions[i];
+			else {
+				float offset = s * 0.6180340f + i * 0.3819660f;
+
+				pStart[i] = offset - std::floor(offset);
+			}
+
+			pStart[i + numHalfActions] = 1.0f - pStart[i];
+		}
+	}
+
+	const float minGradientSquared = minGradient * minGradient;
+
+	int numRunning = numStarts;
+
+	_iterationsUsed = 0;
+
+	for (int iter = 0; iter < iterations && numRunning > 0; iter++) {
+		_iterationsUsed++;
+
+		for (int s = 0; s < numStarts; s++)
+			if (!_done[s])
+				std::fill(_errors.begin() + s * _numActions, _errors.begin() + (s + 1) * _numActions, 0.0f);
+
+		// Forwards and action improvement, row by row for all starts
+		for (int k = 0; k < _numCells; k++) {
+			const float* pRow = &_rows[k * _numActions];
+
+			for (int s = 0; s < numStarts; s++) {
+				if (_done[s])
+					continue;
+
+				const float* pStart = &_starts[s * _numActions];
+
+				float sum = 0.0f;
+
+				for (int vi = 0; vi < _numActions; vi++)
+					sum += pRow[vi] * pStart[vi];
+
+				float actionState = sigmoid(sum) * _states[k];
+
+				if (actionState != 0.0f) {
+					float error = _qWeights[k] * actionState * (1.0f - actionState);
+
+					float* pErrors = &_errors[s * _numActions];
+
+					for (int i = 0; i < _numActions; i++)
+						pErrors[i] += pRow[i] * error;
+				}
+			}
+		}
+
+		for (int s = 0; s < numStarts; s++) {
+			if (_done[s])
+				continue;
+
+			float* pStart = &_starts[s * _numActions];
+			const float* pErrors = &_errors[s * _numActions];
+			float* pPrev = &_prevs[s * numHalfActions];
+			float* pPrev2 = &_prevs2[s * numHalfActions];
+
+			if (minGradient > 0.0f) {
+				float norm = 0.0f;
+
+				for (int i = 0; i < numHalfActions; i++) {
+					float gradient = pErrors[i] - pErrors[i + numHalfActions];
+
+					norm += gradient * gradient;
+				}
+
+				if (norm < minGradientSquared) {
+					_done[s] = 1;
+					numRunning--;
+
+					continue;
+				}
+			}
+
+			bool fixed = true;
+			bool cycle = iter > 0;
+
+			for (int i = 0; i < numHalfActions; i++) {
+				pPrev2[i] = pPrev[i];
+				pPrev[i] = pStart[i];
+
+				// Find action delta
+				pStart[i] = std::min(1.0f, std::max(0.0f, pStart[i] + alpha * ((pErrors[i] - pErrors[i + numHalfActions]) > 0.0f ? 1.0f : -1.0f)));
+
+				pStart[i + numHalfActions] = 1.0f - pStart[i];
+
+				fixed = fixed && pStart[i] == pPrev[i];
+				cycle = cycle && pStart[i] == pPrev2[i];
+			}
+
+			if (fixed || cycle) {
+				// In a cycle an odd number of remaining iterations ends on the other point
+				if (!fixed && (iterations - 1 - iter) % 2 == 1)
+					for (int i = 0; i < numHalfActions; i++) {
+						pStart[i] = pPrev[i];
+						pStart[i + numHalfActions] = 1.0f - pStart[i];
+					}
+
+				_done[s] = 1;
+				numRunning--;
+			}
+		}
+	}
+
+	int best = 0;
+
+	if (numStarts > 1) {
+		float bestQ = getQ(&_starts[0]);
+
+		for (int s = 1; s < numStarts; s++) {
+			float q = getQ(&_starts[s * _numActions]);
+
+			if (q > bestQ) {
+				bestQ = q;
+				best = s;
+			}
+		}
+	}
+
+	for (int i = 0; i < _numActions; i++)
+		actions[i] = _starts[best * _numActions + i];
+}
+
+float ActionOptimizer::getQ(const float* actions) const {
+	float q = 0.0f;
+
+	for (int k = 0; k < _numCells; k++) {
+		const float* pRow = &_rows[k * _numActions];
+
+		float sum = 0.0f;
+
+		for (int vi = 0; vi < _numActions; vi++)
+			sum += pRow[vi] * actions[vi];
+
+		q += _qWeights[k] * sigmoid(sum) * _states[k];
+	}
+
+	return q;
+}
+
+void ActionOptimizer::explore(const float* actions, float* exploratoryActions, int count, float minAction, float maxAction,
+	float explorationStdDev, float explorationBreak, std::mt19937 &generator)
+{
+	std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
+	std::normal_distribution<float> pertDist(0.0f, explorationStdDev);
+
+	for (int i = 0; i < count; i++) {
+		if (dist01(generator) < explorationBreak)
+			exploratoryActions[i] = dist01(generator);
+		else
+			exploratoryActions[i] = std::min(maxAction, std::max(minAction, actions[i] + pertDist(generator)));
+	}
+}
\ No newline at end of file
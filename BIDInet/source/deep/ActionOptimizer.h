@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace deep {
+	// Sign gradient ascent on the actions of the gated Q function of an SDRRL column, Q(a) = sum_k q_k * sigmoid(w_k . a) * s_k.
+	// Actions come in two halves, the second one is always the complement of the first.
+	// Only cells with s_k > 0 contribute, so those are gathered into contiguous rows once per derivation and every iteration
+	// is a single pass over them per start. With Q fixed, sign steps end up in a fixed point or a cycle of two. Both are
+	// detected, and the derivation then stops with the actions the remaining iterations would have ended on
+	class ActionOptimizer {
+	private:
+		int _numActions;
+		int _numCells;
+
+		// [cell][action]
+		std::vector<float> _rows;
+
+		// [cell]
+		std::vector<float> _qWeights;
+		std::vector<float> _states;
+
+		// [start][action]
+		std::vector<float> _starts;
+		std::vector<float> _errors;
+
+		// [start][half action], actions before the last and the second to last step
+		std::vector<float> _prevs;
+		std::vector<float> _prevs2;
+
+		std::vector<char> _done;
+
+		int _iterationsUsed;
+
+	public:
+		static float sigmoid(float x) {
+			return 1.0f / (1.0f + std::exp(-x));
+		}
+
+		ActionOptimizer()
+			: _numActions(0), _numCells(0), _iterationsUsed(0)
+		{}
+
+		// Starts gathering the cells of a column with numActions actions, both halves included
+		void clearCells(int numActions);
+
+		// Adds a cell with state > 0. Returns its row, to be filled with the cell's numActions action weights
+		float* addCell(float qWeight, float state);
+
+		// Derives from the given actions and writes the result back into them. Further starts are spread over the action space
+		// and run alongside, the one ending at the highest Q wins. minGradient > 0 also stops a start once the norm of its
+		// gradient falls below it, unlike the cycle detection this changes the result
+		void derive(float* actions, int iterations, float alpha, int numStarts = 1, float minGradient = 0.0f);
+
+		// Q of the gathered cells for the given actions
+		float getQ(const float* actions) const;
+
+		// Iterations the last derive actually ran, at most the number asked for
+		int getIterationsUsed() const {
+			return _iterationsUsed;
+		}
+
+		// Explores count actions: with chance explorationBreak a uniform draw in [0, 1], otherwise the action plus normal noise
+		// clamped to [minAction, maxAction]
+		static void explore(const float* actions, float* exploratoryActions, int count, float minAction, float maxAction,
+			float explorationStdDev, float explorationBreak, std::mt19937 &generator);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "BinaryStream.h"
+
+using namespace deep;
+
+unsigned int deep::checksum(const char* data, size_t size) {
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+void BinaryWriter::write(const std::vector<float> &values) {
+	write(static_cast<int>(values.size()));
+
+	if (!values.empty()) {
+		const char* pData = reinterpret_cast<const char*>(values.data());
+
+		_payload.insert(_payload.end(), pData, pData + values.size() * sizeof(float));
+	}
+}
+
+void BinaryWriter::write(const std::string &value) {
+	write(static_cast<int>(value.size()));
+
+	_payload.insert(_payload.end(), value.begin(), value.end());
+}
+
+void BinaryWriter::save(std::ostream &os, const char* magic, unsigned int version) const {
+	unsigned int payloadSize = _payload.size();
+	unsigned int payloadChecksum = checksum(_payload.data(), _payload.size());
+
+	os.write(magic, 4);
+	os.write(reinterpret_cast<const char*>(&version), sizeof(unsigned int));
+	os.write(reinterpret_cast<const char*>(&payloadSize), sizeof(unsigned int));
+	os.write(reinterpret_cast<const char*>(&payloadChecksum), sizeof(unsigned int));
+
+	os.write(_payload.data(), _payload.size());
+}
+
+bool BinaryReader::load(std::istream &is, const char* magic) {
+	_good = false;
+	_position = 0;
+	_payload.clear();
+
+	char fileMagic[4];
+
+	unsigned int payloadSize, payloadChecksum;
+
+	is.read(fileMagic, 4);
+	is.read(reinterpret_cast<char*>(&_version), sizeof(unsigned int));
+	is.read(reinterpret_cast<char*>(&payloadSize), sizeof(unsigned int));
+	is.read(reinterpret_cast<char*>(&payloadChecksum), sizeof(unsigned int));
+
+	if (!is || std::memcmp(fileMagic, magic, 4) != 0)
+		return false;
+
+	_payload.resize(payloadSize);
+
+	is.read(_payload.data(), payloadSize);
+
+	if (!is || checksum(_payload.data(), _payload.size()) != payloadChecksum)
+		return false;
+
+	_good = true;
+
+	return true;
+}
+
+void BinaryReader::read(std::vector<float> &values) {
+	int size;
+
+	read(size);
+
+	if (size < 0 || _position + size * sizeof(float) > _payload.size()) {
+		_good = false;
+
+		values.clear();
+
+		return;
+	}
+
+	values.resize(size);
+
+	if (size > 0)
+		std::memcpy(values.data(), &_payload[_position], size * sizeof(float));
+
+	_position += size * sizeof(float);
+}
+
+void BinaryReader::read(std::string &value) {
+	int size;
+
+	read(size);
+
+	if (size < 0 || _position + size > _payload.size()) {
+		_good = false;
+
+		value.clear();
+
+		return;
+	}
+
+	value.assign(&_payload[_position], size);
+
+	_position += size;
+}
\ No newline at end of file
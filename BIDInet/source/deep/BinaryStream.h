@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <iostream>
+#include <string>
+#include <cstring>
+
+namespace deep {
+	// Snapshots are written as a header (magic, version, payload size, checksum) followed by the payload in native byte order.
+	// The payload is built in memory and read back with a single bulk read.
+	unsigned int checksum(const char* data, size_t size);
+
+	class BinaryWriter {
+	private:
+		std::vector<char> _payload;
+
+	public:
+		template<class T>
+		void write(const T &value) {
+			const char* pData = reinterpret_cast<const char*>(&value);
+
+			_payload.insert(_payload.end(), pData, pData + sizeof(T));
+		}
+
+		void write(const std::vector<float> &values);
+		void write(const std::string &value);
+
+		void save(std::ostream &os, const char* magic, unsigned int version) const;
+	};
+
+	class BinaryReader {
+	private:
+		std::vector<char> _payload;
+
+		size_t _position;
+
+		unsigned int _version;
+
+		bool _good;
+
+	public:
+		BinaryReader()
+			: _position(0), _version(0), _good(false)
+		{}
+
+		// Returns false on a wrong magic, a truncated stream or a checksum mismatch
+		bool load(std::istream &is, const char* magic);
+
+		// Reading past the end yields zeros and clears good()
+		template<class T>
+		void read(T &value) {
+			if (_position + sizeof(T) > _payload.size()) {
+				std::memset(&value, 0, sizeof(T));
+
+				_good = false;
+
+				return;
+			}
+
+			std::memcpy(&value, &_payload[_position], sizeof(T));
+
+			_position += sizeof(T);
+		}
+
+		void read(std::vector<float> &values);
+		void read(std::string &value);
+
+		unsigned int getVersion() const {
+			return _version;
+		}
+
+		bool good() const {
+			return _good;
+		}
+	};
+}
\ No newline at end of file
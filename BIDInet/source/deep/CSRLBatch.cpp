@@ -0,0 +1,426 @@
+#include "CSRLBatch.h"
+
+#include <algorithm>
+
+using namespace deep;
+
+void CSRLBatch::create(const CSRL &model, int numAgents) {
+	// Flat weights and settings as exported for a policy
+	CSRLPolicy policy;
+
+	model.exportPolicy(policy);
+
+	_layerDescs = policy._layerDescs;
+	_inputTypes = policy._inputTypes;
+	_lastLayerRewardOffsets = policy._lastLayerRewardOffsets;
+
+	_weights = *policy._weights;
+
+	_inputDesc._numRecurrentInputs = model._numRecurrentInputs;
+	_inputDesc._learnFeedBackRL = model._learnFeedBackRL;
+	_inputDesc._averageSurpriseDecay = model._averageSurpriseDecay;
+	_inputDesc._surpriseLearnFactor = model._surpriseLearnFactor;
+	_inputDesc._cellSparsity = model._cellSparsity;
+	_inputDesc._gamma = model._gamma;
+	_inputDesc._gammaLambda = model._gammaLambda;
+	_inputDesc._gateFeedForwardAlpha = model._gateFeedForwardAlpha;
+	_inputDesc._gateLateralAlpha = model._gateLateralAlpha;
+	_inputDesc._gateThresholdAlpha = model._gateThresholdAlpha;
+	_inputDesc._qAlpha = model._qAlpha;
+	_inputDesc._actionAlpha = model._actionAlpha;
+	_inputDesc._actionDeriveAlpha = model._actionDeriveAlpha;
+	_inputDesc._actionDeriveIterations = model._actionDeriveIterations;
+	_inputDesc._explorationStdDev = model._explorationStdDev;
+	_inputDesc._explorationBreak = model._explorationBreak;
+	_inputDesc._sdrIterSettle = model._sdrIterSettle;
+	_inputDesc._sdrIterMeasure = model._sdrIterMeasure;
+	_inputDesc._sdrLeak = model._sdrLeak;
+
+	_sparseColumnInputs = model._sparseColumnInputs;
+	_sparseColumnTraces = model._sparseColumnTraces;
+	_columnTraceEpsilon = model._columnTraceEpsilon;
+
+	_sdrrls.resize(_layerDescs.size());
+
+	for (int l = 0; l < _layerDescs.size(); l++)
+		_sdrrls[l].createShared(model.getLayers()[l]._sdrrls, numAgents);
+
+	_inputSDRRLs.createShared(model.getInputSDRRLs(), numAgents);
+
+	_agents.assign(numAgents, AgentState());
+
+	for (int a = 0; a < numAgents; a++) {
+		AgentState &agent = _agents[a];
+
+		agent._layers.resize(_layerDescs.size());
+
+		for (int l = 0; l < _layerDescs.size(); l++) {
+			const CSRLPolicy::LayerWeights &layerWeights = _weights._layers[l];
+
+			AgentLayer &layer = agent._layers[l];
+
+			int numVisible = policy._layers[l]._sdr._visibleInputs.size();
+			int numHidden = layerWeights._thresholds.size();
+
+			layer._sdr._visibleInputs.assign(numVisible, 0.0f);
+			layer._sdr._visibleRecons.assign(numVisible, 0.0f);
+			layer._sdr._visibleErrors.assign(numVisible, 0.0f);
+
+			layer._sdr._activations.assign(numHidden, 0.0f);
+			layer._sdr._spikes.assign(numHidden, 0.0f);
+			layer._sdr._spikesPrev.assign(numHidden, 0.0f);
+			layer._sdr._states.assign(numHidden, 0.0f);
+			layer._sdr._statesPrev.assign(numHidden, 0.0f);
+			layer._sdr._hiddenRecons.assign(numHidden, 0.0f);
+			layer._sdr._hiddenErrors.assign(numHidden, 0.0f);
+
+			layer._feedForwardTraces.assign(layerWeights._feedForward._weights.size(), 0.0f);
+			layer._recurrentTraces.assign(layerWeights._recurrent._weights.size(), 0.0f);
+
+			// One prediction node per hidden unit
+			layer._states.assign(numHidden, 0.0f);
+			layer._statesPrev.assign(numHidden, 0.0f);
+			layer._stateOutputs.assign(numHidden, 0.0f);
+			layer._stateOutputsPrev.assign(numHidden, 0.0f);
+			layer._localRewards.assign(numHidden, 0.0f);
+
+			layer._feedBackTraces.assign(layerWeights._feedBackConnections._weights.size(), 0.0f);
+			layer._predictiveTraces.assign(layerWeights._predictiveConnections._weights.size(), 0.0f);
+		}
+
+		agent._inputStates.assign(_inputTypes.size(), 0.0f);
+		agent._inputStatesPrev.assign(_inputTypes.size(), 0.0f);
+		agent._inputStateOutputs.assign(_inputTypes.size(), 0.0f);
+		agent._inputStateOutputsPrev.assign(_inputTypes.size(), 0.0f);
+		agent._inputLocalRewards.assign(_inputTypes.size(), 0.0f);
+
+		agent._inputFeedBackTraces.assign(_weights._inputFeedBackConnections._weights.size(), 0.0f);
+	}
+}
+
+void CSRLBatch::stepColumns(int l, const std::vector<float> &rewards, std::mt19937 &generator) {
+	const int numLayers = _layerDescs.size();
+
+	SDRRLBatch &sdrrls = l < 0 ? _inputSDRRLs : _sdrrls[l];
+
+	const CSRL::LayerDesc &desc = l < 0 ? _inputDesc : _layerDescs[l];
+
+	const CSRLPolicy::Connections &feedBack = l < 0 ? _weights._inputFeedBackConnections : _weights._layers[l]._feedBackConnections;
+
+	const int numNodes = sdrrls.getNumColumns() / _agents.size();
+
+	_columnRewards.resize(sdrrls.getNumColumns());
+
+	sys::parallelFor(_threadPool.get(), _agents.size(), [&](int a) {
+		AgentState &agent = _agents[a];
+
+		for (int pi = 0; pi < numNodes; pi++) {
+			SDRRLBatch::ColumnView sdrrl = sdrrls.getColumn(a * numNodes + pi);
+
+			int inputIndex = 0;
+
+			// Local rewards of the layer above, the reward at the last layer
+			for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++) {
+				int index = feedBack._indices[ci];
+
+				if (l < 0)
+					sdrrl.setState(inputIndex++, agent._layers.front()._localRewards[index]);
+				else if (l < numLayers - 1)
+					sdrrl.setState(inputIndex++, agent._layers[l + 1]._localRewards[index]);
+				else
+					sdrrl.setState(inputIndex++, _lastLayerRewardOffsets[index] + rewards[a]);
+			}
+
+			if (l >= 0) {
+				const CSRLPolicy::Connections &predictive = _weights._layers[l]._predictiveConnections;
+
+				for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+					sdrrl.setState(inputIndex++, agent._layers[l]._sdr._states[predictive._indices[ci]]);
+			}
+
+			for (int i = 0; i < desc._numRecurrentInputs; i++)
+				sdrrl.setState(inputIndex++, sdrrl.getAction(CSRL::_numActionTypes + i));
+
+			_columnRewards[a * numNodes + pi] = rewards[a];
+		}
+	});
+
+	sdrrls.simStep(_columnRewards, desc._cellSparsity, desc._gamma, desc._sdrIterSettle, desc._sdrIterMeasure,
+		desc._sdrLeak, desc._gateFeedForwardAlpha, desc._gateLateralAlpha, desc._gateThresholdAlpha,
+		desc._qAlpha, desc._actionAlpha, desc._actionDeriveIterations, desc._actionDeriveAlpha, desc._gammaLambda,
+		desc._explorationStdDev, desc._explorationBreak,
+		desc._averageSurpriseDecay, desc._surpriseLearnFactor, generator, _threadPool.get());
+
+	for (int a = 0; a < _agents.size(); a++) {
+		std::vector<float> &localRewards = l < 0 ? _agents[a]._inputLocalRewards : _agents[a]._layers[l]._localRewards;
+
+		for (int pi = 0; pi < numNodes; pi++)
+			localRewards[pi] = sdrrls.getAction(a * numNodes + pi, CSRL::_reward);
+	}
+}
+
+void CSRLBatch::learnPrediction(int l, int pi) {
+	const int numLayers = _layerDescs.size();
+	const int numNodes = _weights._layers[l]._thresholds.size();
+	const float scale = 1.0f / _agents.size();
+
+	const CSRL::LayerDesc &desc = _layerDescs[l];
+
+	CSRLPolicy::Connections &feedBack = _weights._layers[l]._feedBackConnections;
+	CSRLPolicy::Connections &predictive = _weights._layers[l]._predictiveConnections;
+
+	for (int a = 0; a < _agents.size(); a++) {
+		AgentLayer &layer = _agents[a]._layers[l];
+
+		float predictionError = layer._sdr._states[pi] - layer._statesPrev[pi];
+
+		float gate = _sdrrls[l].getAction(a * numNodes + pi, CSRL::_learn);
+
+		if (l < numLayers - 1) {
+			const AgentLayer &nextLayer = _agents[a]._layers[l + 1];
+
+			for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++) {
+				layer._feedBackTraces[ci] = desc._gammaLambda * layer._feedBackTraces[ci] + predictionError * nextLayer._stateOutputsPrev[feedBack._indices[ci]];
+
+				feedBack._weights[ci] += scale * (desc._learnFeedBackRL * gate * layer._feedBackTraces[ci]);
+			}
+		}
+
+		// Predictive
+		for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++) {
+			layer._predictiveTraces[ci] = desc._gammaLambda * layer._predictiveTraces[ci] + predictionError * layer._sdr._statesPrev[predictive._indices[ci]];
+
+			predictive._weights[ci] += scale * (desc._learnPredictionRL * gate * layer._predictiveTraces[ci]);
+		}
+	}
+}
+
+void CSRLBatch::learnInputPrediction(int pi) {
+	const int numNodes = _inputTypes.size();
+	const float scale = 1.0f / _agents.size();
+
+	CSRLPolicy::Connections &feedBack = _weights._inputFeedBackConnections;
+
+	for (int a = 0; a < _agents.size(); a++) {
+		AgentState &agent = _agents[a];
+
+		float predictionError = agent._layers.front()._sdr._visibleInputs[pi] - agent._inputStatesPrev[pi];
+
+		float gate = _inputTypes[pi] == CSRL::_action ? _inputSDRRLs.getAction(a * numNodes + pi, CSRL::_learn) : 1.0f;
+
+		for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++) {
+			agent._inputFeedBackTraces[ci] = _inputDesc._gammaLambda * agent._inputFeedBackTraces[ci] + predictionError * agent._layers.front()._stateOutputsPrev[feedBack._indices[ci]];
+
+			feedBack._weights[ci] += scale * (_inputDesc._learnFeedBackRL * gate * agent._inputFeedBackTraces[ci]);
+		}
+	}
+}
+
+void CSRLBatch::learnEncoder(int l, int hi) {
+	// Default of IRSDR::learn, which CSRL uses
+	const float maxWeightDelta = 0.5f;
+	const float scale = 1.0f / _agents.size();
+
+	const CSRL::LayerDesc &desc = _layerDescs[l];
+
+	CSRLPolicy::LayerWeights &layerWeights = _weights._layers[l];
+
+	CSRLPolicy::Connections &feedForward = layerWeights._feedForward;
+	CSRLPolicy::Connections &recurrent = layerWeights._recurrent;
+	CSRLPolicy::Connections &lateral = layerWeights._lateral;
+
+	for (int ci = feedForward._offsets[hi]; ci < feedForward._offsets[hi + 1]; ci++) {
+		float delta = 0.0f;
+
+		for (int a = 0; a < _agents.size(); a++)
+			delta += desc._learnFeedForward * _agents[a]._layers[l]._localRewards[hi] * _agents[a]._layers[l]._feedForwardTraces[ci];
+
+		delta = scale * delta - desc._sdrWeightDecay * feedForward._weights[ci];
+
+		feedForward._weights[ci] += std::min(maxWeightDelta, std::max(-maxWeightDelta, delta));
+
+		for (int a = 0; a < _agents.size(); a++) {
+			AgentLayer &layer = _agents[a]._layers[l];
+
+			layer._feedForwardTraces[ci] = desc._sdrLambda * layer._feedForwardTraces[ci] + layer._sdr._states[hi] * layer._sdr._visibleErrors[feedForward._indices[ci]];
+		}
+	}
+
+	for (int ci = recurrent._offsets[hi]; ci < recurrent._offsets[hi + 1]; ci++) {
+		float delta = 0.0f;
+
+		for (int a = 0; a < _agents.size(); a++)
+			delta += desc._learnRecurrent * _agents[a]._layers[l]._localRewards[hi] * _agents[a]._layers[l]._recurrentTraces[ci];
+
+		delta = scale * delta - desc._sdrWeightDecay * recurrent._weights[ci];
+
+		recurrent._weights[ci] += std::min(maxWeightDelta, std::max(-maxWeightDelta, delta));
+
+		for (int a = 0; a < _agents.size(); a++) {
+			AgentLayer &layer = _agents[a]._layers[l];
+
+			layer._recurrentTraces[ci] = desc._sdrLambda * layer._recurrentTraces[ci] + layer._sdr._states[hi] * layer._sdr._hiddenErrors[recurrent._indices[ci]];
+		}
+	}
+
+	for (int ci = lateral._offsets[hi]; ci < lateral._offsets[hi + 1]; ci++) {
+		float delta = 0.0f;
+
+		for (int a = 0; a < _agents.size(); a++)
+			delta += desc._learnLateral * (_agents[a]._layers[l]._sdr._states[hi] * _agents[a]._layers[l]._sdr._states[lateral._indices[ci]] - desc._sparsity * desc._sparsity);
+
+		lateral._weights[ci] = std::max(0.0f, lateral._weights[ci] + scale * delta);
+	}
+
+	float thresholdDelta = 0.0f;
+
+	for (int a = 0; a < _agents.size(); a++)
+		thresholdDelta += (_agents[a]._layers[l]._sdr._states[hi] - desc._sparsity) * desc._sdrLearnThreshold;
+
+	layerWeights._thresholds[hi] = std::max(0.0f, layerWeights._thresholds[hi] + scale * thresholdDelta);
+}
+
+void CSRLBatch::simStep(const std::vector<float> &rewards, std::mt19937 &generator, bool learn) {
+	assert(rewards.size() == _agents.size());
+
+	const int numLayers = _layerDescs.size();
+
+	for (int l = 0; l < numLayers; l++) {
+		_sdrrls[l]._sparseInputs = _sparseColumnInputs;
+		_sdrrls[l]._sparseTraces = _sparseColumnTraces;
+		_sdrrls[l]._traceEpsilon = _columnTraceEpsilon;
+	}
+
+	_inputSDRRLs._sparseInputs = _sparseColumnInputs;
+	_inputSDRRLs._sparseTraces = _sparseColumnTraces;
+	_inputSDRRLs._traceEpsilon = _columnTraceEpsilon;
+
+	// Feature extraction and prediction, agents are independent until their columns step
+	sys::parallelFor(_threadPool.get(), _agents.size(), [&](int a) {
+		AgentState &agent = _agents[a];
+
+		for (int l = 0; l < numLayers; l++) {
+			CSRLPolicy::Encoder &encoder = agent._layers[l]._sdr;
+
+			encoder.activate(_weights._layers[l], _layerDescs[l]._sdrIterSettle, _layerDescs[l]._sdrIterMeasure, _layerDescs[l]._sdrLeak);
+
+			// Attention gated inputs for next layer if there is one
+			if (l < numLayers - 1) {
+				const int numNodes = encoder._states.size();
+
+				for (int i = 0; i < numNodes; i++)
+					agent._layers[l + 1]._sdr._visibleInputs[i] = encoder._states[i] * _sdrrls[l].getAction(a * numNodes + i, CSRL::_attention);
+			}
+		}
+
+		for (int l = numLayers - 1; l >= 0; l--) {
+			AgentLayer &layer = agent._layers[l];
+
+			const CSRLPolicy::Connections &feedBack = _weights._layers[l]._feedBackConnections;
+			const CSRLPolicy::Connections &predictive = _weights._layers[l]._predictiveConnections;
+
+			for (int pi = 0; pi < layer._states.size(); pi++) {
+				float activation = 0.0f;
+
+				// Feed Back
+				if (l < numLayers - 1) {
+					for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++)
+						activation += feedBack._weights[ci] * agent._layers[l + 1]._stateOutputs[feedBack._indices[ci]];
+				}
+
+				// Predictive
+				for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+					activation += predictive._weights[ci] * layer._sdr._states[predictive._indices[ci]];
+
+				layer._states[pi] = activation;
+
+				layer._stateOutputs[pi] = std::min(1.0f, std::max(0.0f, activation));
+			}
+		}
+
+		const CSRLPolicy::Connections &inputFeedBack = _weights._inputFeedBackConnections;
+
+		// Get first layer prediction
+		for (int pi = 0; pi < _inputTypes.size(); pi++) {
+			float activation = 0.0f;
+
+			for (int ci = inputFeedBack._offsets[pi]; ci < inputFeedBack._offsets[pi + 1]; ci++)
+				activation += inputFeedBack._weights[ci] * agent._layers.front()._stateOutputs[inputFeedBack._indices[ci]];
+
+			agent._inputStates[pi] = activation;
+			agent._inputStateOutputs[pi] = activation;
+		}
+	});
+
+	// Exploration of the action inputs, agent by agent so the generator is used as by separate CSRLs
+	std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
+	std::normal_distribution<float> pertDist(0.0f, _inputDesc._explorationStdDev);
+
+	for (int a = 0; a < _agents.size(); a++) {
+		AgentState &agent = _agents[a];
+
+		for (int pi = 0; pi < _inputTypes.size(); pi++) {
+			if (_inputTypes[pi] == CSRL::_action) {
+				if (dist01(generator) < _inputDesc._explorationBreak)
+					agent._inputStateOutputs[pi] = dist01(generator) * 2.0f - 1.0f;
+				else
+					agent._inputStateOutputs[pi] = std::min(1.0f, std::max(-1.0f, std::min(1.0f, std::max(-1.0f, agent._inputStateOutputs[pi])) + pertDist(generator)));
+			}
+		}
+	}
+
+	// Columns, top down since the local rewards of a layer are inputs to the one below
+	for (int l = numLayers - 1; l >= 0; l--)
+		stepColumns(l, rewards, generator);
+
+	stepColumns(-1, rewards, generator);
+
+	if (learn) {
+		for (int l = 0; l < numLayers; l++)
+			sys::parallelFor(_threadPool.get(), _weights._layers[l]._thresholds.size(), [&](int pi) {
+				learnPrediction(l, pi);
+			});
+
+		sys::parallelFor(_threadPool.get(), _inputTypes.size(), [&](int pi) {
+			learnInputPrediction(pi);
+		});
+
+		// Reconstruction errors of every agent's encoders, as IRSDR::learn finds them
+		sys::parallelFor(_threadPool.get(), _agents.size(), [&](int a) {
+			for (int l = 0; l < numLayers; l++) {
+				CSRLPolicy::Encoder &encoder = _agents[a]._layers[l]._sdr;
+
+				for (int vi = 0; vi < encoder._visibleInputs.size(); vi++)
+					encoder._visibleErrors[vi] = encoder._visibleInputs[vi] - encoder._visibleRecons[vi];
+
+				for (int hi = 0; hi < encoder._states.size(); hi++)
+					encoder._hiddenErrors[hi] = encoder._statesPrev[hi] - encoder._hiddenRecons[hi];
+			}
+		});
+
+		for (int l = 0; l < numLayers; l++)
+			sys::parallelFor(_threadPool.get(), _weights._layers[l]._thresholds.size(), [&](int hi) {
+				learnEncoder(l, hi);
+			});
+	}
+
+	sys::parallelFor(_threadPool.get(), _agents.size(), [&](int a) {
+		AgentState &agent = _agents[a];
+
+		for (int l = 0; l < numLayers; l++) {
+			AgentLayer &layer = agent._layers[l];
+
+			layer._sdr._statesPrev = layer._sdr._states;
+
+			layer._statesPrev = layer._states;
+			layer._stateOutputsPrev = layer._stateOutputs;
+		}
+
+		agent._inputStatesPrev = agent._inputStates;
+		agent._inputStateOutputsPrev = agent._inputStateOutputs;
+
+		// Predictions become the inputs, those of type _state are set again before the next step
+		for (int pi = 0; pi < _inputTypes.size(); pi++)
+			agent._layers.front()._sdr._visibleInputs[pi] = agent._inputStateOutputs[pi];
+	});
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "CSRLPolicy.h"
+
+namespace deep {
+	// Many agents running one CSRL model, for instance one per simulated body. The agents share a single copy of the encoder,
+	// prediction and column weights and each keeps its own state and traces. The columns of one layer of all agents form one
+	// SDRRLBatch, agent a's column of node i being column a * nodes + i of weight set i, and the encoders of all agents
+	// settle over the same flat weights (those of CSRLPolicy). Learning averages the updates of all agents and applies them
+	// once per step. With a single agent a step is identical to CSRL::simStep.
+	// Encoder traces are always maintained in full here, LayerDesc::_sdrSparseTraces is not used
+	class CSRLBatch {
+	public:
+		// State of one agent in one layer
+		struct AgentLayer {
+			CSRLPolicy::Encoder _sdr;
+
+			// Parallel to the encoder feed forward and recurrent connections
+			std::vector<float> _feedForwardTraces;
+			std::vector<float> _recurrentTraces;
+
+			// Per prediction node
+			std::vector<float> _states;
+			std::vector<float> _statesPrev;
+			std::vector<float> _stateOutputs;
+			std::vector<float> _stateOutputsPrev;
+			std::vector<float> _localRewards;
+
+			// Parallel to the feed back and predictive connections
+			std::vector<float> _feedBackTraces;
+			std::vector<float> _predictiveTraces;
+		};
+
+		struct AgentState {
+			std::vector<AgentLayer> _layers;
+
+			// Per input prediction node
+			std::vector<float> _inputStates;
+			std::vector<float> _inputStatesPrev;
+			std::vector<float> _inputStateOutputs;
+			std::vector<float> _inputStateOutputsPrev;
+			std::vector<float> _inputLocalRewards;
+
+			// Parallel to the input feed back connections
+			std::vector<float> _inputFeedBackTraces;
+		};
+
+	private:
+		std::vector<CSRL::LayerDesc> _layerDescs;
+
+		// Settings of the input prediction nodes and their columns, taken from the top level members of the model
+		CSRL::LayerDesc _inputDesc;
+
+		std::vector<CSRL::InputType> _inputTypes;
+
+		std::vector<float> _lastLayerRewardOffsets;
+
+		CSRLPolicy::Weights _weights;
+
+		// One column per agent and prediction node
+		std::vector<SDRRLBatch> _sdrrls;
+		SDRRLBatch _inputSDRRLs;
+
+		std::vector<AgentState> _agents;
+
+		// Reward of every column of a layer
+		std::vector<float> _columnRewards;
+
+		bool _sparseColumnInputs;
+		bool _sparseColumnTraces;
+		float _columnTraceEpsilon;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+		// Steps the columns of layer l (the input columns for l < 0) of all agents, rewarding those of agent a with rewards[a]
+		void stepColumns(int l, const std::vector<float> &rewards, std::mt19937 &generator);
+
+		// Averaged updates of one prediction node of layer l, and of one input prediction node
+		void learnPrediction(int l, int pi);
+		void learnInputPrediction(int pi);
+
+		// Averaged IRSDR::learn of one hidden unit of layer l, rewarded by each agent's local rewards
+		void learnEncoder(int l, int hi);
+
+	public:
+		CSRLBatch()
+			: _sparseColumnInputs(false), _sparseColumnTraces(false), _columnTraceEpsilon(0.0001f)
+		{}
+
+		// Copies the weights and settings of model for numAgents agents, whose state and traces start out cleared
+		void create(const CSRL &model, int numAgents);
+
+		// One reward per agent
+		void simStep(const std::vector<float> &rewards, std::mt19937 &generator, bool learn = true);
+
+		// Runs the agents, and the units of each layer when learning, on the pool
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		void setInput(int agent, int index, float value) {
+			assert(_inputTypes[index] == CSRL::_state);
+
+			_agents[agent]._layers.front()._sdr._visibleInputs[index] = value;
+		}
+
+		// Inputs of type _state only, as CSRL::setInputs
+		void setInputs(int agent, const float* inputs) {
+			for (int i = 0; i < _inputTypes.size(); i++)
+				if (_inputTypes[i] == CSRL::_state)
+					_agents[agent]._layers.front()._sdr._visibleInputs[i] = inputs[i];
+		}
+
+		void setInputs(int agent, const std::vector<float> &inputs) {
+			setInputs(agent, inputs.data());
+		}
+
+		float getPrediction(int agent, int index) const {
+			return _agents[agent]._inputStateOutputs[index];
+		}
+
+		void getPredictions(int agent, std::vector<float> &predictions) const {
+			predictions = _agents[agent]._inputStateOutputs;
+		}
+
+		int getNumAgents() const {
+			return _agents.size();
+		}
+
+		int getNumInputs() const {
+			return _inputTypes.size();
+		}
+
+		const std::vector<SDRRLBatch> &getSDRRLs() const {
+			return _sdrrls;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "CSRLPolicy.h"
+
+#include <algorithm>
+
+using namespace deep;
+
+void CSRLPolicy::Encoder::activate(const LayerWeights &weights, int settleIter, int measureIter, float leak) {
+	const Connections &feedForward = weights._feedForward;
+	const Connections &recurrent = weights._recurrent;
+	const Connections &lateral = weights._lateral;
+
+	const int numVisible = _visibleInputs.size();
+	const int numHidden = _states.size();
+
+	for (int hi = 0; hi < numHidden; hi++) {
+		_activations[hi] = 0.0f;
+
+		_states[hi] = 0.0f;
+	}
+
+	float measureIterInv = 1.0f / measureIter;
+
+	for (int it = 0; it < settleIter + measureIter; it++) {
+		bool measure = it >= settleIter;
+
+		for (int vi = 0; vi < numVisible; vi++)
+			_visibleErrors[vi] = _visibleInputs[vi] - _visibleRecons[vi];
+
+		for (int hi = 0; hi < numHidden; hi++)
+			_hiddenErrors[hi] = _statesPrev[hi] - _hiddenRecons[hi];
+
+		for (int hi = 0; hi < numHidden; hi++) {
+			float excitation = 0.0f;
+
+			for (int ci = feedForward._offsets[hi]; ci < feedForward._offsets[hi + 1]; ci++)
+				excitation += _visibleErrors[feedForward._indices[ci]] * feedForward._weights[ci];
+
+			for (int ci = recurrent._offsets[hi]; ci < recurrent._offsets[hi + 1]; ci++)
+				excitation += _hiddenErrors[recurrent._indices[ci]] * recurrent._weights[ci];
+
+			float inhibition = 0.0f;
+
+			for (int ci = lateral._offsets[hi]; ci < lateral._offsets[hi + 1]; ci++)
+				inhibition += _spikesPrev[lateral._indices[ci]] * lateral._weights[ci];
+
+			_activations[hi] = (1.0f - leak) * _activations[hi] + excitation - inhibition;
+
+			if (_activations[hi] > weights._thresholds[hi]) {
+				_activations[hi] = 0.0f;
+				_spikes[hi] = 1.0f;
+			}
+			else
+				_spikes[hi] = 0.0f;
+
+			if (measure)
+				_states[hi] += measureIterInv * _spikes[hi];
+		}
+
+		for (int hi = 0; hi < numHidden; hi++)
+			_spikesPrev[hi] = _spikes[hi];
+
+		reconstruct(weights, _spikes);
+	}
+
+	reconstruct(weights, _states);
+}
+
+void CSRLPolicy::Encoder::reconstruct(const LayerWeights &weights, const std::vector<float> &values) {
+	const Connections &feedForward = weights._feedForward;
+	const Connections &recurrent = weights._recurrent;
+
+	std::fill(_visibleRecons.begin(), _visibleRecons.end(), 0.0f);
+	std::fill(_hiddenRecons.begin(), _hiddenRecons.end(), 0.0f);
+
+	for (int hi = 0; hi < _states.size(); hi++) {
+		for (int ci = feedForward._offsets[hi]; ci < feedForward._offsets[hi + 1]; ci++)
+			_visibleRecons[feedForward._indices[ci]] += feedForward._weights[ci] * values[hi];
+
+		for (int ci = recurrent._offsets[hi]; ci < recurrent._offsets[hi + 1]; ci++)
+			_hiddenRecons[recurrent._indices[ci]] += recurrent._weights[ci] * values[hi];
+	}
+}
+
+void CSRLPolicy::simStep(float reward) {
+	const int numLayers = _layers.size();
+
+	// Feature extraction
+	for (int l = 0; l < numLayers; l++) {
+		_layers[l]._sdr.activate(_weights->_layers[l], _layerDescs[l]._sdrIterSettle, _layerDescs[l]._sdrIterMeasure, _layerDescs[l]._sdrLeak);
+
+		// Attention gated inputs for next layer if there is one
+		if (l < numLayers - 1) {
+			for (int i = 0; i < _layers[l]._sdr._states.size(); i++)
+				_layers[l + 1]._sdr._visibleInputs[i] = _layers[l]._sdr._states[i] * _layers[l]._sdrrls.getAction(i, CSRL::_attention);
+		}
+	}
+
+	// Prediction
+	for (int l = numLayers - 1; l >= 0; l--) {
+		Layer &layer = _layers[l];
+
+		const Connections &feedBack = _weights->_layers[l]._feedBackConnections;
+		const Connections &predictive = _weights->_layers[l]._predictiveConnections;
+
+		for (int pi = 0; pi < layer._predictions.size(); pi++) {
+			float activation = 0.0f;
+
+			// Feed Back
+			if (l < numLayers - 1) {
+				for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++)
+					activation += feedBack._weights[ci] * _layers[l + 1]._predictions[feedBack._indices[ci]];
+			}
+
+			// Predictive
+			for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+				activation += predictive._weights[ci] * layer._sdr._states[predictive._indices[ci]];
+
+			layer._predictions[pi] = std::min(1.0f, std::max(0.0f, activation));
+		}
+	}
+
+	const Connections &inputFeedBack = _weights->_inputFeedBackConnections;
+
+	// Get first layer prediction
+	for (int pi = 0; pi < _inputPredictions.size(); pi++) {
+		float activation = 0.0f;
+
+		for (int ci = inputFeedBack._offsets[pi]; ci < inputFeedBack._offsets[pi + 1]; ci++)
+			activation += inputFeedBack._weights[ci] * _layers.front()._predictions[inputFeedBack._indices[ci]];
+
+		_inputPredictions[pi] = _inputTypes[pi] == CSRL::_action ? std::min(1.0f, std::max(-1.0f, activation)) : activation;
+	}
+
+	// Columns, top down since the local rewards of a layer are inputs to the one below
+	for (int l = numLayers - 1; l >= 0; l--) {
+		Layer &layer = _layers[l];
+
+		const Connections &feedBack = _weights->_layers[l]._feedBackConnections;
+		const Connections &predictive = _weights->_layers[l]._predictiveConnections;
+
+		for (int pi = 0; pi < layer._predictions.size(); pi++) {
+			SDRRLBatch::ColumnView sdrrl = layer._sdrrls.getColumn(pi);
+
+			int inputIndex = 0;
+
+			for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++)
+				sdrrl.setState(inputIndex++, l < numLayers - 1 ? _layers[l + 1]._localRewards[feedBack._indices[ci]] : _lastLayerRewardOffsets[feedBack._indices[ci]] + reward);
+
+			for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+				sdrrl.setState(inputIndex++, layer._sdr._states[predictive._indices[ci]]);
+
+			for (int i = 0; i < _layerDescs[l]._numRecurrentInputs; i++)
+				sdrrl.setState(inputIndex++, sdrrl.getAction(CSRL::_numActionTypes + i));
+		}
+
+		layer._sdrrls.act(_layerDescs[l]._sdrIterSettle, _layerDescs[l]._sdrIterMeasure, _layerDescs[l]._sdrLeak,
+			_layerDescs[l]._actionDeriveIterations, _layerDescs[l]._actionDeriveAlpha, _threadPool.get());
+
+		for (int pi = 0; pi < layer._predictions.size(); pi++)
+			layer._localRewards[pi] = layer._sdrrls.getAction(pi, CSRL::_reward);
+	}
+
+	for (int pi = 0; pi < _inputPredictions.size(); pi++) {
+		SDRRLBatch::ColumnView sdrrl = _inputSDRRLs.getColumn(pi);
+
+		int inputIndex = 0;
+
+		for (int ci = inputFeedBack._offsets[pi]; ci < inputFeedBack._offsets[pi + 1]; ci++)
+			sdrrl.setState(inputIndex++, _layers.front()._localRewards[inputFeedBack._indices[ci]]);
+
+		for (int i = 0; i < _numRecurrentInputs; i++)
+			sdrrl.setState(inputIndex++, sdrrl.getAction(CSRL::_numActionTypes + i));
+	}
+
+	_inputSDRRLs.act(_sdrIterSettle, _sdrIterMeasure, _sdrLeak, _actionDeriveIterations, _actionDeriveAlpha, _threadPool.get());
+
+	for (int l = 0; l < numLayers; l++)
+		_layers[l]._sdr._statesPrev = _layers[l]._sdr._states;
+
+	// Predictions become the inputs, actions stay that way until the next step
+	for (int pi = 0; pi < _inputPredictions.size(); pi++)
+		_layers.front()._sdr._visibleInputs[pi] = _inputPredictions[pi];
+}
+
+void CSRLPolicy::fork(CSRLPolicy &branch) const {
+	branch = *this;
+
+	branch._threadPool = nullptr;
+}
\ No newline at end of file
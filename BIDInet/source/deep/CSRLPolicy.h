@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CSRL.h"
+
+namespace deep {
+	// Inference-only copy of a trained CSRL, made by CSRL::exportPolicy. It keeps only the weights that activation, attention
+	// gating and action output need, in flat arrays without traces, and steps without any learning or exploration:
+	// columns output the actions they derive, and action inputs are the clamped predictions
+	// unless setAction overrides them.
+	// The weights are immutable and shared by all copies, so a fork only clones the per step state. Forks can be stepped
+	// from separate threads, for instance to roll out candidate action sequences from the same starting point
+	class CSRLPolicy {
+	public:
+		// Connections of all units of a layer back to back, those of unit i are [_offsets[i], _offsets[i + 1])
+		struct Connections {
+			std::vector<int> _offsets;
+			std::vector<unsigned short> _indices;
+			std::vector<float> _weights;
+
+			Connections()
+				: _offsets(1, 0)
+			{}
+
+			void add(unsigned short index, float weight) {
+				_indices.push_back(index);
+				_weights.push_back(weight);
+			}
+
+			// Ends the current unit
+			void next() {
+				_offsets.push_back(_indices.size());
+			}
+		};
+
+		struct LayerWeights {
+			// Frozen IRSDR
+			Connections _feedForward;
+			Connections _recurrent;
+			Connections _lateral;
+
+			std::vector<float> _thresholds;
+
+			Connections _feedBackConnections;
+			Connections _predictiveConnections;
+		};
+
+		struct Weights {
+			std::vector<LayerWeights> _layers;
+
+			Connections _inputFeedBackConnections;
+		};
+
+		// State of a frozen IRSDR
+		struct Encoder {
+			std::vector<float> _visibleInputs;
+			std::vector<float> _visibleRecons;
+
+			std::vector<float> _activations;
+			std::vector<float> _spikes;
+			std::vector<float> _spikesPrev;
+			std::vector<float> _states;
+			std::vector<float> _statesPrev;
+			std::vector<float> _hiddenRecons;
+
+			std::vector<float> _visibleErrors;
+			std::vector<float> _hiddenErrors;
+
+			void activate(const LayerWeights &weights, int settleIter, int measureIter, float leak);
+
+			// Accumulates weight * values[hi] of every hidden unit into the reconstructions
+			void reconstruct(const LayerWeights &weights, const std::vector<float> &values);
+		};
+
+		struct Layer {
+			Encoder _sdr;
+
+			std::vector<float> _predictions;
+			std::vector<float> _localRewards;
+
+			SDRRLBatch _sdrrls;
+		};
+
+	private:
+		std::vector<CSRL::LayerDesc> _layerDescs;
+		std::vector<Layer> _layers;
+
+		std::vector<CSRL::InputType> _inputTypes;
+
+		std::shared_ptr<const Weights> _weights;
+
+		std::vector<float> _inputPredictions;
+
+		SDRRLBatch _inputSDRRLs;
+
+		std::vector<float> _lastLayerRewardOffsets;
+
+		int _numRecurrentInputs;
+		int _sdrIterSettle, _sdrIterMeasure;
+		float _sdrLeak;
+		int _actionDeriveIterations;
+		float _actionDeriveAlpha;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+	public:
+		CSRLPolicy()
+			: _numRecurrentInputs(0), _sdrIterSettle(0), _sdrIterMeasure(1), _sdrLeak(0.0f), _actionDeriveIterations(0), _actionDeriveAlpha(0.0f)
+		{}
+
+		void simStep(float reward);
+
+		// Makes branch a copy of this policy that shares its weights. Reusing the same branch for every fork avoids
+		// reallocating its state. Branches get no thread pool since the pool is not reentrant, step them on separate threads instead
+		void fork(CSRLPolicy &branch) const;
+
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		void setInput(int index, float value) {
+			assert(_inputTypes[index] == CSRL::_state);
+
+			_layers.front()._sdr._visibleInputs[index] = value;
+		}
+
+		// Inputs of type _state only, as CSRL::setInputs
+		void setInputs(const float* inputs) {
+			for (int i = 0; i < _inputTypes.size(); i++)
+				if (_inputTypes[i] == CSRL::_state)
+					_layers.front()._sdr._visibleInputs[i] = inputs[i];
+		}
+
+		void setInputs(const std::vector<float> &inputs) {
+			setInputs(inputs.data());
+		}
+
+		// Takes value as the action at index instead of the prediction of the last simStep. The next simStep sees it as its
+		// action input, so call it between steps, after reading the predictions. Lets a fork follow a chosen action sequence
+		void setAction(int index, float value) {
+			assert(_inputTypes[index] == CSRL::_action);
+
+			_layers.front()._sdr._visibleInputs[index] = value;
+		}
+
+		// Inputs of type _action only
+		void setActions(const float* actions) {
+			for (int i = 0; i < _inputTypes.size(); i++)
+				if (_inputTypes[i] == CSRL::_action)
+					_layers.front()._sdr._visibleInputs[i] = actions[i];
+		}
+
+		void setActions(const std::vector<float> &actions) {
+			setActions(actions.data());
+		}
+
+		float getPrediction(int index) const {
+			return _inputPredictions[index];
+		}
+
+		void getPredictions(std::vector<float> &predictions) const {
+			predictions = _inputPredictions;
+		}
+
+		int getNumInputs() const {
+			return _inputPredictions.size();
+		}
+
+		friend class CSRL;
+		friend class CSRLBatch;
+	};
+}
\ No newline at end of file
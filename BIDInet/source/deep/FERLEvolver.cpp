@@ -0,0 +1,144 @@
+#include "FERLEvolver.h"
+
+#include "BinaryStream.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace deep;
+
+void FERLEvolver::createRandom(int populationSize, int numState, int numAction, int numHidden, float weightStdDev, std::mt19937 &generator) {
+	_population.resize(populationSize);
+
+	_generation = 0;
+
+	for (int i = 0; i < _population.size(); i++) {
+		_population[i]._generator.seed(generator());
+
+		_population[i]._agent.createRandom(numState, numAction, numHidden, weightStdDev, _population[i]._generator);
+
+		_population[i]._fitness = 0.0f;
+	}
+}
+
+void FERLEvolver::evaluate(const FitnessFunction &fitnessFunction) {
+	sys::parallelFor(_threadPool.get(), _population.size(), [&](int i) {
+		_population[i]._fitness = fitnessFunction(_population[i]._agent, _population[i]._generator);
+	});
+}
+
+int FERLEvolver::tournament(std::mt19937 &generator) const {
+	std::uniform_int_distribution<int> individualDist(0, _population.size() - 1);
+
+	int best = individualDist(generator);
+
+	for (int t = 1; t < _tournamentSize; t++) {
+		int challenger = individualDist(generator);
+
+		if (_population[challenger]._fitness > _population[best]._fitness)
+			best = challenger;
+	}
+
+	return best;
+}
+
+void FERLEvolver::nextGeneration(std::mt19937 &generator) {
+	std::stable_sort(_population.begin(), _population.end(), [](const Individual &left, const Individual &right) {
+		return left._fitness > right._fitness;
+	});
+
+	int numElites = std::min<int>(_numElites, _population.size());
+
+	// Pick parents and seed children serially, then breed in parallel
+	std::vector<int> parents1(_population.size());
+	std::vector<int> parents2(_population.size());
+
+	std::vector<Individual> children(_population.size());
+
+	for (int i = numElites; i < _population.size(); i++) {
+		parents1[i] = tournament(generator);
+		parents2[i] = tournament(generator);
+
+		children[i]._generator.seed(generator());
+	}
+
+	sys::parallelFor(_threadPool.get(), _population.size() - numElites, [&](int c) {
+		int i = c + numElites;
+
+		children[i]._agent.createFromParents(_population[parents1[i]]._agent, _population[parents2[i]]._agent, _averageChance, children[i]._generator);
+		children[i]._agent.mutate(_perturbationStdDev, children[i]._generator);
+	});
+
+	for (int i = numElites; i < _population.size(); i++)
+		_population[i] = std::move(children[i]);
+
+	_generation++;
+}
+
+const FERLEvolver::Individual &FERLEvolver::getBest() const {
+	int best = 0;
+
+	for (int i = 1; i < _population.size(); i++)
+		if (_population[i]._fitness > _population[best]._fitness)
+			best = i;
+
+	return _population[best];
+}
+
+void FERLEvolver::saveToFile(std::ostream &os) const {
+	BinaryWriter writer;
+
+	writer.write(_generation);
+	writer.write(static_cast<int>(_population.size()));
+
+	for (int i = 0; i < _population.size(); i++) {
+		std::ostringstream generatorState;
+
+		generatorState << _population[i]._generator;
+
+		writer.write(_population[i]._fitness);
+		writer.write(generatorState.str());
+	}
+
+	writer.save(os, "FEVO", _fileVersion);
+
+	// Agents follow as their own snapshots
+	for (int i = 0; i < _population.size(); i++)
+		_population[i]._agent.saveToFile(os);
+}
+
+bool FERLEvolver::loadFromFile(std::istream &is) {
+	BinaryReader reader;
+
+	if (!reader.load(is, "FEVO") || reader.getVersion() != _fileVersion) {
+		std::cerr << "Stream does not contain a valid population snapshot!" << std::endl;
+
+		return false;
+	}
+
+	int populationSize;
+
+	reader.read(_generation);
+	reader.read(populationSize);
+
+	if (!reader.good())
+		return false;
+
+	_population.resize(populationSize);
+
+	for (int i = 0; i < _population.size(); i++) {
+		std::string generatorState;
+
+		reader.read(_population[i]._fitness);
+		reader.read(generatorState);
+
+		std::istringstream(generatorState) >> _population[i]._generator;
+	}
+
+	for (int i = 0; i < _population.size(); i++)
+		if (!_population[i]._agent.loadFromFile(is))
+			return false;
+
+	return reader.good();
+}
\ No newline at end of file
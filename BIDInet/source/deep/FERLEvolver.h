@@ -0,0 +1,87 @@
+#pragma once
+
+#include "FERL.h"
+
+#include <system/ThreadPool.h>
+
+#include <functional>
+#include <memory>
+
+namespace deep {
+	// Runs a population of FERL agents through evaluation, selection, crossover and mutation.
+	// Every individual owns its random stream, so results do not depend on the number of threads.
+	class FERLEvolver {
+	public:
+		struct Individual {
+			FERL _agent;
+
+			float _fitness;
+
+			std::mt19937 _generator;
+
+			Individual()
+				: _fitness(0.0f)
+			{}
+		};
+
+		// Called concurrently, so it must create its own environment instance
+		typedef std::function<float(FERL &agent, std::mt19937 &generator)> FitnessFunction;
+
+	private:
+		std::vector<Individual> _population;
+
+		int _generation;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+		static const unsigned int _fileVersion = 1;
+
+		int tournament(std::mt19937 &generator) const;
+
+	public:
+		int _numElites;
+		int _tournamentSize;
+		float _averageChance;
+		float _perturbationStdDev;
+
+		FERLEvolver()
+			: _generation(0),
+			_numElites(2),
+			_tournamentSize(3),
+			_averageChance(0.1f),
+			_perturbationStdDev(0.01f)
+		{}
+
+		void createRandom(int populationSize, int numState, int numAction, int numHidden, float weightStdDev, std::mt19937 &generator);
+
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		// Agents keep what they learned during evaluation
+		void evaluate(const FitnessFunction &fitnessFunction);
+
+		// Sorts by fitness, keeps the elites and breeds the rest
+		void nextGeneration(std::mt19937 &generator);
+
+		// Binary snapshot of the population and its random streams, streams must be opened with std::ios::binary
+		void saveToFile(std::ostream &os) const;
+
+		// Returns false if the stream does not hold a valid snapshot
+		bool loadFromFile(std::istream &is);
+
+		int getGeneration() const {
+			return _generation;
+		}
+
+		int getPopulationSize() const {
+			return _population.size();
+		}
+
+		const Individual &getIndividual(int index) const {
+			return _population[index];
+		}
+
+		const Individual &getBest() const;
+	};
+}
\ No newline at end of file
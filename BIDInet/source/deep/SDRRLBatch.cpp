@@ -0,0 +1,763 @@
+#include "SDRRLBatch.h"
+
+#include <algorithm>
+
+#include <assert.h>
+
+using namespace deep;
+
+void SDRRLBatch::create(int numColumns, int maxStates, int numActions, int numCells, int numWeightSets) {
+	_numColumns = numColumns;
+	_maxStates = maxStates;
+	_numActions = numActions * 2;
+	_numCells = numCells;
+	_numWeightSets = numWeightSets < 0 ? numColumns : numWeightSets;
+
+	assert(_numWeightSets > 0 && _numColumns % _numWeightSets == 0);
+
+	_numStates.assign(_numColumns, 0);
+	_prevValues.assign(_numColumns, 0.0f);
+	_averageSurprises.assign(_numColumns, 0.0f);
+	_tdErrors.assign(_numColumns, 0.0f);
+
+	_inputs.assign(_numColumns * _maxStates, 0.0f);
+	_reconstructionErrors.assign(_numColumns * _maxStates, 0.0f);
+
+	_weights = std::make_shared<Weights>();
+
+	_weights->_feedForwardWeights.assign(_numWeightSets * _numCells * _maxStates, 0.0f);
+
+	_weights->_lateralWeights.assign(_numWeightSets * _numCells * _numCells, 0.0f);
+
+	_weights->_actionWeights.assign(_numWeightSets * _numCells * _numActions, 0.0f);
+	_actionTraces.assign(_numColumns * _numCells * _numActions, 0.0f);
+
+	_weights->_qWeights.assign(_numWeightSets * _numCells, 0.0f);
+	_qTraces.assign(_numColumns * _numCells, 0.0f);
+	_weights->_thresholds.assign(_numWeightSets * _numCells, 0.0f);
+	_activations.assign(_numColumns * _numCells, 0.0f);
+	_spikes.assign(_numColumns * _numCells, 0.0f);
+	_spikesPrev.assign(_numColumns * _numCells, 0.0f);
+	_cellStates.assign(_numColumns * _numCells, 0.0f);
+	_actionStates.assign(_numColumns * _numCells, 0.0f);
+	_tracesLive.assign(_numColumns * _numCells, 1);
+	_traceStamps.assign(_numColumns * _numCells, 0);
+
+	_traceStep = 0;
+
+	_actionValues.assign(_numColumns * _numActions, 0.0f);
+	_exploratoryActions.assign(_numColumns * _numActions, 0.0f);
+
+	_actionOptimizers.assign(_numColumns, ActionOptimizer());
+
+	_drives.assign(_numColumns * _numCells, 0.0f);
+	_overlaps.assign(_numWeightSets * _numCells * _numCells, 0.0f);
+	_activeInputs.assign(_numColumns * _maxStates, 0);
+}
+
+void SDRRLBatch::createShared(const SDRRLBatch &model, int numCopies) {
+	assert(model._numWeightSets == model._numColumns);
+
+	create(model._numColumns * numCopies, model._maxStates, model._numActions / 2, model._numCells, model._numColumns);
+
+	// Weight sets are laid out as the model's columns, so the weights are shared until either batch learns
+	_weights = model._weights;
+
+	for (int c = 0; c < _numColumns; c++)
+		_numStates[c] = model._numStates[getWeightSet(c)];
+}
+
+void SDRRLBatch::initColumn(int column, int numStates, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
+	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
+	std::uniform_real_distribution<float> inhibitionDist(initMinInhibition, initMaxInhibition);
+
+	detachWeights();
+
+	const int weightSet = getWeightSet(column);
+
+	for (int c = weightSet; c < _numColumns; c += _numWeightSets)
+		_numStates[c] = numStates;
+
+	for (int i = 0; i < _numCells; i++) {
+		int cellIndex = weightSet * _numCells + i;
+
+		_weights->_thresholds[cellIndex] = initThreshold;
+
+		float* pFeedForward = &_weights->_feedForwardWeights[cellIndex * _maxStates];
+
+		for (int j = 0; j < numStates; j++)
+			pFeedForward[j] = weightDist(generator);
+
+		float* pLateral = &_weights->_lateralWeights[cellIndex * _numCells];
+
+		for (int j = 0; j < _numCells; j++)
+			pLateral[j] = inhibitionDist(generator);
+
+		float* pAction = &_weights->_actionWeights[cellIndex * _numActions];
+
+		for (int j = 0; j < _numActions; j++)
+			pAction[j] = weightDist(generator);
+
+		_weights->_qWeights[cellIndex] = weightDist(generator);
+	}
+}
+
+void SDRRLBatch::detachWeights() {
+	if (_weights.use_count() > 1)
+		_weights = std::make_shared<Weights>(*_weights);
+}
+
+void SDRRLBatch::activate(int column, int subIterSettle, int subIterMeasure, float leak) {
+	const int numStates = _numStates[column];
+
+	const float* pInputs = &_inputs[column * _maxStates];
+	float* pErrors = &_reconstructionErrors[column * _maxStates];
+
+	const int weightSet = getWeightSet(column);
+
+	const float* pFeedForward = &_weights->_feedForwardWeights[weightSet * _numCells * _maxStates];
+	const float* pLateral = &_weights->_lateralWeights[weightSet * _numCells * _numCells];
+
+	const float* pThresholds = &_weights->_thresholds[weightSet * _numCells];
+	float* pActivations = &_activations[column * _numCells];
+	float* pSpikes = &_spikes[column * _numCells];
+	float* pSpikesPrev = &_spikesPrev[column * _numCells];
+	float* pStates = &_cellStates[column * _numCells];
+
+	// Clear activations and states
+	for (int i = 0; i < _numCells; i++) {
+		pActivations[i] = 0.0f;
+		pStates[i] = 0.0f;
+	}
+
+	const float subIterMeasureInv = 1.0f / subIterMeasure;
+
+	for (int iter = 0; iter < subIterSettle + subIterMeasure; iter++) {
+		bool measure = iter >= subIterSettle;
+
+		// Activate
+		for (int i = 0; i < _numCells; i++) {
+			const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+			const float* pCellLateral = &pLateral[i * _numCells];
+
+			float excitation = 0.0f;
+
+			for (int j = 0; j < numStates; j++)
+				excitation += pCellFeedForward[j] * pErrors[j];
+
+			float inhibition = 0.0f;
+
+			for (int j = 0; j < _numCells; j++)
+				inhibition += pCellLateral[j] * pSpikesPrev[j];
+
+			float activation = (1.0f - leak) * pActivations[i] + excitation - inhibition;
+
+			if (activation > pThresholds[i]) {
+				activation = 0.0f;
+
+				pSpikes[i] = 1.0f;
+			}
+			else
+				pSpikes[i] = 0.0f;
+
+			if (measure)
+				pStates[i] += pSpikes[i] * subIterMeasureInv;
+
+			pActivations[i] = activation;
+		}
+
+		// Double buffer update
+		for (int i = 0; i < _numCells; i++)
+			pSpikesPrev[i] = pSpikes[i];
+
+		// Reconstruct, row by row over the spiking cells. Spikes are 0 or 1, so the sums match the per input dot products
+		for (int j = 0; j < numStates; j++)
+			pErrors[j] = 0.0f;
+
+		for (int i = 0; i < _numCells; i++)
+			if (pSpikes[i] > 0.0f) {
+				const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+				for (int j = 0; j < numStates; j++)
+					pErrors[j] += pCellFeedForward[j];
+			}
+
+		for (int j = 0; j < numStates; j++)
+			pErrors[j] = pInputs[j] - pErrors[j];
+	}
+
+	// Final state reconstruction
+	for (int j = 0; j < numStates; j++)
+		pErrors[j] = 0.0f;
+
+	for (int i = 0; i < _numCells; i++)
+		if (pStates[i] > 0.0f) {
+			const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+			for (int j = 0; j < numStates; j++)
+				pErrors[j] += pStates[i] * pCellFeedForward[j];
+		}
+
+	for (int j = 0; j < numStates; j++)
+		pErrors[j] = pInputs[j] - pErrors[j];
+}
+
+void SDRRLBatch::computeOverlaps(int weightSet, int cell) {
+	const int numStates = _numStates[weightSet];
+
+	const float* pFeedForward = &_weights->_feedForwardWeights[weightSet * _numCells * _maxStates];
+	float* pOverlaps = &_overlaps[weightSet * _numCells * _numCells];
+
+	const float* pCellFeedForward = &pFeedForward[cell * _maxStates];
+
+	// Symmetric, each cell fills its row up to the diagonal and the matching column
+	for (int k = 0; k <= cell; k++) {
+		const float* pOtherFeedForward = &pFeedForward[k * _maxStates];
+
+		float overlap = 0.0f;
+
+		for (int j = 0; j < numStates; j++)
+			overlap += pCellFeedForward[j] * pOtherFeedForward[j];
+
+		pOverlaps[cell * _numCells + k] = overlap;
+		pOverlaps[k * _numCells + cell] = overlap;
+	}
+}
+
+void SDRRLBatch::activateSparse(int column, int subIterSettle, int subIterMeasure, float leak) {
+	const int numStates = _numStates[column];
+	const int weightSet = getWeightSet(column);
+
+	const float* pInputs = &_inputs[column * _maxStates];
+	float* pErrors = &_reconstructionErrors[column * _maxStates];
+	int* pActive = &_activeInputs[column * _maxStates];
+
+	const float* pFeedForward = &_weights->_feedForwardWeights[weightSet * _numCells * _maxStates];
+	const float* pLateral = &_weights->_lateralWeights[weightSet * _numCells * _numCells];
+
+	const float* pThresholds = &_weights->_thresholds[weightSet * _numCells];
+	float* pActivations = &_activations[column * _numCells];
+	float* pSpikes = &_spikes[column * _numCells];
+	float* pSpikesPrev = &_spikesPrev[column * _numCells];
+	float* pStates = &_cellStates[column * _numCells];
+	float* pDrives = &_drives[column * _numCells];
+	const float* pOverlaps = &_overlaps[weightSet * _numCells * _numCells];
+
+	int numActive = 0;
+
+	for (int j = 0; j < numStates; j++)
+		if (pInputs[j] != 0.0f)
+			pActive[numActive++] = j;
+
+	// Drive of the inputs
+	for (int i = 0; i < _numCells; i++) {
+		const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+		float drive = 0.0f;
+
+		for (int a = 0; a < numActive; a++)
+			drive += pCellFeedForward[pActive[a]] * pInputs[pActive[a]];
+
+		pDrives[i] = drive;
+	}
+
+	// Clear activations and states
+	for (int i = 0; i < _numCells; i++) {
+		pActivations[i] = 0.0f;
+		pStates[i] = 0.0f;
+	}
+
+	const float subIterMeasureInv = 1.0f / subIterMeasure;
+
+	for (int iter = 0; iter < subIterSettle + subIterMeasure; iter++) {
+		bool measure = iter >= subIterSettle;
+
+		// Activate
+		for (int i = 0; i < _numCells; i++) {
+			const float* pCellLateral = &pLateral[i * _numCells];
+
+			float excitation = 0.0f;
+
+			if (iter == 0) {
+				// The first iteration sees the error left by the previous step
+				const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+				for (int j = 0; j < numStates; j++)
+					excitation += pCellFeedForward[j] * pErrors[j];
+			}
+			else {
+				// Inputs minus the reconstruction from the previous iteration's spikes
+				const float* pCellOverlaps = &pOverlaps[i * _numCells];
+
+				excitation = pDrives[i];
+
+				for (int k = 0; k < _numCells; k++)
+					if (pSpikesPrev[k] > 0.0f)
+						excitation -= pCellOverlaps[k];
+			}
+
+			float inhibition = 0.0f;
+
+			for (int j = 0; j < _numCells; j++)
+				inhibition += pCellLateral[j] * pSpikesPrev[j];
+
+			float activation = (1.0f - leak) * pActivations[i] + excitation - inhibition;
+
+			if (activation > pThresholds[i]) {
+				activation = 0.0f;
+
+				pSpikes[i] = 1.0f;
+			}
+			else
+				pSpikes[i] = 0.0f;
+
+			if (measure)
+				pStates[i] += pSpikes[i] * subIterMeasureInv;
+
+			pActivations[i] = activation;
+		}
+
+		// Double buffer update
+		for (int i = 0; i < _numCells; i++)
+			pSpikesPrev[i] = pSpikes[i];
+	}
+
+	// Final state reconstruction, over the active cells
+	for (int j = 0; j < numStates; j++)
+		pErrors[j] = pInputs[j];
+
+	for (int i = 0; i < _numCells; i++)
+		if (pStates[i] > 0.0f) {
+			const float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+			for (int j = 0; j < numStates; j++)
+				pErrors[j] -= pStates[i] * pCellFeedForward[j];
+		}
+}
+
+bool SDRRLBatch::reviveTraces(int column, int cell, float gammaLambda) {
+	const int cellIndex = column * _numCells + cell;
+
+	if (!_sparseTraces || _tracesLive[cellIndex])
+		return true;
+
+	// An inactive cell's traces only decay
+	if (_actionStates[cellIndex] == 0.0f)
+		return false;
+
+	float traceDecay = std::pow(gammaLambda, _traceStep - 1 - _traceStamps[cellIndex]);
+
+	float* pCellActionTraces = &_actionTraces[cellIndex * _numActions];
+
+	for (int vi = 0; vi < _numActions; vi++)
+		pCellActionTraces[vi] *= traceDecay;
+
+	_qTraces[cellIndex] *= traceDecay;
+
+	_tracesLive[cellIndex] = 1;
+
+	return true;
+}
+
+void SDRRLBatch::checkTraces(int column, int cell) {
+	if (!_sparseTraces)
+		return;
+
+	const int cellIndex = column * _numCells + cell;
+
+	const float* pCellActionTraces = &_actionTraces[cellIndex * _numActions];
+
+	float maxTrace = std::abs(_qTraces[cellIndex]);
+
+	for (int vi = 0; vi < _numActions; vi++)
+		maxTrace = std::max(maxTrace, std::abs(pCellActionTraces[vi]));
+
+	_tracesLive[cellIndex] = maxTrace > _traceEpsilon;
+	_traceStamps[cellIndex] = _traceStep;
+}
+
+void SDRRLBatch::deriveActions(int column, int actionDeriveIterations, float actionDeriveAlpha) {
+	const int weightSet = getWeightSet(column);
+
+	const float* pActionWeights = &_weights->_actionWeights[weightSet * _numCells * _numActions];
+	const float* pQWeights = &_weights->_qWeights[weightSet * _numCells];
+	const float* pStates = &_cellStates[column * _numCells];
+
+	ActionOptimizer &optimizer = _actionOptimizers[column];
+
+	// Only active cells take part
+	optimizer.clearCells(_numActions);
+
+	for (int k = 0; k < _numCells; k++)
+		if (pStates[k] > 0.0f) {
+			float* pRow = optimizer.addCell(pQWeights[k], pStates[k]);
+
+			for (int vi = 0; vi < _numActions; vi++)
+				pRow[vi] = pActionWeights[k * _numActions + vi];
+		}
+
+	optimizer.derive(&_actionValues[column * _numActions], actionDeriveIterations, actionDeriveAlpha, _actionDeriveStarts, _actionDeriveMinGradient);
+}
+
+void SDRRLBatch::learn(int column, float reward, float sparsity, float gamma,
+	float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+	float qAlpha, float actionAlpha, float gammaLambda,
+	float averageSurpiseDecay, float surpriseLearnFactor)
+{
+	const int numStates = _numStates[column];
+
+	const float* pErrors = &_reconstructionErrors[column * _maxStates];
+
+	float* pFeedForward = &_weights->_feedForwardWeights[column * _numCells * _maxStates];
+	float* pLateral = &_weights->_lateralWeights[column * _numCells * _numCells];
+	float* pActionWeights = &_weights->_actionWeights[column * _numCells * _numActions];
+	float* pActionTraces = &_actionTraces[column * _numCells * _numActions];
+
+	float* pQWeights = &_weights->_qWeights[column * _numCells];
+	float* pQTraces = &_qTraces[column * _numCells];
+	float* pThresholds = &_weights->_thresholds[column * _numCells];
+	const float* pStates = &_cellStates[column * _numCells];
+	float* pActionStates = &_actionStates[column * _numCells];
+
+	const float* pExploratory = &_exploratoryActions[column * _numActions];
+
+	// Forwards
+	float q = 0.0f;
+
+	for (int k = 0; k < _numCells; k++) {
+		if (pStates[k] > 0.0f) {
+			const float* pCellActionWeights = &pActionWeights[k * _numActions];
+
+			float sum = 0.0f;
+
+			for (int vi = 0; vi < _numActions; vi++)
+				sum += pCellActionWeights[vi] * pExploratory[vi];
+
+			pActionStates[k] = sigmoid(sum) * pStates[k];
+
+			q += pQWeights[k] * pActionStates[k];
+		}
+		else
+			pActionStates[k] = 0.0f;
+	}
+
+	float tdError = reward + gamma * q - _prevValues[column];
+	float qAlphaTdError = qAlpha * tdError;
+	float actionAlphaTdError = actionAlpha * tdError;
+	float surprise = tdError * tdError;
+
+	_averageSurprises[column] = (1.0f - averageSurpiseDecay) * _averageSurprises[column] + averageSurpiseDecay * surprise;
+
+	// Update weights
+	for (int k = 0; k < _numCells; k++) {
+		if (!reviveTraces(column, k, gammaLambda))
+			continue;
+
+		float error = pQWeights[k] * pActionStates[k] * (1.0f - pActionStates[k]);
+
+		float* pCellActionWeights = &pActionWeights[k * _numActions];
+		float* pCellActionTraces = &pActionTraces[k * _numActions];
+
+		for (int vi = 0; vi < _numActions; vi++) {
+			pCellActionWeights[vi] += actionAlphaTdError * pCellActionTraces[vi];
+
+			pCellActionTraces[vi] = pCellActionTraces[vi] * gammaLambda + error * pExploratory[vi];
+		}
+
+		pQWeights[k] += qAlphaTdError * pQTraces[k];
+
+		pQTraces[k] = pQTraces[k] * gammaLambda + pActionStates[k];
+
+		checkTraces(column, k);
+	}
+
+	float sparsitySquared = sparsity * sparsity;
+
+	for (int i = 0; i < _numCells; i++) {
+		// Learn SDRs
+		if (pStates[i] > 0.0f) {
+			float* pCellFeedForward = &pFeedForward[i * _maxStates];
+
+			for (int j = 0; j < numStates; j++)
+				pCellFeedForward[j] += gateFeedForwardAlpha * pStates[i] * pErrors[j];
+		}
+
+		float* pCellLateral = &pLateral[i * _numCells];
+
+		for (int j = 0; j < _numCells; j++)
+			pCellLateral[j] = std::max(0.0f, pCellLateral[j] + gateLateralAlpha * (pStates[i] * pStates[j] - sparsitySquared));
+
+		pThresholds[i] += gateThresholdAlpha * (pStates[i] - sparsity);
+	}
+
+	_prevValues[column] = q;
+}
+
+void SDRRLBatch::evaluate(int column, float reward, float gamma, float averageSurpiseDecay) {
+	const int weightSet = getWeightSet(column);
+
+	const float* pActionWeights = &_weights->_actionWeights[weightSet * _numCells * _numActions];
+	const float* pQWeights = &_weights->_qWeights[weightSet * _numCells];
+	const float* pStates = &_cellStates[column * _numCells];
+	float* pActionStates = &_actionStates[column * _numCells];
+
+	const float* pExploratory = &_exploratoryActions[column * _numActions];
+
+	// Forwards
+	float q = 0.0f;
+
+	for (int k = 0; k < _numCells; k++) {
+		if (pStates[k] > 0.0f) {
+			const float* pCellActionWeights = &pActionWeights[k * _numActions];
+
+			float sum = 0.0f;
+
+			for (int vi = 0; vi < _numActions; vi++)
+				sum += pCellActionWeights[vi] * pExploratory[vi];
+
+			pActionStates[k] = sigmoid(sum) * pStates[k];
+
+			q += pQWeights[k] * pActionStates[k];
+		}
+		else
+			pActionStates[k] = 0.0f;
+	}
+
+	float tdError = reward + gamma * q - _prevValues[column];
+
+	float surprise = tdError * tdError;
+
+	_tdErrors[column] = tdError;
+
+	_averageSurprises[column] = (1.0f - averageSurpiseDecay) * _averageSurprises[column] + averageSurpiseDecay * surprise;
+
+	_prevValues[column] = q;
+}
+
+void SDRRLBatch::learnShared(int weightSet, int cell, float sparsity,
+	float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+	float qAlpha, float actionAlpha, float gammaLambda)
+{
+	const int numStates = _numStates[weightSet];
+	const float scale = static_cast<float>(_numWeightSets) / _numColumns;
+
+	const int cellIndex = weightSet * _numCells + cell;
+
+	float* pCellFeedForward = &_weights->_feedForwardWeights[cellIndex * _maxStates];
+	float* pCellLateral = &_weights->_lateralWeights[cellIndex * _numCells];
+	float* pCellActionWeights = &_weights->_actionWeights[cellIndex * _numActions];
+
+	// Columns whose traces of this cell are maintained this step
+	bool anyLive = false;
+
+	for (int c = weightSet; c < _numColumns; c += _numWeightSets) {
+		_tracesLive[c * _numCells + cell] = reviveTraces(c, cell, gammaLambda);
+
+		anyLive = anyLive || _tracesLive[c * _numCells + cell];
+	}
+
+	// Action and Q weights, from the traces before this step's update
+	for (int vi = 0; vi < _numActions && anyLive; vi++) {
+		float delta = 0.0f;
+
+		for (int c = weightSet; c < _numColumns; c += _numWeightSets)
+			if (_tracesLive[c * _numCells + cell])
+				delta += (actionAlpha * _tdErrors[c]) * _actionTraces[(c * _numCells + cell) * _numActions + vi];
+
+		pCellActionWeights[vi] += scale * delta;
+	}
+
+	float qDelta = 0.0f;
+
+	for (int c = weightSet; c < _numColumns; c += _numWeightSets)
+		if (_tracesLive[c * _numCells + cell])
+			qDelta += (qAlpha * _tdErrors[c]) * _qTraces[c * _numCells + cell];
+
+	// Traces, with the Q weight before its update
+	float qWeight = _weights->_qWeights[cellIndex];
+
+	for (int c = weightSet; c < _numColumns; c += _numWeightSets) {
+		if (!_tracesLive[c * _numCells + cell])
+			continue;
+
+		float actionState = _actionStates[c * _numCells + cell];
+
+		float error = qWeight * actionState * (1.0f - actionState);
+
+		float* pCellActionTraces = &_actionTraces[(c * _numCells + cell) * _numActions];
+		const float* pExploratory = &_exploratoryActions[c * _numActions];
+
+		for (int vi = 0; vi < _numActions; vi++)
+			pCellActionTraces[vi] = pCellActionTraces[vi] * gammaLambda + error * pExploratory[vi];
+
+		_qTraces[c * _numCells + cell] = _qTraces[c * _numCells + cell] * gammaLambda + actionState;
+
+		checkTraces(c, cell);
+	}
+
+	_weights->_qWeights[cellIndex] += scale * qDelta;
+
+	// Learn SDRs
+	for (int j = 0; j < numStates; j++) {
+		float delta = 0.0f;
+
+		for (int c = weightSet; c < _numColumns; c += _numWeightSets) {
+			float state = _cellStates[c * _numCells + cell];
+
+			if (state > 0.0f)
+				delta += gateFeedForwardAlpha * state * _reconstructionErrors[c * _maxStates + j];
+		}
+
+		pCellFeedForward[j] += scale * delta;
+	}
+
+	float sparsitySquared = sparsity * sparsity;
+
+	for (int j = 0; j < _numCells; j++) {
+		float delta = 0.0f;
+
+		for (int c = weightSet; c < _numColumns; c += _numWeightSets)
+			delta += gateLateralAlpha * (_cellStates[c * _numCells + cell] * _cellStates[c * _numCells + j] - sparsitySquared);
+
+		pCellLateral[j] = std::max(0.0f, pCellLateral[j] + scale * delta);
+	}
+
+	float thresholdDelta = 0.0f;
+
+	for (int c = weightSet; c < _numColumns; c += _numWeightSets)
+		thresholdDelta += gateThresholdAlpha * (_cellStates[c * _numCells + cell] - sparsity);
+
+	_weights->_thresholds[cellIndex] += scale * thresholdDelta;
+}
+
+void SDRRLBatch::simStep(float reward, float sparsity, float gamma,
+	int subIterSettle, int subIterMeasure, float leak,
+	float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+	float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+	float explorationStdDev, float explorationBreak,
+	float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool)
+{
+	step(&reward, 0, sparsity, gamma, subIterSettle, subIterMeasure, leak,
+		gateFeedForwardAlpha, gateLateralAlpha, gateThresholdAlpha,
+		qAlpha, actionAlpha, actionDeriveIterations, actionDeriveAlpha, gammaLambda,
+		explorationStdDev, explorationBreak,
+		averageSurpiseDecay, surpriseLearnFactor, generator, pool);
+}
+
+void SDRRLBatch::simStep(const std::vector<float> &rewards, float sparsity, float gamma,
+	int subIterSettle, int subIterMeasure, float leak,
+	float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+	float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+	float explorationStdDev, float explorationBreak,
+	float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool)
+{
+	assert(rewards.size() == _numColumns);
+
+	step(rewards.data(), 1, sparsity, gamma, subIterSettle, subIterMeasure, leak,
+		gateFeedForwardAlpha, gateLateralAlpha, gateThresholdAlpha,
+		qAlpha, actionAlpha, actionDeriveIterations, actionDeriveAlpha, gammaLambda,
+		explorationStdDev, explorationBreak,
+		averageSurpiseDecay, surpriseLearnFactor, generator, pool);
+}
+
+void SDRRLBatch::step(const float* pRewards, int rewardStride, float sparsity, float gamma,
+	int subIterSettle, int subIterMeasure, float leak,
+	float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+	float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+	float explorationStdDev, float explorationBreak,
+	float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool)
+{
+	detachWeights();
+
+	if (_sparseInputs)
+		sys::parallelFor(pool, _numWeightSets * _numCells, [&](int i) {
+			computeOverlaps(i / _numCells, i % _numCells);
+		});
+
+	sys::parallelFor(pool, _numColumns, [&](int c) {
+		if (_sparseInputs)
+			activateSparse(c, subIterSettle, subIterMeasure, leak);
+		else
+			activate(c, subIterSettle, subIterMeasure, leak);
+
+		deriveActions(c, actionDeriveIterations, actionDeriveAlpha);
+	});
+
+	// Exploration, in column order so the generator is used exactly as by separate SDRRLs
+	const int numHalfActions = _numActions / 2;
+
+	for (int c = 0; c < _numColumns; c++) {
+		float* pExploratory = &_exploratoryActions[c * _numActions];
+
+		ActionOptimizer::explore(&_actionValues[c * _numActions], pExploratory, _numActions, 0.0f, 1.0f, explorationStdDev, explorationBreak, generator);
+
+		for (int i = 0; i < numHalfActions; i++)
+			pExploratory[i + numHalfActions] = 1.0f - pExploratory[i];
+	}
+
+	_traceStep++;
+
+	if (_numWeightSets == _numColumns) {
+		sys::parallelFor(pool, _numColumns, [&](int c) {
+			learn(c, pRewards[c * rewardStride], sparsity, gamma,
+				gateFeedForwardAlpha, gateLateralAlpha, gateThresholdAlpha,
+				qAlpha, actionAlpha, gammaLambda,
+				averageSurpiseDecay, surpriseLearnFactor);
+		});
+	}
+	else {
+		sys::parallelFor(pool, _numColumns, [&](int c) {
+			evaluate(c, pRewards[c * rewardStride], gamma, averageSurpiseDecay);
+		});
+
+		sys::parallelFor(pool, _numWeightSets * _numCells, [&](int i) {
+			learnShared(i / _numCells, i % _numCells, sparsity,
+				gateFeedForwardAlpha, gateLateralAlpha, gateThresholdAlpha,
+				qAlpha, actionAlpha, gammaLambda);
+		});
+	}
+}
+
+void SDRRLBatch::act(int subIterSettle, int subIterMeasure, float leak, int actionDeriveIterations, float actionDeriveAlpha, sys::ThreadPool* pool) {
+	if (_sparseInputs)
+		sys::parallelFor(pool, _numWeightSets * _numCells, [&](int i) {
+			computeOverlaps(i / _numCells, i % _numCells);
+		});
+
+	sys::parallelFor(pool, _numColumns, [&](int c) {
+		if (_sparseInputs)
+			activateSparse(c, subIterSettle, subIterMeasure, leak);
+		else
+			activate(c, subIterSettle, subIterMeasure, leak);
+
+		deriveActions(c, actionDeriveIterations, actionDeriveAlpha);
+
+		for (int i = 0; i < _numActions; i++)
+			_exploratoryActions[c * _numActions + i] = _actionValues[c * _numActions + i];
+	});
+}
+
+void SDRRLBatch::freeze() {
+	std::vector<float>().swap(_actionTraces);
+	std::vector<float>().swap(_qTraces);
+	std::vector<char>().swap(_tracesLive);
+	std::vector<int>().swap(_traceStamps);
+	std::vector<float>().swap(_prevValues);
+	std::vector<float>().swap(_averageSurprises);
+}
+
+void SDRRLBatch::copyState(const SDRRLBatch &other) {
+	assert(other._numColumns == _numColumns && other._maxStates == _maxStates && other._numActions == _numActions && other._numCells == _numCells);
+
+	_inputs = other._inputs;
+	_reconstructionErrors = other._reconstructionErrors;
+
+	_activations = other._activations;
+	_spikes = other._spikes;
+	_spikesPrev = other._spikesPrev;
+	_cellStates = other._cellStates;
+	_actionStates = other._actionStates;
+
+	_actionValues = other._actionValues;
+	_exploratoryActions = other._exploratoryActions;
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "ActionOptimizer.h"
+
+#include <system/ThreadPool.h>
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cmath>
+
+namespace deep {
+	// A whole layer of SDRRL columns in contiguous arrays. Every column has the same number of cells and actions, and at most
+	// maxStates states. Weights are stored [column][cell][state/action/cell], so one column's cells form a small dense matrix.
+	// Per column the result is identical to running an SDRRL with the same initialization.
+	// Copies share the weights until one of them learns or is initialized, which then clones them (copy on write).
+	// Columns can also share weights within the batch: column c then uses weight set c % numWeightSets, for instance one set
+	// per column of a controller and one column per agent running it. Such columns keep their own state and traces, and
+	// their updates are averaged and applied once per step. Separate batches only share weights as copies or through createShared,
+	// until one of them learns, so separate CSRL, Agent or QPRSDR instances never learn together (CSRLBatch runs many agents on one)
+	class SDRRLBatch {
+	public:
+		// Lightweight handle to one column, only valid as long as the batch is not recreated
+		class ColumnView {
+		private:
+			SDRRLBatch* _pBatch;
+			int _column;
+
+		public:
+			ColumnView(SDRRLBatch* pBatch, int column)
+				: _pBatch(pBatch), _column(column)
+			{}
+
+			void setState(int index, float value) {
+				_pBatch->setState(_column, index, value);
+			}
+
+			float getAction(int index) const {
+				return _pBatch->getAction(_column, index);
+			}
+
+			float getCellState(int index) const {
+				return _pBatch->getCellState(_column, index);
+			}
+
+			int getNumStates() const {
+				return _pBatch->getNumStates(_column);
+			}
+		};
+
+		// Everything learning changes
+		struct Weights {
+			// [weight set][cell][state]
+			std::vector<float> _feedForwardWeights;
+
+			// [weight set][cell][cell]
+			std::vector<float> _lateralWeights;
+
+			// [weight set][cell][action]
+			std::vector<float> _actionWeights;
+
+			// [weight set][cell]
+			std::vector<float> _qWeights;
+			std::vector<float> _thresholds;
+		};
+
+	private:
+		int _numColumns;
+		int _maxStates;
+		int _numActions;
+		int _numCells;
+		int _numWeightSets;
+
+		// Per column
+		std::vector<int> _numStates;
+		std::vector<float> _prevValues;
+		std::vector<float> _averageSurprises;
+		std::vector<float> _tdErrors;
+
+		// [column][state]
+		std::vector<float> _inputs;
+		std::vector<float> _reconstructionErrors;
+
+		std::shared_ptr<Weights> _weights;
+
+		// [column][cell][action]
+		std::vector<float> _actionTraces;
+
+		// [column][cell]
+		std::vector<float> _qTraces;
+		std::vector<float> _activations;
+		std::vector<float> _spikes;
+		std::vector<float> _spikesPrev;
+		std::vector<float> _cellStates;
+		std::vector<float> _actionStates;
+		std::vector<float> _drives;
+
+		// Whether the action and Q traces of a cell are maintained, and the step they were last, see _sparseTraces
+		std::vector<char> _tracesLive;
+		std::vector<int> _traceStamps;
+
+		// [weight set][cell][cell], found once per step for all columns using the set
+		std::vector<float> _overlaps;
+
+		// [column][state]
+		std::vector<int> _activeInputs;
+
+		// [column][action]
+		std::vector<float> _actionValues;
+		std::vector<float> _exploratoryActions;
+
+		// [column]
+		std::vector<ActionOptimizer> _actionOptimizers;
+
+		// Number of steps so far
+		int _traceStep;
+
+		// Clones the weights if another batch still shares them
+		void detachWeights();
+
+		// Settle, measure and final reconstruction
+		void activate(int column, int subIterSettle, int subIterMeasure, float leak);
+
+		// Overlaps of the feed forward weights of a cell with those of all cells of its weight set, for activateSparse
+		void computeOverlaps(int weightSet, int cell);
+
+		// Same settling without the per iteration reconstruction, see _sparseInputs
+		void activateSparse(int column, int subIterSettle, int subIterMeasure, float leak);
+
+		// Whether the traces of a cell are to be maintained this step. A dropped cell that became active catches up on the
+		// trace decay it missed
+		bool reviveTraces(int column, int cell, float gammaLambda);
+
+		// Drops the cell once all its traces are below _traceEpsilon
+		void checkTraces(int column, int cell);
+
+		// Gradient steps on the actions towards a higher Q
+		void deriveActions(int column, int actionDeriveIterations, float actionDeriveAlpha);
+
+		// Q of the exploratory actions, TD error and all weight updates of a column with its own weights
+		void learn(int column, float reward, float sparsity, float gamma,
+			float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+			float qAlpha, float actionAlpha, float gammaLambda,
+			float averageSurpiseDecay, float surpriseLearnFactor);
+
+		// With shared weights, learning is split in two passes. The first finds the Q and TD error of each column
+		void evaluate(int column, float reward, float gamma, float averageSurpiseDecay);
+
+		// The second updates one cell of a weight set by the average over its columns, and the traces of those columns
+		void learnShared(int weightSet, int cell, float sparsity,
+			float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+			float qAlpha, float actionAlpha, float gammaLambda);
+
+		int getWeightSet(int column) const {
+			return column % _numWeightSets;
+		}
+
+		// Column c is rewarded with pRewards[c * rewardStride]
+		void step(const float* pRewards, int rewardStride, float sparsity, float gamma,
+			int subIterSettle, int subIterMeasure, float leak,
+			float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+			float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+			float explorationStdDev, float explorationBreak,
+			float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool);
+
+	public:
+		// Settle on the non-zero inputs only. The inputs do not change while a column settles, so their drive on each cell is
+		// found once per step from the non-zero ones, and the reconstruction of a spike pattern reaches the cells through the
+		// overlaps of their weights. Iterations then cost cells * spikes instead of cells * states, and the reconstruction error
+		// is only formed once at the end. Equal to the dense settling up to rounding
+		bool _sparseInputs;
+
+		// Starts of the action derivation and the gradient norm below which it stops early, see ActionOptimizer::derive.
+		// The defaults (1 and 0) derive exactly as SDRRL always did
+		int _actionDeriveStarts;
+		float _actionDeriveMinGradient;
+
+		// Per column and cell as SDRRL::_sparseTraces. With shared weights, the dropped columns of a cell also leave out
+		// their trace terms from its averaged update
+		bool _sparseTraces;
+		float _traceEpsilon;
+
+		static float sigmoid(float x) {
+			return 1.0f / (1.0f + std::exp(-x));
+		}
+
+		SDRRLBatch()
+			: _numColumns(0), _maxStates(0), _numActions(0), _numCells(0), _numWeightSets(0), _traceStep(0), _sparseInputs(false), _actionDeriveStarts(1), _actionDeriveMinGradient(0.0f),
+			_sparseTraces(false), _traceEpsilon(0.0001f)
+		{}
+
+		// Allocates all columns, initColumn then sets up each one. numWeightSets must divide numColumns, by default
+		// (numWeightSets < 0) every column has its own weights
+		void create(int numColumns, int maxStates, int numActions, int numCells, int numWeightSets = -1);
+
+		// One copy of every column of model per copy, sharing the model's weights: column c uses the weights of model column
+		// c % model.getNumColumns(). The model must have a weight set per column. State and traces start out cleared
+		void createShared(const SDRRLBatch &model, int numCopies);
+
+		// Draws the weights of the column's weight set in the same order as SDRRL::createRandom, and sets the number of states
+		// of all columns using that set. With shared weights only the first numWeightSets columns need to be initialized
+		void initColumn(int column, int numStates, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator);
+
+		// Steps every column with the same parameters. Exploration draws from the generator column by column, in order,
+		// the rest runs on the pool (serially when it is null)
+		void simStep(float reward, float sparsity, float gamma,
+			int subIterSettle, int subIterMeasure, float leak,
+			float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+			float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+			float explorationStdDev, float explorationBreak,
+			float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool = nullptr);
+
+		// Same with one reward per column, as when every column is a separate agent
+		void simStep(const std::vector<float> &rewards, float sparsity, float gamma,
+			int subIterSettle, int subIterMeasure, float leak,
+			float gateFeedForwardAlpha, float gateLateralAlpha, float gateThresholdAlpha,
+			float qAlpha, float actionAlpha, int actionDeriveIterations, float actionDeriveAlpha, float gammaLambda,
+			float explorationStdDev, float explorationBreak,
+			float averageSurpiseDecay, float surpriseLearnFactor, std::mt19937 &generator, sys::ThreadPool* pool = nullptr);
+
+		// Inference only: settles the columns and derives actions, which are output as they are. No exploration and no learning
+		void act(int subIterSettle, int subIterMeasure, float leak, int actionDeriveIterations, float actionDeriveAlpha, sys::ThreadPool* pool = nullptr);
+
+		// Releases the traces and the TD state, after which only act may be used
+		void freeze();
+
+		// Copies the per step state (inputs, spikes, cell states and actions) of a batch with the same shape, keeping the weights
+		void copyState(const SDRRLBatch &other);
+
+		ColumnView getColumn(int column) {
+			return ColumnView(this, column);
+		}
+
+		void setState(int column, int index, float value) {
+			_inputs[column * _maxStates + index] = value;
+		}
+
+		float getAction(int column, int index) const {
+			return _exploratoryActions[column * _numActions + index];
+		}
+
+		float getCellState(int column, int index) const {
+			return _cellStates[column * _numCells + index];
+		}
+
+		int getNumColumns() const {
+			return _numColumns;
+		}
+
+		int getNumStates(int column) const {
+			return _numStates[column];
+		}
+
+		// Including the complementary half
+		int getNumActions() const {
+			return _numActions;
+		}
+
+		int getNumCells() const {
+			return _numCells;
+		}
+
+		int getNumWeightSets() const {
+			return _numWeightSets;
+		}
+	};
+}
\ No newline at end of file
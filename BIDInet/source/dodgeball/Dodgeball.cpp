@@ -0,0 +1,131 @@
+#include "Dodgeball.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Dodgeball::reset(int numBalls, std::mt19937 &generator) {
+	_balls.resize(numBalls);
+
+	std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
+
+	for (int i = 0; i < _balls.size(); i++) {
+		_balls[i]._x = dist01(generator);
+		_balls[i]._y = dist01(generator);
+
+		_balls[i]._velocityX = dist01(generator) * 2.0f - 1.0f;
+		_balls[i]._velocityY = dist01(generator) * 2.0f - 1.0f;
+
+		float scale = _ballSpeed / std::sqrt(_balls[i]._velocityX * _balls[i]._velocityX + _balls[i]._velocityY * _balls[i]._velocityY);
+
+		_balls[i]._velocityX *= scale;
+		_balls[i]._velocityY *= scale;
+	}
+
+	_agentX = 0.5f;
+	_agentY = 0.5f;
+}
+
+void Dodgeball::step(float actionX, float actionY) {
+	_agentX += _agentSpeed * actionX;
+	_agentY += _agentSpeed * actionY;
+
+	_agentX = std::min(0.5f + _agentFieldRadius - _agentRadius, std::max(0.5f - _agentFieldRadius + _agentRadius, _agentX));
+	_agentY = std::min(0.5f + _agentFieldRadius - _agentRadius, std::max(0.5f - _agentFieldRadius + _agentRadius, _agentY));
+
+	float lower = 0.5f - _agentFieldRadius + _ballRadius;
+	float upper = 0.5f + _agentFieldRadius - _ballRadius;
+
+	for (int i = 0; i < _balls.size(); i++) {
+		float deltaX = _agentX - _balls[i]._x;
+		float deltaY = _agentY - _balls[i]._y;
+
+		float dist = std::sqrt(deltaX * deltaX + deltaY * deltaY);
+
+		_balls[i]._velocityX += -_balls[i]._velocityX * _ballVelocityDecay + deltaX / dist * _attraction;
+		_balls[i]._velocityY += -_balls[i]._velocityY * _ballVelocityDecay + deltaY / dist * _attraction;
+
+		_balls[i]._x += _balls[i]._velocityX;
+		_balls[i]._y += _balls[i]._velocityY;
+
+		if (_balls[i]._x < lower) {
+			_balls[i]._x = lower;
+			_balls[i]._velocityX *= -1.0f;
+		}
+		else if (_balls[i]._x > upper) {
+			_balls[i]._x = upper;
+			_balls[i]._velocityX *= -1.0f;
+		}
+
+		if (_balls[i]._y < lower) {
+			_balls[i]._y = lower;
+			_balls[i]._velocityY *= -1.0f;
+		}
+		else if (_balls[i]._y > upper) {
+			_balls[i]._y = upper;
+			_balls[i]._velocityY *= -1.0f;
+		}
+	}
+}
+
+float Dodgeball::getReward() const {
+	float reward = 0.5f;
+
+	for (int i = 0; i < _balls.size(); i++) {
+		float deltaX = _balls[i]._x - _agentX;
+		float deltaY = _balls[i]._y - _agentY;
+
+		reward += -std::sqrt(deltaX * deltaX + deltaY * deltaY);
+	}
+
+	return reward;
+}
+
+void Dodgeball::fillEllipse(float* observation, int width, int height, float centerX, float centerY, float radiusX, float radiusY, float value) {
+	int lowerX = std::max(0, static_cast<int>(std::floor(centerX - radiusX)));
+	int upperX = std::min(width - 1, static_cast<int>(std::ceil(centerX + radiusX)));
+	int lowerY = std::max(0, static_cast<int>(std::floor(centerY - radiusY)));
+	int upperY = std::min(height - 1, static_cast<int>(std::ceil(centerY + radiusY)));
+
+	float radiusXInv = 1.0f / radiusX;
+	float radiusYInv = 1.0f / radiusY;
+
+	for (int y = lowerY; y <= upperY; y++) {
+		float dy = (y + 0.5f - centerY) * radiusYInv;
+
+		for (int x = lowerX; x <= upperX; x++) {
+			float dx = (x + 0.5f - centerX) * radiusXInv;
+
+			if (dx * dx + dy * dy <= 1.0f)
+				observation[x + y * width] = value;
+		}
+	}
+}
+
+void Dodgeball::render(float* observation, int width, int height) const {
+	std::fill(observation, observation + width * height, 0.0f);
+
+	// Field outline, drawn outside the field like an SFML outline
+	float thickness = width * _agentFieldOutlineWidth;
+
+	float innerLowerX = (0.5f - _agentFieldRadius) * width;
+	float innerUpperX = (0.5f + _agentFieldRadius) * width;
+	float innerLowerY = (0.5f - _agentFieldRadius) * height;
+	float innerUpperY = (0.5f + _agentFieldRadius) * height;
+
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++) {
+			float px = x + 0.5f;
+			float py = y + 0.5f;
+
+			bool inOuter = px >= innerLowerX - thickness && px <= innerUpperX + thickness && py >= innerLowerY - thickness && py <= innerUpperY + thickness;
+			bool inInner = px > innerLowerX && px < innerUpperX && py > innerLowerY && py < innerUpperY;
+
+			if (inOuter && !inInner)
+				observation[x + y * width] = 1.0f;
+		}
+
+	for (int i = 0; i < _balls.size(); i++)
+		fillEllipse(observation, width, height, _balls[i]._x * width, height - _balls[i]._y * height, _ballRadius * width, _ballRadius * height, 0.5f);
+
+	fillEllipse(observation, width, height, _agentX * width, height - _agentY * height, _agentRadius * width, _agentRadius * height, 1.0f);
+}
\ No newline at end of file
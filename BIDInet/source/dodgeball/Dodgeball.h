@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <random>
+
+// Dodgeball game without a window or GPU. Positions are in [0, 1] with y pointing up
+class Dodgeball {
+public:
+	struct Ball {
+		float _x, _y;
+		float _velocityX, _velocityY;
+	};
+
+private:
+	std::vector<Ball> _balls;
+
+	float _agentX, _agentY;
+
+	// Sets every pixel whose center lies in the ellipse, like an unsmoothed SFML circle
+	static void fillEllipse(float* observation, int width, int height, float centerX, float centerY, float radiusX, float radiusY, float value);
+
+public:
+	float _ballSpeed;
+	float _ballRadius;
+	float _agentRadius;
+	float _agentSpeed;
+	float _agentFieldRadius;
+	float _agentFieldOutlineWidth;
+	float _attraction;
+	float _ballVelocityDecay;
+
+	Dodgeball()
+		: _agentX(0.5f), _agentY(0.5f),
+		_ballSpeed(0.02f),
+		_ballRadius(0.12f),
+		_agentRadius(0.05f),
+		_agentSpeed(0.03f),
+		_agentFieldRadius(0.3f),
+		_agentFieldOutlineWidth(0.005f),
+		_attraction(-0.0005f),
+		_ballVelocityDecay(0.1f)
+	{}
+
+	void reset(int numBalls, std::mt19937 &generator);
+
+	// Moves the agent by action * _agentSpeed (actions in [-1, 1]), then advances the balls
+	void step(float actionX, float actionY);
+
+	float getReward() const;
+
+	// Rasterizes the scene into width * height floats, top row first: 1 for the agent and field outline, 0.5 for balls, 0 otherwise
+	void render(float* observation, int width, int height) const;
+
+	int getNumBalls() const {
+		return _balls.size();
+	}
+
+	const Ball &getBall(int index) const {
+		return _balls[index];
+	}
+
+	float getAgentX() const {
+		return _agentX;
+	}
+
+	float getAgentY() const {
+		return _agentY;
+	}
+};
\ No newline at end of file
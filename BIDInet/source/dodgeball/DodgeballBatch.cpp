@@ -0,0 +1,37 @@
+#include "DodgeballBatch.h"
+
+void DodgeballBatch::create(int numInstances, int numBalls, int width, int height, std::mt19937 &generator) {
+	_width = width;
+	_height = height;
+
+	_instances.resize(numInstances);
+
+	_observations.assign(numInstances * width * height, 0.0f);
+	_rewards.assign(numInstances, 0.0f);
+
+	for (int i = 0; i < _instances.size(); i++) {
+		_instances[i].reset(numBalls, generator);
+
+		observe(i);
+	}
+}
+
+void DodgeballBatch::observe(int index) {
+	_instances[index].render(&_observations[index * _width * _height], _width, _height);
+
+	_rewards[index] = _instances[index].getReward();
+}
+
+void DodgeballBatch::step(const std::vector<float> &actions) {
+	sys::parallelFor(_threadPool.get(), _instances.size(), [&](int i) {
+		_instances[i].step(actions[i * 2 + 0], actions[i * 2 + 1]);
+
+		observe(i);
+	});
+}
+
+void DodgeballBatch::reset(int index, int numBalls, std::mt19937 &generator) {
+	_instances[index].reset(numBalls, generator);
+
+	observe(index);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Dodgeball.h"
+
+#include <system/ThreadPool.h>
+
+#include <memory>
+
+// Independent Dodgeball instances stepped in lockstep. Observations of all instances live in one buffer
+class DodgeballBatch {
+private:
+	std::vector<Dodgeball> _instances;
+
+	std::vector<float> _observations;
+	std::vector<float> _rewards;
+
+	int _width, _height;
+
+	std::shared_ptr<sys::ThreadPool> _threadPool;
+
+	void observe(int index);
+
+public:
+	DodgeballBatch()
+		: _width(0), _height(0)
+	{}
+
+	void create(int numInstances, int numBalls, int width, int height, std::mt19937 &generator);
+
+	void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+		_threadPool = threadPool;
+	}
+
+	// Two actions (x, y) per instance. Observations and rewards are refreshed afterwards
+	void step(const std::vector<float> &actions);
+
+	void reset(int index, int numBalls, std::mt19937 &generator);
+
+	int getNumInstances() const {
+		return _instances.size();
+	}
+
+	int getObservationSize() const {
+		return _width * _height;
+	}
+
+	const float* getObservation(int index) const {
+		return &_observations[index * _width * _height];
+	}
+
+	const std::vector<float> &getObservations() const {
+		return _observations;
+	}
+
+	float getReward(int index) const {
+		return _rewards[index];
+	}
+
+	Dodgeball &getInstance(int index) {
+		return _instances[index];
+	}
+
+	const Dodgeball &getInstance(int index) const {
+		return _instances[index];
+	}
+};
\ No newline at end of file
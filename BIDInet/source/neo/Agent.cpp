@@ -1,284 +1,451 @@
-#include "Agent.h"
-
-#include <algorithm>
-
-using namespace neo;
-
-void Agent::createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
-	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
-
-	_layerDescs = layerDescs;
-
-	_layers.resize(_layerDescs.size());
-
-	int widthPrev = inputWidth;
-	int heightPrev = inputHeight;
-
-	for (int l = 0; l < _layerDescs.size(); l++) {
-		_layers[l]._sdr.createRandom(widthPrev, heightPrev, _layerDescs[l]._width, _layerDescs[l]._height, _layerDescs[l]._receptiveRadius, _layerDescs[l]._recurrentRadius, _layerDescs[l]._lateralRadius, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
-
-		_layers[l]._predictionNodes.resize(_layerDescs[l]._width * _layerDescs[l]._height);
-
-		int feedBackSize = std::pow(_layerDescs[l]._feedBackRadius * 2 + 1, 2);
-		int predictiveSize = std::pow(_layerDescs[l]._predictiveRadius * 2 + 1, 2);
-
-		float hiddenToNextHiddenWidth = 1.0f;
-		float hiddenToNextHiddenHeight = 1.0f;
-
-		if (l < _layers.size() - 1) {
-			hiddenToNextHiddenWidth = static_cast<float>(_layerDescs[l + 1]._width) / static_cast<float>(_layerDescs[l]._width);
-			hiddenToNextHiddenHeight = static_cast<float>(_layerDescs[l + 1]._height) / static_cast<float>(_layerDescs[l]._height);
-		}
-
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			p._bias._weight = weightDist(generator);
-
-			int hx = pi % _layerDescs[l]._width;
-			int hy = pi / _layerDescs[l]._width;
-
-			// Feed Back
-			if (l < _layers.size() - 1) {
-				p._feedBackConnections.reserve(feedBackSize);
-
-				int centerX = std::round(hx * hiddenToNextHiddenWidth);
-				int centerY = std::round(hy * hiddenToNextHiddenHeight);
-
-				for (int dx = -_layerDescs[l]._feedBackRadius; dx <= _layerDescs[l]._feedBackRadius; dx++)
-					for (int dy = -_layerDescs[l]._feedBackRadius; dy <= _layerDescs[l]._feedBackRadius; dy++) {
-						int hox = centerX + dx;
-						int hoy = centerY + dy;
-
-						if (hox >= 0 && hox < _layerDescs[l + 1]._width && hoy >= 0 && hoy < _layerDescs[l + 1]._height) {
-							int hio = hox + hoy * _layerDescs[l + 1]._width;
-
-							Connection c;
-
-							c._weight = weightDist(generator);
-							c._index = hio;
-
-							p._feedBackConnections.push_back(c);
-						}
-					}
-
-				p._feedBackConnections.shrink_to_fit();
-			}
-
-			// Predictive
-			p._predictiveConnections.reserve(feedBackSize);
-
-			for (int dx = -_layerDescs[l]._predictiveRadius; dx <= _layerDescs[l]._predictiveRadius; dx++)
-				for (int dy = -_layerDescs[l]._predictiveRadius; dy <= _layerDescs[l]._predictiveRadius; dy++) {
-					int hox = hx + dx;
-					int hoy = hy + dy;
-
-					if (hox >= 0 && hox < _layerDescs[l]._width && hoy >= 0 && hoy < _layerDescs[l]._height) {
-						int hio = hox + hoy * _layerDescs[l]._width;
-
-						Connection c;
-
-						c._weight = weightDist(generator);
-						c._index = hio;
-
-						p._predictiveConnections.push_back(c);
-					}
-				}
-
-			p._predictiveConnections.shrink_to_fit();
-
-			p._column.createRandom(p._predictiveConnections.size() + p._feedBackConnections.size() * 2, _numColumnActions, _layerDescs[l]._cellsPerColumn, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
-		}
-
-		widthPrev = _layerDescs[l]._width;
-		heightPrev = _layerDescs[l]._height;
-	}
-
-	_inputPredictionNodes.resize(inputWidth * inputHeight);
-
-	float inputToNextHiddenWidth = static_cast<float>(_layerDescs.front()._width) / static_cast<float>(inputWidth);
-	float inputToNextHiddenHeight = static_cast<float>(_layerDescs.front()._height) / static_cast<float>(inputHeight);
-
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		p._bias._weight = weightDist(generator);
-
-		int hx = pi % inputWidth;
-		int hy = pi / inputWidth;
-
-		int feedBackSize = std::pow(inputFeedBackRadius * 2 + 1, 2);
-
-		// Feed Back
-		p._feedBackConnections.reserve(feedBackSize);
-
-		int centerX = std::round(hx * inputToNextHiddenWidth);
-		int centerY = std::round(hy * inputToNextHiddenHeight);
-
-		for (int dx = -inputFeedBackRadius; dx <= inputFeedBackRadius; dx++)
-			for (int dy = -inputFeedBackRadius; dy <= inputFeedBackRadius; dy++) {
-				int hox = centerX + dx;
-				int hoy = centerY + dy;
-
-				if (hox >= 0 && hox < _layerDescs.front()._width && hoy >= 0 && hoy < _layerDescs.front()._height) {
-					int hio = hox + hoy * _layerDescs.front()._width;
-
-					Connection c;
-
-					c._weight = weightDist(generator);
-					c._index = hio;
-
-					p._feedBackConnections.push_back(c);
-				}
-			}
-
-		p._feedBackConnections.shrink_to_fit();
-
-		p._column.createRandom(p._feedBackConnections.size() * 2, _numColumnActions, _cellsPerColumn, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
-	}
-}
-
-void Agent::simStep(float reward, std::mt19937 &generator, bool learn) {
-	// Feature extraction
-	for (int l = 0; l < _layers.size(); l++) {
-		_layers[l]._sdr.activate(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, generator);
-
-		// Set inputs for next layer if there is one
-		if (l < _layers.size() - 1) {
-			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
-				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i) * _layers[l]._predictionNodes[i]._column.getAction(_attention));
-			}
-		}
-	}
-
-	// Prediction
-	for (int l = _layers.size() - 1; l >= 0; l--) {
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			int colInputIndex = 0;
-
-			if (l < _layers.size() - 1) {
-				for (int ci = 0; ci < p._feedBackConnections.size(); ci++) {
-					p._column.setState(colInputIndex++, _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._column.getAction(_signal));
-					p._column.setState(colInputIndex++, _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state);
-				}
-			}
-
-			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-				p._column.setState(colInputIndex++, _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index));
-
-			// Update column
-			p._column.simStep(reward, _layerDescs[l]._columnSparsity, _layerDescs[l]._columnGamma,
-				_layerDescs[l]._columnIter, _layerDescs[l]._columnLeak,
-				_layerDescs[l]._columnFeedForwardAlpha, _layerDescs[l]._columnLateralAlpha, _layerDescs[l]._columnThresholdAlpha,
-				_layerDescs[l]._columnQAlpha, _layerDescs[l]._columnActionAlpha,
-				_layerDescs[l]._columnGammaLambda,
-				_layerDescs[l]._columnExplorationStdDev, _layerDescs[l]._columnExplorationBreakChance, generator);
-
-			// Learn
-			if (learn) {
-				float predictionError = p._column.getAction(_learnPrediction) * (_layers[l]._sdr.getHiddenState(pi) - p._statePrev);
-
-				if (l < _layers.size() - 1) {
-					for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-						p._feedBackConnections[ci]._weight += _layerDescs[l]._learnFeedBack * predictionError * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
-				}
-
-				// Predictive
-				for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-					p._predictiveConnections[ci]._weight += _layerDescs[l]._learnPrediction * predictionError * _layers[l]._sdr.getHiddenStatePrev(p._predictiveConnections[ci]._index);
-			}
-
-			float activation = 0.0f;
-
-			// Feed Back
-			if (l < _layers.size() - 1) {
-				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-					activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
-			}
-
-			// Predictive
-			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-				activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
-
-			p._activation = activation;
-
-			p._state = std::min(1.0f, std::max(0.0f, p._activation));
-		}
-	}
-
-	// Get first layer prediction
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		int colInputIndex = 0;
-
-		for (int ci = 0; ci < p._feedBackConnections.size(); ci++) {
-			p._column.setState(colInputIndex++, _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._column.getAction(_signal));
-			p._column.setState(colInputIndex++, _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state);
-		}
-
-		// Update column
-		p._column.simStep(reward, _columnSparsity, _columnGamma,
-			_columnIter, _columnLeak,
-			_columnFeedForwardAlpha, _columnLateralAlpha, _columnThresholdAlpha,
-			_columnQAlpha, _columnActionAlpha,
-			_columnGammaLambda,
-			_columnExplorationStdDev, _columnExplorationBreakChance, generator);
-
-		// Learn
-		if (learn) {
-			float predictionError = p._column.getAction(_learnPrediction) * (_layers.front()._sdr.getVisibleState(pi) - p._statePrev);
-
-			for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-				p._feedBackConnections[ci]._weight += _learnInputFeedBack * predictionError * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
-		}
-
-		float activation = 0.0f;
-
-		// Feed Back
-		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-			activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
-
-		p._activation = activation;
-
-		p._state = p._activation;
-	}
-
-	for (int l = 0; l < _layers.size(); l++) {
-		std::vector<float> rewards(_layers[l]._predictionNodes.size());
-
-		if (learn) {
-			for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-				PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
-
-				float error2 = predictionError * predictionError;
-
-				rewards[pi] = sigmoid(_layerDescs[l]._sdrSensitivity * (error2 - p._baseline));
-
-				p._baseline = (1.0f - _layerDescs[l]._sdrBaselineDecay) * p._baseline + _layerDescs[l]._sdrBaselineDecay * error2;
-			}
-
-			_layers[l]._sdr.learn(rewards, _layerDescs[l]._sdrLambda, _layerDescs[l]._learnFeedForward, _layerDescs[l]._learnRecurrent, _layerDescs[l]._learnLateral, _layerDescs[l]._sdrLearnThreshold, _layerDescs[l]._sdrSparsity, _layerDescs[l]._sdrWeightDecay, _layerDescs[l]._sdrMaxWeightDelta); //attentions[l], 
-		}
-
-		_layers[l]._sdr.stepEnd();
-
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			p._statePrev = p._state;
-			p._activationPrev = p._activation;
-		}
-	}
-
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		p._statePrev = p._state;
-		p._activationPrev = p._activation;
-	}
+#include "Agent.h"
+#include "AgentPolicy.h"
+
+#include <algorithm>
+
+using namespace neo;
+
+void Agent::createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
+	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
+
+	_layerDescs = layerDescs;
+
+	_layers.resize(_layerDescs.size());
+
+	int widthPrev = inputWidth;
+	int heightPrev = inputHeight;
+
+	for (int l = 0; l < _layerDescs.size(); l++) {
+		_layers[l]._sdr.createRandom(widthPrev, heightPrev, _layerDescs[l]._width, _layerDescs[l]._height, _layerDescs[l]._receptiveRadius, _layerDescs[l]._recurrentRadius, _layerDescs[l]._lateralRadius, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
+
+		_layers[l]._sdr._sparseTraces = _layerDescs[l]._sdrSparseTraces;
+		_layers[l]._sdr._traceEpsilon = _layerDescs[l]._sdrTraceEpsilon;
+
+		_layers[l]._predictionNodes.resize(_layerDescs[l]._width * _layerDescs[l]._height);
+
+		int feedBackSize = std::pow(_layerDescs[l]._feedBackRadius * 2 + 1, 2);
+		int predictiveSize = std::pow(_layerDescs[l]._predictiveRadius * 2 + 1, 2);
+
+		float hiddenToNextHiddenWidth = 1.0f;
+		float hiddenToNextHiddenHeight = 1.0f;
+
+		if (l < _layers.size() - 1) {
+			hiddenToNextHiddenWidth = static_cast<float>(_layerDescs[l + 1]._width) / static_cast<float>(_layerDescs[l]._width);
+			hiddenToNextHiddenHeight = static_cast<float>(_layerDescs[l + 1]._height) / static_cast<float>(_layerDescs[l]._height);
+		}
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			p._bias._weight = weightDist(generator);
+
+			int hx = pi % _layerDescs[l]._width;
+			int hy = pi / _layerDescs[l]._width;
+
+			// Feed Back
+			if (l < _layers.size() - 1) {
+				p._feedBackConnections.reserve(feedBackSize);
+
+				int centerX = std::round(hx * hiddenToNextHiddenWidth);
+				int centerY = std::round(hy * hiddenToNextHiddenHeight);
+
+				for (int dx = -_layerDescs[l]._feedBackRadius; dx <= _layerDescs[l]._feedBackRadius; dx++)
+					for (int dy = -_layerDescs[l]._feedBackRadius; dy <= _layerDescs[l]._feedBackRadius; dy++) {
+						int hox = centerX + dx;
+						int hoy = centerY + dy;
+
+						if (hox >= 0 && hox < _layerDescs[l + 1]._width && hoy >= 0 && hoy < _layerDescs[l + 1]._height) {
+							int hio = hox + hoy * _layerDescs[l + 1]._width;
+
+							Connection c;
+
+							c._weight = weightDist(generator);
+							c._index = hio;
+
+							p._feedBackConnections.push_back(c);
+						}
+					}
+
+				p._feedBackConnections.shrink_to_fit();
+			}
+
+			// Predictive
+			p._predictiveConnections.reserve(feedBackSize);
+
+			for (int dx = -_layerDescs[l]._predictiveRadius; dx <= _layerDescs[l]._predictiveRadius; dx++)
+				for (int dy = -_layerDescs[l]._predictiveRadius; dy <= _layerDescs[l]._predictiveRadius; dy++) {
+					int hox = hx + dx;
+					int hoy = hy + dy;
+
+					if (hox >= 0 && hox < _layerDescs[l]._width && hoy >= 0 && hoy < _layerDescs[l]._height) {
+						int hio = hox + hoy * _layerDescs[l]._width;
+
+						Connection c;
+
+						c._weight = weightDist(generator);
+						c._index = hio;
+
+						p._predictiveConnections.push_back(c);
+					}
+				}
+
+			p._predictiveConnections.shrink_to_fit();
+
+			p._column.createRandom(p._predictiveConnections.size() + p._feedBackConnections.size() * 2, _numColumnActions, _layerDescs[l]._cellsPerColumn, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
+		}
+
+		widthPrev = _layerDescs[l]._width;
+		heightPrev = _layerDescs[l]._height;
+	}
+
+	_inputPredictionNodes.resize(inputWidth * inputHeight);
+
+	float inputToNextHiddenWidth = static_cast<float>(_layerDescs.front()._width) / static_cast<float>(inputWidth);
+	float inputToNextHiddenHeight = static_cast<float>(_layerDescs.front()._height) / static_cast<float>(inputHeight);
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		p._bias._weight = weightDist(generator);
+
+		int hx = pi % inputWidth;
+		int hy = pi / inputWidth;
+
+		int feedBackSize = std::pow(inputFeedBackRadius * 2 + 1, 2);
+
+		// Feed Back
+		p._feedBackConnections.reserve(feedBackSize);
+
+		int centerX = std::round(hx * inputToNextHiddenWidth);
+		int centerY = std::round(hy * inputToNextHiddenHeight);
+
+		for (int dx = -inputFeedBackRadius; dx <= inputFeedBackRadius; dx++)
+			for (int dy = -inputFeedBackRadius; dy <= inputFeedBackRadius; dy++) {
+				int hox = centerX + dx;
+				int hoy = centerY + dy;
+
+				if (hox >= 0 && hox < _layerDescs.front()._width && hoy >= 0 && hoy < _layerDescs.front()._height) {
+					int hio = hox + hoy * _layerDescs.front()._width;
+
+					Connection c;
+
+					c._weight = weightDist(generator);
+					c._index = hio;
+
+					p._feedBackConnections.push_back(c);
+				}
+			}
+
+		p._feedBackConnections.shrink_to_fit();
+
+		p._column.createRandom(p._feedBackConnections.size() * 2, _numColumnActions, _cellsPerColumn, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
+	}
+}
+
+void Agent::forEachNode(int count, std::mt19937 &generator, const std::function<void(int, std::mt19937&)> &func) {
+	if (_threadPool == nullptr) {
+		for (int i = 0; i < count; i++)
+			func(i, generator);
+
+		return;
+	}
+
+	int numTasks = std::min(count, _threadPool->getNumThreads());
+
+	std::uniform_int_distribution<int> seedDist(0, 99999);
+
+	_taskGenerators.resize(numTasks);
+
+	for (int t = 0; t < numTasks; t++)
+		_taskGenerators[t].seed(seedDist(generator));
+
+	_threadPool->parallelFor(numTasks, [&](int t) {
+		int end = static_cast<long long>(t + 1) * count / numTasks;
+
+		for (int i = static_cast<long long>(t) * count / numTasks; i < end; i++)
+			func(i, _taskGenerators[t]);
+	});
+}
+
+void Agent::predict(int l, int pi, float reward, std::mt19937 &generator, bool learn) {
+	PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+	int colInputIndex = 0;
+
+	if (l < _layers.size() - 1) {
+		for (int ci = 0; ci < p._feedBackConnections.size(); ci++) {
+			p._column.setState(colInputIndex++, _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._column.getAction(_signal));
+			p._column.setState(colInputIndex++, _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state);
+		}
+	}
+
+	for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+		p._column.setState(colInputIndex++, _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index));
+
+	// Update column
+	p._column.simStep(reward, _layerDescs[l]._columnSparsity, _layerDescs[l]._columnGamma,
+		_layerDescs[l]._columnIter, _layerDescs[l]._columnLeak,
+		_layerDescs[l]._columnFeedForwardAlpha, _layerDescs[l]._columnLateralAlpha, _layerDescs[l]._columnThresholdAlpha,
+		_layerDescs[l]._columnQAlpha, _layerDescs[l]._columnActionAlpha,
+		_layerDescs[l]._columnGammaLambda,
+		_layerDescs[l]._columnExplorationStdDev, _layerDescs[l]._columnExplorationBreakChance, generator);
+
+	// Learn
+	if (learn) {
+		float predictionError = p._column.getAction(_learnPrediction) * (_layers[l]._sdr.getHiddenState(pi) - p._statePrev);
+
+		if (l < _layers.size() - 1) {
+			for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+				p._feedBackConnections[ci]._weight += _layerDescs[l]._learnFeedBack * predictionError * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
+		}
+
+		// Predictive
+		for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+			p._predictiveConnections[ci]._weight += _layerDescs[l]._learnPrediction * predictionError * _layers[l]._sdr.getHiddenStatePrev(p._predictiveConnections[ci]._index);
+	}
+
+	float activation = 0.0f;
+
+	// Feed Back
+	if (l < _layers.size() - 1) {
+		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+			activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
+	}
+
+	// Predictive
+	for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+		activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
+
+	p._activation = activation;
+
+	p._state = std::min(1.0f, std::max(0.0f, p._activation));
+}
+
+void Agent::predictInput(int pi, float reward, std::mt19937 &generator, bool learn) {
+	InputPredictionNode &p = _inputPredictionNodes[pi];
+
+	int colInputIndex = 0;
+
+	for (int ci = 0; ci < p._feedBackConnections.size(); ci++) {
+		p._column.setState(colInputIndex++, _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._column.getAction(_signal));
+		p._column.setState(colInputIndex++, _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state);
+	}
+
+	// Update column
+	p._column.simStep(reward, _columnSparsity, _columnGamma,
+		_columnIter, _columnLeak,
+		_columnFeedForwardAlpha, _columnLateralAlpha, _columnThresholdAlpha,
+		_columnQAlpha, _columnActionAlpha,
+		_columnGammaLambda,
+		_columnExplorationStdDev, _columnExplorationBreakChance, generator);
+
+	// Learn
+	if (learn) {
+		float predictionError = p._column.getAction(_learnPrediction) * (_layers.front()._sdr.getVisibleState(pi) - p._statePrev);
+
+		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+			p._feedBackConnections[ci]._weight += _learnInputFeedBack * predictionError * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
+	}
+
+	float activation = 0.0f;
+
+	// Feed Back
+	for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+		activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
+
+	p._activation = activation;
+
+	p._state = p._activation;
+}
+
+void Agent::simStep(float reward, std::mt19937 &generator, bool learn) {
+	if (_boundInputs != nullptr)
+		setInputs(_boundInputs);
+
+	// Feature extraction
+	for (int l = 0; l < _layers.size(); l++) {
+		_layers[l]._sdr.activate(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, generator);
+
+		// Set inputs for next layer if there is one
+		if (l < _layers.size() - 1) {
+			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
+				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i) * _layers[l]._predictionNodes[i]._column.getAction(_attention));
+			}
+		}
+	}
+
+	// Prediction, layer by layer. Nodes only read the layer above and this layer's SDR, so they are independent
+	for (int l = _layers.size() - 1; l >= 0; l--) {
+		forEachNode(_layers[l]._predictionNodes.size(), generator, [&](int pi, std::mt19937 &nodeGenerator) {
+			predict(l, pi, reward, nodeGenerator, learn);
+		});
+	}
+
+	// Get first layer prediction
+	forEachNode(_inputPredictionNodes.size(), generator, [&](int pi, std::mt19937 &nodeGenerator) {
+		predictInput(pi, reward, nodeGenerator, learn);
+	});
+
+	for (int l = 0; l < _layers.size(); l++) {
+		std::vector<float> rewards(_layers[l]._predictionNodes.size());
+
+		if (learn) {
+			for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+				PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
+
+				float error2 = predictionError * predictionError;
+
+				rewards[pi] = sigmoid(_layerDescs[l]._sdrSensitivity * (error2 - p._baseline));
+
+				p._baseline = (1.0f - _layerDescs[l]._sdrBaselineDecay) * p._baseline + _layerDescs[l]._sdrBaselineDecay * error2;
+			}
+
+			_layers[l]._sdr.learn(rewards, _layerDescs[l]._sdrLambda, _layerDescs[l]._learnFeedForward, _layerDescs[l]._learnRecurrent, _layerDescs[l]._learnLateral, _layerDescs[l]._sdrLearnThreshold, _layerDescs[l]._sdrSparsity, _layerDescs[l]._sdrWeightDecay, _layerDescs[l]._sdrMaxWeightDelta); //attentions[l], 
+		}
+
+		_layers[l]._sdr.stepEnd();
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			p._statePrev = p._state;
+			p._activationPrev = p._activation;
+		}
+	}
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		p._statePrev = p._state;
+		p._activationPrev = p._activation;
+	}
+}
+
+void Agent::exportPolicy(AgentPolicy &policy) const {
+	policy._layerDescs = _layerDescs;
+
+	policy._columnIter = _columnIter;
+	policy._columnLeak = _columnLeak;
+
+	std::shared_ptr<AgentPolicy::Weights> weights = std::make_shared<AgentPolicy::Weights>();
+
+	weights->_layers.resize(_layers.size());
+
+	policy._layers.assign(_layers.size(), AgentPolicy::Layer());
+
+	for (int l = 0; l < _layers.size(); l++) {
+		const SparseCoder &sdr = _layers[l]._sdr;
+
+		AgentPolicy::LayerWeights &layerWeights = weights->_layers[l];
+
+		for (int hi = 0; hi < sdr.getNumHidden(); hi++) {
+			const SparseCoder::HiddenNode &h = sdr.getHiddenNode(hi);
+
+			for (int ci = 0; ci < h._feedForwardConnections.size(); ci++)
+				layerWeights._feedForward.add(h._feedForwardConnections[ci]._index, h._feedForwardConnections[ci]._weight);
+
+			for (int ci = 0; ci < h._recurrentConnections.size(); ci++)
+				layerWeights._recurrent.add(h._recurrentConnections[ci]._index, h._recurrentConnections[ci]._weight);
+
+			for (int ci = 0; ci < h._lateralConnections.size(); ci++)
+				layerWeights._lateral.add(h._lateralConnections[ci]._index, h._lateralConnections[ci]._weight);
+
+			layerWeights._feedForward.next();
+			layerWeights._recurrent.next();
+			layerWeights._lateral.next();
+
+			layerWeights._thresholds.push_back(h._threshold);
+		}
+
+		layerWeights._columns.resize(_layers[l]._predictionNodes.size());
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			const PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+				layerWeights._feedBackConnections.add(p._feedBackConnections[ci]._index, p._feedBackConnections[ci]._weight);
+
+			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+				layerWeights._predictiveConnections.add(p._predictiveConnections[ci]._index, p._predictiveConnections[ci]._weight);
+
+			layerWeights._feedBackConnections.next();
+			layerWeights._predictiveConnections.next();
+
+			AgentPolicy::exportColumnWeights(p._column, layerWeights._columns[pi]);
+		}
+	}
+
+	weights->_inputColumns.resize(_inputPredictionNodes.size());
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		const InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+			weights->_inputFeedBackConnections.add(p._feedBackConnections[ci]._index, p._feedBackConnections[ci]._weight);
+
+		weights->_inputFeedBackConnections.next();
+
+		AgentPolicy::exportColumnWeights(p._column, weights->_inputColumns[pi]);
+	}
+
+	policy._weights = weights;
+
+	exportState(policy);
+}
+
+void Agent::exportState(AgentPolicy &policy) const {
+	for (int l = 0; l < _layers.size(); l++) {
+		const SparseCoder &sdr = _layers[l]._sdr;
+
+		AgentPolicy::Layer &layer = policy._layers[l];
+		AgentPolicy::Encoder &encoder = layer._sdr;
+
+		encoder._visibleInputs.resize(sdr.getNumVisible());
+		encoder._visibleRecons.resize(sdr.getNumVisible());
+		encoder._visibleErrors.resize(sdr.getNumVisible());
+
+		for (int vi = 0; vi < sdr.getNumVisible(); vi++) {
+			encoder._visibleInputs[vi] = sdr.getVisibleState(vi);
+			encoder._visibleRecons[vi] = sdr.getVisibleRecon(vi);
+		}
+
+		encoder._activations.resize(sdr.getNumHidden());
+		encoder._spikes.resize(sdr.getNumHidden());
+		encoder._spikesPrev.resize(sdr.getNumHidden());
+		encoder._states.resize(sdr.getNumHidden());
+		encoder._statesPrev.resize(sdr.getNumHidden());
+		encoder._hiddenRecons.resize(sdr.getNumHidden());
+		encoder._hiddenErrors.resize(sdr.getNumHidden());
+
+		for (int hi = 0; hi < sdr.getNumHidden(); hi++) {
+			const SparseCoder::HiddenNode &h = sdr.getHiddenNode(hi);
+
+			encoder._activations[hi] = h._activation;
+			encoder._spikes[hi] = h._spike;
+			encoder._spikesPrev[hi] = h._spikePrev;
+			encoder._states[hi] = h._state;
+			encoder._statesPrev[hi] = h._statePrev;
+			encoder._hiddenRecons[hi] = h._reconstruction;
+		}
+
+		layer._predictions.resize(_layers[l]._predictionNodes.size());
+		layer._columns.resize(_layers[l]._predictionNodes.size());
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			layer._predictions[pi] = _layers[l]._predictionNodes[pi]._state;
+
+			AgentPolicy::exportColumnState(_layers[l]._predictionNodes[pi]._column, layer._columns[pi]);
+		}
+	}
+
+	policy._inputPredictions.resize(_inputPredictionNodes.size());
+	policy._inputColumns.resize(_inputPredictionNodes.size());
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		policy._inputPredictions[pi] = _inputPredictionNodes[pi]._state;
+
+		AgentPolicy::exportColumnState(_inputPredictionNodes[pi]._column, policy._inputColumns[pi]);
+	}
 }
\ No newline at end of file
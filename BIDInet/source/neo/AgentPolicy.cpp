@@ -0,0 +1,300 @@
+#include "AgentPolicy.h"
+
+#include <algorithm>
+
+using namespace neo;
+
+void AgentPolicy::Encoder::activate(const LayerWeights &weights, int iter, float leak) {
+	const Connections &feedForward = weights._feedForward;
+	const Connections &recurrent = weights._recurrent;
+	const Connections &lateral = weights._lateral;
+
+	const int numVisible = _visibleInputs.size();
+	const int numHidden = _states.size();
+
+	for (int hi = 0; hi < numHidden; hi++) {
+		_activations[hi] = 0.0f;
+
+		_states[hi] = 0.0f;
+	}
+
+	float counter = 0.0f;
+
+	for (int it = 0; it < iter; it++) {
+		for (int vi = 0; vi < numVisible; vi++)
+			_visibleErrors[vi] = _visibleInputs[vi] - _visibleRecons[vi];
+
+		for (int hi = 0; hi < numHidden; hi++)
+			_hiddenErrors[hi] = _statesPrev[hi] - _hiddenRecons[hi];
+
+		for (int hi = 0; hi < numHidden; hi++) {
+			float excitation = 0.0f;
+
+			for (int ci = feedForward._offsets[hi]; ci < feedForward._offsets[hi + 1]; ci++)
+				excitation += _visibleErrors[feedForward._indices[ci]] * feedForward._weights[ci];
+
+			for (int ci = recurrent._offsets[hi]; ci < recurrent._offsets[hi + 1]; ci++)
+				excitation += _hiddenErrors[recurrent._indices[ci]] * recurrent._weights[ci];
+
+			float inhibition = 0.0f;
+
+			for (int ci = lateral._offsets[hi]; ci < lateral._offsets[hi + 1]; ci++)
+				inhibition += _spikesPrev[lateral._indices[ci]] * lateral._weights[ci];
+
+			_activations[hi] = (1.0f - leak) * _activations[hi] + excitation - inhibition;
+
+			if (_activations[hi] > weights._thresholds[hi]) {
+				_activations[hi] = 0.0f;
+				_spikes[hi] = 1.0f;
+			}
+			else
+				_spikes[hi] = 0.0f;
+
+			_states[hi] += _spikes[hi];
+		}
+
+		for (int hi = 0; hi < numHidden; hi++)
+			_spikesPrev[hi] = _spikes[hi];
+
+		counter += 1.0f;
+
+		reconstruct(weights, 1.0f / counter);
+	}
+
+	// Divide
+	float multiplier = 1.0f / counter;
+
+	for (int hi = 0; hi < numHidden; hi++)
+		_states[hi] *= multiplier;
+}
+
+void AgentPolicy::Encoder::reconstruct(const LayerWeights &weights, float multiplier) {
+	const Connections &feedForward = weights._feedForward;
+	const Connections &recurrent = weights._recurrent;
+
+	std::fill(_visibleRecons.begin(), _visibleRecons.end(), 0.0f);
+	std::fill(_hiddenRecons.begin(), _hiddenRecons.end(), 0.0f);
+
+	for (int hi = 0; hi < _states.size(); hi++) {
+		for (int ci = feedForward._offsets[hi]; ci < feedForward._offsets[hi + 1]; ci++)
+			_visibleRecons[feedForward._indices[ci]] += feedForward._weights[ci] * _states[hi] * multiplier;
+
+		for (int ci = recurrent._offsets[hi]; ci < recurrent._offsets[hi + 1]; ci++)
+			_hiddenRecons[recurrent._indices[ci]] += recurrent._weights[ci] * _states[hi] * multiplier;
+	}
+}
+
+void AgentPolicy::ColumnState::activate(const ColumnWeights &weights, int iter, float leak) {
+	const int numStates = weights._numStates;
+	const int numCells = weights._numCells;
+
+	for (int i = 0; i < numCells; i++) {
+		_activations[i] = 0.0f;
+		_cellStates[i] = 0.0f;
+	}
+
+	float counter = 0.0f;
+
+	for (int it = 0; it < iter; it++) {
+		for (int i = 0; i < numCells; i++) {
+			const float* feedForward = &weights._feedForward[i * numStates];
+			const float* lateral = &weights._lateral[i * numCells];
+
+			float excitation = 0.0f;
+
+			for (int j = 0; j < numStates; j++)
+				excitation += feedForward[j] * _reconstructionErrors[j];
+
+			float inhibition = 0.0f;
+
+			for (int j = 0; j < numCells; j++)
+				inhibition += lateral[j] * _spikesPrev[j];
+
+			float activation = (1.0f - leak) * _activations[i] + excitation - inhibition;
+
+			if (activation > weights._thresholds[i]) {
+				activation = 0.0f;
+
+				_spikes[i] = 1.0f;
+			}
+			else
+				_spikes[i] = 0.0f;
+
+			_cellStates[i] += _spikes[i];
+
+			_activations[i] = activation;
+		}
+
+		for (int i = 0; i < numCells; i++)
+			_spikesPrev[i] = _spikes[i];
+
+		counter += 1.0f;
+
+		float multiplier = 1.0f / counter;
+
+		// Reconstruct
+		for (int j = 0; j < numStates; j++) {
+			float recon = 0.0f;
+
+			for (int i = 0; i < numCells; i++)
+				recon += _spikes[i] * multiplier * weights._feedForward[i * numStates + j];
+
+			_reconstructionErrors[j] = _inputs[j] - recon;
+		}
+	}
+
+	float multiplier = 1.0f / counter;
+
+	for (int i = 0; i < numCells; i++)
+		_cellStates[i] *= multiplier;
+
+	for (int a = 0; a < _actions.size(); a++) {
+		const float* actionWeights = &weights._actions[a * numCells];
+
+		float sum = 0.0f;
+
+		for (int i = 0; i < numCells; i++)
+			sum += actionWeights[i] * _cellStates[i];
+
+		_actions[a] = Column::sigmoid(sum);
+	}
+}
+
+void AgentPolicy::exportColumnWeights(const Column &column, ColumnWeights &weights) {
+	weights._numStates = column.getNumStates();
+	weights._numCells = column.getNumCells();
+
+	weights._feedForward.resize(weights._numCells * weights._numStates);
+	weights._lateral.resize(weights._numCells * weights._numCells);
+	weights._actions.resize(column.getNumActions() * weights._numCells);
+	weights._thresholds.resize(weights._numCells);
+
+	for (int i = 0; i < weights._numCells; i++) {
+		for (int j = 0; j < weights._numStates; j++)
+			weights._feedForward[i * weights._numStates + j] = column._cells[i]._feedForwardConnections[j]._weight;
+
+		for (int j = 0; j < weights._numCells; j++)
+			weights._lateral[i * weights._numCells + j] = column._cells[i]._lateralConnections[j]._weight;
+
+		weights._thresholds[i] = column._cells[i]._threshold;
+	}
+
+	for (int a = 0; a < column.getNumActions(); a++)
+		for (int i = 0; i < weights._numCells; i++)
+			weights._actions[a * weights._numCells + i] = column._actions[a]._connections[i]._weight;
+}
+
+void AgentPolicy::exportColumnState(const Column &column, ColumnState &state) {
+	state._inputs = column._inputs;
+	state._reconstructionErrors = column._reconstructionError;
+
+	state._activations.resize(column.getNumCells());
+	state._spikes.resize(column.getNumCells());
+	state._spikesPrev.resize(column.getNumCells());
+	state._cellStates.resize(column.getNumCells());
+
+	for (int i = 0; i < column.getNumCells(); i++) {
+		state._activations[i] = column._cells[i]._activation;
+		state._spikes[i] = column._cells[i]._spike;
+		state._spikesPrev[i] = column._cells[i]._spikePrev;
+		state._cellStates[i] = column._cells[i]._state;
+	}
+
+	state._actions.resize(column.getNumActions());
+
+	for (int a = 0; a < column.getNumActions(); a++)
+		state._actions[a] = column.getAction(a);
+}
+
+void AgentPolicy::simStep() {
+	const int numLayers = _layers.size();
+
+	// Feature extraction
+	for (int l = 0; l < numLayers; l++) {
+		_layers[l]._sdr.activate(_weights->_layers[l], _layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak);
+
+		// Attention gated inputs for next layer if there is one
+		if (l < numLayers - 1) {
+			for (int i = 0; i < _layers[l]._sdr._states.size(); i++)
+				_layers[l + 1]._sdr._visibleInputs[i] = _layers[l]._sdr._states[i] * _layers[l]._columns[i]._actions[Agent::_attention];
+		}
+	}
+
+	// Prediction, layer by layer. Nodes only read the layer above and this layer's SDR, so they are independent
+	for (int l = numLayers - 1; l >= 0; l--) {
+		Layer &layer = _layers[l];
+
+		const LayerWeights &layerWeights = _weights->_layers[l];
+
+		const Connections &feedBack = layerWeights._feedBackConnections;
+		const Connections &predictive = layerWeights._predictiveConnections;
+
+		sys::parallelFor(_threadPool.get(), layer._predictions.size(), [&](int pi) {
+			ColumnState &column = layer._columns[pi];
+
+			int colInputIndex = 0;
+
+			if (l < numLayers - 1) {
+				for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++) {
+					column._inputs[colInputIndex++] = _layers[l + 1]._columns[feedBack._indices[ci]]._actions[Agent::_signal];
+					column._inputs[colInputIndex++] = _layers[l + 1]._predictions[feedBack._indices[ci]];
+				}
+			}
+
+			for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+				column._inputs[colInputIndex++] = layer._sdr._states[predictive._indices[ci]];
+
+			column.activate(layerWeights._columns[pi], _layerDescs[l]._columnIter, _layerDescs[l]._columnLeak);
+
+			float activation = 0.0f;
+
+			// Feed Back
+			if (l < numLayers - 1) {
+				for (int ci = feedBack._offsets[pi]; ci < feedBack._offsets[pi + 1]; ci++)
+					activation += feedBack._weights[ci] * _layers[l + 1]._predictions[feedBack._indices[ci]];
+			}
+
+			// Predictive
+			for (int ci = predictive._offsets[pi]; ci < predictive._offsets[pi + 1]; ci++)
+				activation += predictive._weights[ci] * layer._sdr._states[predictive._indices[ci]];
+
+			layer._predictions[pi] = std::min(1.0f, std::max(0.0f, activation));
+		});
+	}
+
+	const Connections &inputFeedBack = _weights->_inputFeedBackConnections;
+
+	// Get first layer prediction
+	sys::parallelFor(_threadPool.get(), _inputPredictions.size(), [&](int pi) {
+		ColumnState &column = _inputColumns[pi];
+
+		int colInputIndex = 0;
+
+		for (int ci = inputFeedBack._offsets[pi]; ci < inputFeedBack._offsets[pi + 1]; ci++) {
+			column._inputs[colInputIndex++] = _layers.front()._columns[inputFeedBack._indices[ci]]._actions[Agent::_signal];
+			column._inputs[colInputIndex++] = _layers.front()._predictions[inputFeedBack._indices[ci]];
+		}
+
+		column.activate(_weights->_inputColumns[pi], _columnIter, _columnLeak);
+
+		float activation = 0.0f;
+
+		for (int ci = inputFeedBack._offsets[pi]; ci < inputFeedBack._offsets[pi + 1]; ci++)
+			activation += inputFeedBack._weights[ci] * _layers.front()._predictions[inputFeedBack._indices[ci]];
+
+		_inputPredictions[pi] = activation;
+	});
+
+	for (int l = 0; l < numLayers; l++)
+		_layers[l]._sdr._statesPrev = _layers[l]._sdr._states;
+
+	// Predictions become the inputs until setInput overrides them
+	for (int pi = 0; pi < _inputPredictions.size(); pi++)
+		_layers.front()._sdr._visibleInputs[pi] = _inputPredictions[pi];
+}
+
+void AgentPolicy::fork(AgentPolicy &branch) const {
+	branch = *this;
+
+	branch._threadPool = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "Agent.h"
+
+namespace neo {
+	// Inference-only copy of a trained Agent, made by Agent::exportPolicy. Encoders and columns keep only the weights that
+	// activation needs, and columns output their actions without exploration or learning.
+	// At the end of a step the input predictions become the next inputs, so a policy can run on its own, and setInput
+	// overrides them for the inputs the caller knows or chooses.
+	// The weights are immutable and shared by all copies, so a fork only clones the per step state. Forks can be stepped
+	// from separate threads, for instance to roll out candidate inputs from the same starting point
+	class AgentPolicy {
+	public:
+		// Connections of all units of a layer back to back, those of unit i are [_offsets[i], _offsets[i + 1])
+		struct Connections {
+			std::vector<int> _offsets;
+			std::vector<unsigned short> _indices;
+			std::vector<float> _weights;
+
+			Connections()
+				: _offsets(1, 0)
+			{}
+
+			void add(unsigned short index, float weight) {
+				_indices.push_back(index);
+				_weights.push_back(weight);
+			}
+
+			// Ends the current unit
+			void next() {
+				_offsets.push_back(_indices.size());
+			}
+		};
+
+		// Frozen Column
+		struct ColumnWeights {
+			int _numStates;
+			int _numCells;
+
+			// [cell][state]
+			std::vector<float> _feedForward;
+
+			// [cell][cell]
+			std::vector<float> _lateral;
+
+			// [action][cell]
+			std::vector<float> _actions;
+
+			std::vector<float> _thresholds;
+		};
+
+		struct LayerWeights {
+			// Frozen SparseCoder
+			Connections _feedForward;
+			Connections _recurrent;
+			Connections _lateral;
+
+			std::vector<float> _thresholds;
+
+			Connections _feedBackConnections;
+			Connections _predictiveConnections;
+
+			std::vector<ColumnWeights> _columns;
+		};
+
+		struct Weights {
+			std::vector<LayerWeights> _layers;
+
+			Connections _inputFeedBackConnections;
+
+			std::vector<ColumnWeights> _inputColumns;
+		};
+
+		// State of a frozen SparseCoder
+		struct Encoder {
+			std::vector<float> _visibleInputs;
+			std::vector<float> _visibleRecons;
+
+			std::vector<float> _activations;
+			std::vector<float> _spikes;
+			std::vector<float> _spikesPrev;
+			std::vector<float> _states;
+			std::vector<float> _statesPrev;
+			std::vector<float> _hiddenRecons;
+
+			std::vector<float> _visibleErrors;
+			std::vector<float> _hiddenErrors;
+
+			void activate(const LayerWeights &weights, int iter, float leak);
+
+			// Reconstructions of the current states times multiplier
+			void reconstruct(const LayerWeights &weights, float multiplier);
+		};
+
+		// State of a frozen Column
+		struct ColumnState {
+			std::vector<float> _inputs;
+			std::vector<float> _reconstructionErrors;
+
+			std::vector<float> _activations;
+			std::vector<float> _spikes;
+			std::vector<float> _spikesPrev;
+			std::vector<float> _cellStates;
+
+			std::vector<float> _actions;
+
+			// Settles the cells as Column::simStep and outputs the actions it would explore around
+			void activate(const ColumnWeights &weights, int iter, float leak);
+		};
+
+		struct Layer {
+			Encoder _sdr;
+
+			std::vector<float> _predictions;
+
+			std::vector<ColumnState> _columns;
+		};
+
+	private:
+		std::vector<Agent::LayerDesc> _layerDescs;
+		std::vector<Layer> _layers;
+
+		std::shared_ptr<const Weights> _weights;
+
+		std::vector<float> _inputPredictions;
+
+		std::vector<ColumnState> _inputColumns;
+
+		int _columnIter;
+		float _columnLeak;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+		// Used by Agent::exportPolicy and Agent::exportState
+		static void exportColumnWeights(const Column &column, ColumnWeights &weights);
+		static void exportColumnState(const Column &column, ColumnState &state);
+
+	public:
+		AgentPolicy()
+			: _columnIter(0), _columnLeak(0.0f)
+		{}
+
+		void simStep();
+
+		// Makes branch a copy of this policy that shares its weights. Reusing the same branch for every fork avoids
+		// reallocating its state. Branches get no thread pool since the pool is not reentrant, step them on separate threads instead
+		void fork(AgentPolicy &branch) const;
+
+		// Runs the nodes of each layer on the pool
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		// Takes value as the input at index instead of the prediction of the last simStep, so call it between steps
+		void setInput(int index, float value) {
+			_layers.front()._sdr._visibleInputs[index] = value;
+		}
+
+		// inputWidth * inputHeight values, row by row
+		void setInputs(const float* inputs) {
+			for (int i = 0; i < _layers.front()._sdr._visibleInputs.size(); i++)
+				_layers.front()._sdr._visibleInputs[i] = inputs[i];
+		}
+
+		void setInputs(const std::vector<float> &inputs) {
+			setInputs(inputs.data());
+		}
+
+		float getPrediction(int index) const {
+			return _inputPredictions[index];
+		}
+
+		void getPredictions(std::vector<float> &predictions) const {
+			predictions = _inputPredictions;
+		}
+
+		int getNumInputs() const {
+			return _inputPredictions.size();
+		}
+
+		friend class Agent;
+	};
+}
\ No newline at end of file
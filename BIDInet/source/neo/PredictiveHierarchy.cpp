@@ -1,315 +1,498 @@
-#include "PredictiveHierarchy.h"
-
-#include <algorithm>
-
-using namespace neo;
-
-void PredictiveHierarchy::createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
-	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
-
-	_layerDescs = layerDescs;
-
-	_layers.resize(_layerDescs.size());
-
-	int widthPrev = inputWidth;
-	int heightPrev = inputHeight;
-
-	for (int l = 0; l < _layerDescs.size(); l++) {
-		_layers[l]._sdr.createRandom(widthPrev, heightPrev, _layerDescs[l]._width, _layerDescs[l]._height, _layerDescs[l]._receptiveRadius, _layerDescs[l]._recurrentRadius, _layerDescs[l]._lateralRadius, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
-
-		_layers[l]._predictionNodes.resize(_layerDescs[l]._width * _layerDescs[l]._height);
-
-		int feedBackSize = std::pow(_layerDescs[l]._feedBackRadius * 2 + 1, 2);
-		int predictiveSize = std::pow(_layerDescs[l]._predictiveRadius * 2 + 1, 2);
-
-		float hiddenToNextHiddenWidth = 1.0f;
-		float hiddenToNextHiddenHeight = 1.0f;
-
-		if (l < _layers.size() - 1) {
-			hiddenToNextHiddenWidth = static_cast<float>(_layerDescs[l + 1]._width) / static_cast<float>(_layerDescs[l]._width);
-			hiddenToNextHiddenHeight = static_cast<float>(_layerDescs[l + 1]._height) / static_cast<float>(_layerDescs[l]._height);
-		}
-
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			p._bias._weight = weightDist(generator);
-
-			int hx = pi % _layerDescs[l]._width;
-			int hy = pi / _layerDescs[l]._width;
-
-			// Feed Back
-			if (l < _layers.size() - 1) {
-				p._feedBackConnections.reserve(feedBackSize);
-
-				int centerX = std::round(hx * hiddenToNextHiddenWidth);
-				int centerY = std::round(hy * hiddenToNextHiddenHeight);
-
-				for (int dx = -_layerDescs[l]._feedBackRadius; dx <= _layerDescs[l]._feedBackRadius; dx++)
-					for (int dy = -_layerDescs[l]._feedBackRadius; dy <= _layerDescs[l]._feedBackRadius; dy++) {
-						int hox = centerX + dx;
-						int hoy = centerY + dy;
-
-						if (hox >= 0 && hox < _layerDescs[l + 1]._width && hoy >= 0 && hoy < _layerDescs[l + 1]._height) {
-							int hio = hox + hoy * _layerDescs[l + 1]._width;
-
-							Connection c;
-
-							c._weight = weightDist(generator);
-							c._index = hio;
-
-							p._feedBackConnections.push_back(c);
-						}
-					}
-
-				p._feedBackConnections.shrink_to_fit();
-			}
-
-			// Predictive
-			p._predictiveConnections.reserve(feedBackSize);
-
-			for (int dx = -_layerDescs[l]._predictiveRadius; dx <= _layerDescs[l]._predictiveRadius; dx++)
-				for (int dy = -_layerDescs[l]._predictiveRadius; dy <= _layerDescs[l]._predictiveRadius; dy++) {
-					int hox = hx + dx;
-					int hoy = hy + dy;
-
-					if (hox >= 0 && hox < _layerDescs[l]._width && hoy >= 0 && hoy < _layerDescs[l]._height) {
-						int hio = hox + hoy * _layerDescs[l]._width;
-
-						Connection c;
-
-						c._weight = weightDist(generator);
-						c._index = hio;
-
-						p._predictiveConnections.push_back(c);
-					}
-				}
-
-			p._predictiveConnections.shrink_to_fit();
-		}
-
-		widthPrev = _layerDescs[l]._width;
-		heightPrev = _layerDescs[l]._height;
-	}
-
-	_inputPredictionNodes.resize(inputWidth * inputHeight);
-
-	float inputToNextHiddenWidth = static_cast<float>(_layerDescs.front()._width) / static_cast<float>(inputWidth);
-	float inputToNextHiddenHeight = static_cast<float>(_layerDescs.front()._height) / static_cast<float>(inputHeight);
-
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		p._bias._weight = weightDist(generator);
-
-		int hx = pi % inputWidth;
-		int hy = pi / inputWidth;
-
-		int feedBackSize = std::pow(inputFeedBackRadius * 2 + 1, 2);
-
-		// Feed Back
-		p._feedBackConnections.reserve(feedBackSize);
-
-		int centerX = std::round(hx * inputToNextHiddenWidth);
-		int centerY = std::round(hy * inputToNextHiddenHeight);
-
-		for (int dx = -inputFeedBackRadius; dx <= inputFeedBackRadius; dx++)
-			for (int dy = -inputFeedBackRadius; dy <= inputFeedBackRadius; dy++) {
-				int hox = centerX + dx;
-				int hoy = centerY + dy;
-
-				if (hox >= 0 && hox < _layerDescs.front()._width && hoy >= 0 && hoy < _layerDescs.front()._height) {
-					int hio = hox + hoy * _layerDescs.front()._width;
-
-					Connection c;
-
-					c._weight = weightDist(generator);
-					c._index = hio;
-
-					p._feedBackConnections.push_back(c);
-				}
-			}
-
-		p._feedBackConnections.shrink_to_fit();
-	}
-}
-
-void PredictiveHierarchy::simStep(std::mt19937 &generator, bool learn) {
-	// Feature extraction
-	for (int l = 0; l < _layers.size(); l++) {
-		_layers[l]._sdr.activate(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, generator);
-
-		// Set inputs for next layer if there is one
-		if (l < _layers.size() - 1) {
-			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
-				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i));
-			}
-		}
-	}
-
-	// Prediction
-	for (int l = _layers.size() - 1; l >= 0; l--) {
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			// Learn
-			if (learn) {	
-				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
-
-				if (l < _layers.size() - 1) {
-					for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-						p._feedBackConnections[ci]._weight += _layerDescs[l]._learnFeedBack * predictionError * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
-				}
-
-				// Predictive
-				for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-					p._predictiveConnections[ci]._weight += _layerDescs[l]._learnPrediction * predictionError * _layers[l]._sdr.getHiddenStatePrev(p._predictiveConnections[ci]._index);
-			}
-
-			float activation = 0.0f;
-
-			// Feed Back
-			if (l < _layers.size() - 1) {
-				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-					activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
-			}
-
-			// Predictive
-			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-				activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
-
-			p._activation = activation;
-
-			p._state = std::min(1.0f, std::max(0.0f, p._activation));
-		}
-	}
-
-	// Get first layer prediction
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		// Learn
-		if (learn) {		
-			float predictionError = _layers.front()._sdr.getVisibleState(pi) - p._statePrev;
-
-			for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-				p._feedBackConnections[ci]._weight += _learnInputFeedBack * predictionError * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
-		}
-
-		float activation = 0.0f;
-
-		// Feed Back
-		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-			activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
-
-		p._activation = activation;
-
-		p._state = p._activation;
-	}
-
-	for (int l = 0; l < _layers.size(); l++) {
-		std::vector<float> rewards(_layers[l]._predictionNodes.size());
-
-		if (learn) {
-			for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-				PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
-
-				float error2 = predictionError * predictionError;
-
-				rewards[pi] = sigmoid(_layerDescs[l]._sdrSensitivity * (error2 - p._baseline));
-
-				p._baseline = (1.0f - _layerDescs[l]._sdrBaselineDecay) * p._baseline + _layerDescs[l]._sdrBaselineDecay * error2;
-			}
-
-			_layers[l]._sdr.learn(rewards, _layerDescs[l]._sdrLambda, _layerDescs[l]._learnFeedForward, _layerDescs[l]._learnRecurrent, _layerDescs[l]._learnLateral, _layerDescs[l]._sdrLearnThreshold, _layerDescs[l]._sdrSparsity, _layerDescs[l]._sdrWeightDecay, _layerDescs[l]._sdrMaxWeightDelta); //attentions[l], 
-		}
-
-		_layers[l]._sdr.stepEnd();
-
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			p._statePrev = p._state;
-			p._activationPrev = p._activation;
-		}
-	}
-
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		p._statePrev = p._state;
-		p._activationPrev = p._activation;
-	}
-}
-
-void PredictiveHierarchy::simStepGenerate(std::mt19937 &generator, float noise) {
-	// Feature extraction
-	for (int l = 0; l < _layers.size(); l++) {
-		_layers[l]._sdr.activateNoise(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, noise, generator);
-
-		// Set inputs for next layer if there is one
-		if (l < _layers.size() - 1) {
-			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
-				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i));
-			}
-		}
-	}
-
-	// Prediction
-	for (int l = _layers.size() - 1; l >= 0; l--) {
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			float activation = 0.0f;
-
-			// Feed Back
-			if (l < _layers.size() - 1) {
-				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-					activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
-			}
-
-			// Predictive
-			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
-				activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
-
-			p._activation = activation;
-
-			p._state = std::min(1.0f, std::max(0.0f, p._activation));
-		}
-	}
-
-	// Get first layer prediction
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		float activation = 0.0f;
-
-		// Feed Back
-		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
-			activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
-
-		p._activation = activation;
-
-		p._state = p._activation;
-	}
-
-	for (int l = 0; l < _layers.size(); l++) {
-		_layers[l]._sdr.stepEnd();
-
-		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
-			PredictionNode &p = _layers[l]._predictionNodes[pi];
-
-			p._statePrev = p._state;
-			p._activationPrev = p._activation;
-		}
-	}
-
-	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
-		InputPredictionNode &p = _inputPredictionNodes[pi];
-
-		p._statePrev = p._state;
-		p._activationPrev = p._activation;
-	}
+#include "PredictiveHierarchy.h"
+
+#include <algorithm>
+
+using namespace neo;
+
+// Groups the connections of all nodes by their source unit
+template<class T>
+static void buildReverseMap(int numSources, const std::vector<T> &nodes, std::vector<PredictiveHierarchy::Connection> T::*connections, PredictiveHierarchy::ReverseMap &map) {
+	map._offsets.assign(numSources + 1, 0);
+
+	for (int n = 0; n < nodes.size(); n++)
+		for (int ci = 0; ci < (nodes[n].*connections).size(); ci++)
+			map._offsets[(nodes[n].*connections)[ci]._index + 1]++;
+
+	for (int u = 0; u < numSources; u++)
+		map._offsets[u + 1] += map._offsets[u];
+
+	map._connections.resize(map._offsets.back());
+
+	std::vector<int> next(map._offsets.begin(), map._offsets.end() - 1);
+
+	for (int n = 0; n < nodes.size(); n++)
+		for (int ci = 0; ci < (nodes[n].*connections).size(); ci++) {
+			PredictiveHierarchy::ReverseConnection rc;
+
+			rc._node = n;
+			rc._connection = ci;
+
+			map._connections[next[(nodes[n].*connections)[ci]._index]++] = rc;
+		}
+}
+
+// Applies the learning step through the units that were active last step, adding (weight change) * (last state) to the
+// activations, then adds weight * (change) for the units whose state changed
+template<class T, class StateFunc, class StatePrevFunc>
+static void propagateChanges(std::vector<T> &nodes, std::vector<PredictiveHierarchy::Connection> T::*connections, const PredictiveHierarchy::ReverseMap &map,
+	const StateFunc &getState, const StatePrevFunc &getStatePrev, float alpha, const std::vector<float> &errors, bool learn)
+{
+	int numSources = static_cast<int>(map._offsets.size()) - 1;
+
+	if (learn) {
+		for (int u = 0; u < numSources; u++) {
+			float statePrev = getStatePrev(u);
+
+			if (statePrev == 0.0f)
+				continue;
+
+			for (int ri = map._offsets[u]; ri < map._offsets[u + 1]; ri++) {
+				const PredictiveHierarchy::ReverseConnection &rc = map._connections[ri];
+
+				T &p = nodes[rc._node];
+
+				float delta = alpha * errors[rc._node] * statePrev;
+
+				(p.*connections)[rc._connection]._weight += delta;
+
+				p._activation += delta * statePrev;
+			}
+		}
+	}
+
+	for (int u = 0; u < numSources; u++) {
+		float change = getState(u) - getStatePrev(u);
+
+		if (change == 0.0f)
+			continue;
+
+		for (int ri = map._offsets[u]; ri < map._offsets[u + 1]; ri++) {
+			const PredictiveHierarchy::ReverseConnection &rc = map._connections[ri];
+
+			T &p = nodes[rc._node];
+
+			p._activation += (p.*connections)[rc._connection]._weight * change;
+		}
+	}
+}
+
+void PredictiveHierarchy::createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
+	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
+
+	_layerDescs = layerDescs;
+
+	_layers.resize(_layerDescs.size());
+
+	int widthPrev = inputWidth;
+	int heightPrev = inputHeight;
+
+	for (int l = 0; l < _layerDescs.size(); l++) {
+		_layers[l]._sdr.createRandom(widthPrev, heightPrev, _layerDescs[l]._width, _layerDescs[l]._height, _layerDescs[l]._receptiveRadius, _layerDescs[l]._recurrentRadius, _layerDescs[l]._lateralRadius, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
+
+		_layers[l]._sdr._sparseTraces = _layerDescs[l]._sdrSparseTraces;
+		_layers[l]._sdr._traceEpsilon = _layerDescs[l]._sdrTraceEpsilon;
+
+		_layers[l]._predictionNodes.resize(_layerDescs[l]._width * _layerDescs[l]._height);
+
+		int feedBackSize = std::pow(_layerDescs[l]._feedBackRadius * 2 + 1, 2);
+		int predictiveSize = std::pow(_layerDescs[l]._predictiveRadius * 2 + 1, 2);
+
+		float hiddenToNextHiddenWidth = 1.0f;
+		float hiddenToNextHiddenHeight = 1.0f;
+
+		if (l < _layers.size() - 1) {
+			hiddenToNextHiddenWidth = static_cast<float>(_layerDescs[l + 1]._width) / static_cast<float>(_layerDescs[l]._width);
+			hiddenToNextHiddenHeight = static_cast<float>(_layerDescs[l + 1]._height) / static_cast<float>(_layerDescs[l]._height);
+		}
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			p._bias._weight = weightDist(generator);
+
+			int hx = pi % _layerDescs[l]._width;
+			int hy = pi / _layerDescs[l]._width;
+
+			// Feed Back
+			if (l < _layers.size() - 1) {
+				p._feedBackConnections.reserve(feedBackSize);
+
+				int centerX = std::round(hx * hiddenToNextHiddenWidth);
+				int centerY = std::round(hy * hiddenToNextHiddenHeight);
+
+				for (int dx = -_layerDescs[l]._feedBackRadius; dx <= _layerDescs[l]._feedBackRadius; dx++)
+					for (int dy = -_layerDescs[l]._feedBackRadius; dy <= _layerDescs[l]._feedBackRadius; dy++) {
+						int hox = centerX + dx;
+						int hoy = centerY + dy;
+
+						if (hox >= 0 && hox < _layerDescs[l + 1]._width && hoy >= 0 && hoy < _layerDescs[l + 1]._height) {
+							int hio = hox + hoy * _layerDescs[l + 1]._width;
+
+							Connection c;
+
+							c._weight = weightDist(generator);
+							c._index = hio;
+
+							p._feedBackConnections.push_back(c);
+						}
+					}
+
+				p._feedBackConnections.shrink_to_fit();
+			}
+
+			// Predictive
+			p._predictiveConnections.reserve(feedBackSize);
+
+			for (int dx = -_layerDescs[l]._predictiveRadius; dx <= _layerDescs[l]._predictiveRadius; dx++)
+				for (int dy = -_layerDescs[l]._predictiveRadius; dy <= _layerDescs[l]._predictiveRadius; dy++) {
+					int hox = hx + dx;
+					int hoy = hy + dy;
+
+					if (hox >= 0 && hox < _layerDescs[l]._width && hoy >= 0 && hoy < _layerDescs[l]._height) {
+						int hio = hox + hoy * _layerDescs[l]._width;
+
+						Connection c;
+
+						c._weight = weightDist(generator);
+						c._index = hio;
+
+						p._predictiveConnections.push_back(c);
+					}
+				}
+
+			p._predictiveConnections.shrink_to_fit();
+		}
+
+		widthPrev = _layerDescs[l]._width;
+		heightPrev = _layerDescs[l]._height;
+	}
+
+	_inputPredictionNodes.resize(inputWidth * inputHeight);
+
+	float inputToNextHiddenWidth = static_cast<float>(_layerDescs.front()._width) / static_cast<float>(inputWidth);
+	float inputToNextHiddenHeight = static_cast<float>(_layerDescs.front()._height) / static_cast<float>(inputHeight);
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		p._bias._weight = weightDist(generator);
+
+		int hx = pi % inputWidth;
+		int hy = pi / inputWidth;
+
+		int feedBackSize = std::pow(inputFeedBackRadius * 2 + 1, 2);
+
+		// Feed Back
+		p._feedBackConnections.reserve(feedBackSize);
+
+		int centerX = std::round(hx * inputToNextHiddenWidth);
+		int centerY = std::round(hy * inputToNextHiddenHeight);
+
+		for (int dx = -inputFeedBackRadius; dx <= inputFeedBackRadius; dx++)
+			for (int dy = -inputFeedBackRadius; dy <= inputFeedBackRadius; dy++) {
+				int hox = centerX + dx;
+				int hoy = centerY + dy;
+
+				if (hox >= 0 && hox < _layerDescs.front()._width && hoy >= 0 && hoy < _layerDescs.front()._height) {
+					int hio = hox + hoy * _layerDescs.front()._width;
+
+					Connection c;
+
+					c._weight = weightDist(generator);
+					c._index = hio;
+
+					p._feedBackConnections.push_back(c);
+				}
+			}
+
+		p._feedBackConnections.shrink_to_fit();
+	}
+
+	for (int l = 0; l < _layers.size(); l++) {
+		if (l < _layers.size() - 1)
+			buildReverseMap(_layers[l + 1]._predictionNodes.size(), _layers[l]._predictionNodes, &PredictionNode::_feedBackConnections, _layers[l]._feedBackMap);
+
+		buildReverseMap(_layers[l]._sdr.getNumHidden(), _layers[l]._predictionNodes, &PredictionNode::_predictiveConnections, _layers[l]._predictiveMap);
+	}
+
+	buildReverseMap(_layers.front()._predictionNodes.size(), _inputPredictionNodes, &InputPredictionNode::_feedBackConnections, _inputFeedBackMap);
+
+	_stepsSinceRecompute = 0;
+}
+
+float PredictiveHierarchy::getInputChange(int l) const {
+	int numChanged = 0;
+	int numInputs = 0;
+
+	// Feed Back
+	if (l < static_cast<int>(_layers.size()) - 1) {
+		const std::vector<PredictionNode> &nextNodes = _layers[l + 1]._predictionNodes;
+
+		for (int i = 0; i < nextNodes.size(); i++)
+			if (nextNodes[i]._state != nextNodes[i]._statePrev)
+				numChanged++;
+
+		numInputs += nextNodes.size();
+	}
+
+	// Predictive
+	if (l >= 0) {
+		const SparseCoder &sdr = _layers[l]._sdr;
+
+		for (int i = 0; i < sdr.getNumHidden(); i++)
+			if (sdr.getHiddenState(i) != sdr.getHiddenStatePrev(i))
+				numChanged++;
+
+		numInputs += sdr.getNumHidden();
+	}
+
+	return static_cast<float>(numChanged) / std::max(1, numInputs);
+}
+
+void PredictiveHierarchy::predictIncremental(int l, bool learn) {
+	std::vector<PredictionNode> &nodes = _layers[l]._predictionNodes;
+
+	const SparseCoder &sdr = _layers[l]._sdr;
+
+	if (learn) {
+		_predictionErrors.resize(nodes.size());
+
+		for (int pi = 0; pi < nodes.size(); pi++)
+			_predictionErrors[pi] = sdr.getHiddenState(pi) - nodes[pi]._statePrev;
+	}
+
+	// Feed Back
+	if (l < _layers.size() - 1) {
+		const std::vector<PredictionNode> &nextNodes = _layers[l + 1]._predictionNodes;
+
+		propagateChanges(nodes, &PredictionNode::_feedBackConnections, _layers[l]._feedBackMap,
+			[&](int u) { return nextNodes[u]._state; }, [&](int u) { return nextNodes[u]._statePrev; },
+			_layerDescs[l]._learnFeedBack, _predictionErrors, learn);
+	}
+
+	// Predictive
+	propagateChanges(nodes, &PredictionNode::_predictiveConnections, _layers[l]._predictiveMap,
+		[&](int u) { return sdr.getHiddenState(u); }, [&](int u) { return sdr.getHiddenStatePrev(u); },
+		_layerDescs[l]._learnPrediction, _predictionErrors, learn);
+
+	for (int pi = 0; pi < nodes.size(); pi++)
+		nodes[pi]._state = std::min(1.0f, std::max(0.0f, nodes[pi]._activation));
+}
+
+void PredictiveHierarchy::predictInputsIncremental(bool learn) {
+	if (learn) {
+		_predictionErrors.resize(_inputPredictionNodes.size());
+
+		for (int pi = 0; pi < _inputPredictionNodes.size(); pi++)
+			_predictionErrors[pi] = _layers.front()._sdr.getVisibleState(pi) - _inputPredictionNodes[pi]._statePrev;
+	}
+
+	const std::vector<PredictionNode> &nextNodes = _layers.front()._predictionNodes;
+
+	propagateChanges(_inputPredictionNodes, &InputPredictionNode::_feedBackConnections, _inputFeedBackMap,
+		[&](int u) { return nextNodes[u]._state; }, [&](int u) { return nextNodes[u]._statePrev; },
+		_learnInputFeedBack, _predictionErrors, learn);
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++)
+		_inputPredictionNodes[pi]._state = _inputPredictionNodes[pi]._activation;
+}
+
+void PredictiveHierarchy::simStep(std::mt19937 &generator, bool learn) {
+	if (_boundInputs != nullptr)
+		setInputs(_boundInputs);
+
+	// Feature extraction
+	for (int l = 0; l < _layers.size(); l++) {
+		_layers[l]._sdr.activate(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, generator);
+
+		// Set inputs for next layer if there is one
+		if (l < _layers.size() - 1) {
+			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
+				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i));
+			}
+		}
+	}
+
+	_stepsSinceRecompute++;
+
+	bool fullRecompute = !_incrementalPrediction || _stepsSinceRecompute >= _fullRecomputeInterval;
+
+	if (fullRecompute)
+		_stepsSinceRecompute = 0;
+
+	// Prediction
+	for (int l = _layers.size() - 1; l >= 0; l--) {
+		if (!fullRecompute && getInputChange(l) <= _incrementalMaxChange) {
+			predictIncremental(l, learn);
+
+			continue;
+		}
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			// Learn
+			if (learn) {	
+				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
+
+				if (l < _layers.size() - 1) {
+					for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+						p._feedBackConnections[ci]._weight += _layerDescs[l]._learnFeedBack * predictionError * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
+				}
+
+				// Predictive
+				for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+					p._predictiveConnections[ci]._weight += _layerDescs[l]._learnPrediction * predictionError * _layers[l]._sdr.getHiddenStatePrev(p._predictiveConnections[ci]._index);
+			}
+
+			float activation = 0.0f;
+
+			// Feed Back
+			if (l < _layers.size() - 1) {
+				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+					activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
+			}
+
+			// Predictive
+			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+				activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
+
+			p._activation = activation;
+
+			p._state = std::min(1.0f, std::max(0.0f, p._activation));
+		}
+	}
+
+	// Get first layer prediction
+	if (!fullRecompute && getInputChange(-1) <= _incrementalMaxChange)
+		predictInputsIncremental(learn);
+	else {
+		for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+			InputPredictionNode &p = _inputPredictionNodes[pi];
+
+			// Learn
+			if (learn) {		
+				float predictionError = _layers.front()._sdr.getVisibleState(pi) - p._statePrev;
+
+				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+					p._feedBackConnections[ci]._weight += _learnInputFeedBack * predictionError * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._statePrev;
+			}
+
+			float activation = 0.0f;
+
+			// Feed Back
+			for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+				activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
+
+			p._activation = activation;
+
+			p._state = p._activation;
+		}
+	}
+
+	for (int l = 0; l < _layers.size(); l++) {
+		std::vector<float> rewards(_layers[l]._predictionNodes.size());
+
+		if (learn) {
+			for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+				PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+				float predictionError = _layers[l]._sdr.getHiddenState(pi) - p._statePrev;
+
+				float error2 = predictionError * predictionError;
+
+				rewards[pi] = sigmoid(_layerDescs[l]._sdrSensitivity * (error2 - p._baseline));
+
+				p._baseline = (1.0f - _layerDescs[l]._sdrBaselineDecay) * p._baseline + _layerDescs[l]._sdrBaselineDecay * error2;
+			}
+
+			_layers[l]._sdr.learn(rewards, _layerDescs[l]._sdrLambda, _layerDescs[l]._learnFeedForward, _layerDescs[l]._learnRecurrent, _layerDescs[l]._learnLateral, _layerDescs[l]._sdrLearnThreshold, _layerDescs[l]._sdrSparsity, _layerDescs[l]._sdrWeightDecay, _layerDescs[l]._sdrMaxWeightDelta); //attentions[l], 
+		}
+
+		_layers[l]._sdr.stepEnd();
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			p._statePrev = p._state;
+			p._activationPrev = p._activation;
+		}
+	}
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		p._statePrev = p._state;
+		p._activationPrev = p._activation;
+	}
+}
+
+void PredictiveHierarchy::simStepGenerate(std::mt19937 &generator, float noise) {
+	// Feature extraction
+	for (int l = 0; l < _layers.size(); l++) {
+		_layers[l]._sdr.activateNoise(_layerDescs[l]._sdrIter, _layerDescs[l]._sdrLeak, noise, generator);
+
+		// Set inputs for next layer if there is one
+		if (l < _layers.size() - 1) {
+			for (int i = 0; i < _layers[l]._sdr.getNumHidden(); i++) {
+				_layers[l + 1]._sdr.setVisibleState(i, _layers[l]._sdr.getHiddenState(i));
+			}
+		}
+	}
+
+	// Prediction
+	for (int l = _layers.size() - 1; l >= 0; l--) {
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			float activation = 0.0f;
+
+			// Feed Back
+			if (l < _layers.size() - 1) {
+				for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+					activation += p._feedBackConnections[ci]._weight * _layers[l + 1]._predictionNodes[p._feedBackConnections[ci]._index]._state;
+			}
+
+			// Predictive
+			for (int ci = 0; ci < p._predictiveConnections.size(); ci++)
+				activation += p._predictiveConnections[ci]._weight * _layers[l]._sdr.getHiddenState(p._predictiveConnections[ci]._index);
+
+			p._activation = activation;
+
+			p._state = std::min(1.0f, std::max(0.0f, p._activation));
+		}
+	}
+
+	// Get first layer prediction
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		float activation = 0.0f;
+
+		// Feed Back
+		for (int ci = 0; ci < p._feedBackConnections.size(); ci++)
+			activation += p._feedBackConnections[ci]._weight * _layers.front()._predictionNodes[p._feedBackConnections[ci]._index]._state;
+
+		p._activation = activation;
+
+		p._state = p._activation;
+	}
+
+	for (int l = 0; l < _layers.size(); l++) {
+		_layers[l]._sdr.stepEnd();
+
+		for (int pi = 0; pi < _layers[l]._predictionNodes.size(); pi++) {
+			PredictionNode &p = _layers[l]._predictionNodes[pi];
+
+			p._statePrev = p._state;
+			p._activationPrev = p._activation;
+		}
+	}
+
+	for (int pi = 0; pi < _inputPredictionNodes.size(); pi++) {
+		InputPredictionNode &p = _inputPredictionNodes[pi];
+
+		p._statePrev = p._state;
+		p._activationPrev = p._activation;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "RunnerBatch.h"
+
+#include <cmath>
+
+void RunnerBatch::create(int numInstances) {
+	_instances.resize(numInstances);
+
+	_states.assign(numInstances * Runner::_stateSize, 0.0f);
+
+	for (int i = 0; i < _instances.size(); i++)
+		reset(i);
+}
+
+void RunnerBatch::reset(int index) {
+	const float groundWidth = 5000.0f;
+	const float groundHeight = 5.0f;
+
+	// Replace the whole instance, the old runner removes itself from the old world
+	std::shared_ptr<Instance> instance = std::make_shared<Instance>();
+
+	instance->_world = std::make_shared<b2World>(b2Vec2(0.0f, -9.81f));
+
+	b2BodyDef groundBodyDef;
+	groundBodyDef.position.Set(0.0f, 0.0f);
+
+	instance->_pGround = instance->_world->CreateBody(&groundBodyDef);
+
+	b2PolygonShape groundBox;
+	groundBox.SetAsBox(groundWidth * 0.5f, groundHeight * 0.5f);
+
+	instance->_pGround->CreateFixture(&groundBox, 0.0f);
+
+	instance->_runner.createDefault(instance->_world, b2Vec2(0.0f, 2.762f), 0.0f, 1);
+
+	_instances[index] = instance;
+
+	updateState(index);
+}
+
+void RunnerBatch::updateState(int index) {
+	_instances[index]->_runner.getStateVector(&_states[index * Runner::_stateSize]);
+}
+
+void RunnerBatch::step(const std::vector<float> &actions) {
+	sys::parallelFor(_threadPool.get(), _instances.size(), [&](int i) {
+		Instance &instance = *_instances[i];
+
+		instance._runner.motorUpdate(&actions[i * Runner::_actionSize], _interpolateFactor);
+
+		// Keep upright
+		if (std::abs(instance._runner._pBody->GetAngle()) > _maxBodyAngle)
+			instance._runner._pBody->SetAngularVelocity(-_bodyAngleStab * instance._runner._pBody->GetAngle());
+
+		for (int ss = 0; ss < _subSteps; ss++) {
+			instance._world->ClearForces();
+
+			instance._world->Step(_timeStep / _subSteps, _velocityIterations, _positionIterations);
+		}
+
+		updateState(i);
+	});
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Runner.h"
+
+#include <system/ThreadPool.h>
+
+#include <memory>
+
+// K independent worlds with one Runner each, stepped together without any rendering or frame pacing.
+// States and actions of all instances are exchanged through flat arrays
+class RunnerBatch {
+public:
+	struct Instance {
+		std::shared_ptr<b2World> _world;
+
+		b2Body* _pGround;
+
+		// Declared after the world so it is removed from it first
+		Runner _runner;
+
+		Instance()
+			: _pGround(nullptr)
+		{}
+	};
+
+private:
+	std::vector<std::shared_ptr<Instance>> _instances;
+
+	std::vector<float> _states;
+
+	std::shared_ptr<sys::ThreadPool> _threadPool;
+
+	void updateState(int index);
+
+public:
+	float _timeStep;
+	int _subSteps;
+	int _velocityIterations;
+	int _positionIterations;
+	float _interpolateFactor;
+	float _maxBodyAngle;
+	float _bodyAngleStab;
+
+	RunnerBatch()
+		: _timeStep(1.0f / 60.0f),
+		_subSteps(1),
+		_velocityIterations(64),
+		_positionIterations(64),
+		_interpolateFactor(12.0f),
+		_maxBodyAngle(0.3f),
+		_bodyAngleStab(10.0f)
+	{}
+
+	void create(int numInstances);
+
+	void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+		_threadPool = threadPool;
+	}
+
+	// Puts a runner back at the start with a fresh world
+	void reset(int index);
+
+	// Runner::_actionSize actions in [0, 1] per instance. Advances every world by _timeStep and refreshes the states
+	void step(const std::vector<float> &actions);
+
+	int getNumInstances() const {
+		return _instances.size();
+	}
+
+	// Runner::_stateSize values per instance
+	const std::vector<float> &getStates() const {
+		return _states;
+	}
+
+	const float* getState(int index) const {
+		return &_states[index * Runner::_stateSize];
+	}
+
+	// Forward velocity, the usual locomotion reward
+	float getVelocity(int index) const {
+		return _instances[index]->_runner._pBody->GetLinearVelocity().x;
+	}
+
+	Runner &getRunner(int index) {
+		return _instances[index]->_runner;
+	}
+
+	const std::shared_ptr<b2World> &getWorld(int index) const {
+		return _instances[index]->_world;
+	}
+};
\ No newline at end of file
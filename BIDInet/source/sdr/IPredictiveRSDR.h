@@ -1,135 +1,212 @@
-#pragma once
-
-#include "IRSDR.h"
-
-namespace sdr {
-	class IPredictiveRSDR {
-	public:
-		struct Connection {
-			unsigned short _index;
-
-			float _weight;
-		};
-
-		struct LayerDesc {
-			int _width, _height;
-
-			int _receptiveRadius, _recurrentRadius, _lateralRadius, _predictiveRadius, _feedBackRadius;
-
-			float _learnFeedForward, _learnRecurrent, _learnLateral;
-
-			float _learnFeedBack, _learnPrediction;
-
-			int _sdrIterSettle, _sdrIterMeasure;
-			float _sdrLeak;
-			float _sdrLambda;
-			float _sdrHiddenDecay;
-			float _sdrWeightDecay;
-			float _sdrMaxWeightDelta;
-			float _sdrSparsity;
-			float _sdrLearnThreshold;
-			float _sdrNoise;
-			float _sdrBaselineDecay;
-			float _sdrSensitivity;
-
-			LayerDesc()
-				: _width(16), _height(16),
-				_receptiveRadius(3), _recurrentRadius(3), _lateralRadius(3), _predictiveRadius(3), _feedBackRadius(3),
-				_learnFeedForward(0.01f), _learnRecurrent(0.01f), _learnLateral(0.2f),
-				_learnFeedBack(0.05f), _learnPrediction(0.05f),
-				_sdrIterSettle(30), _sdrIterMeasure(5),
-				_sdrLeak(0.3f), _sdrLambda(0.95f), _sdrHiddenDecay(0.01f), _sdrWeightDecay(0.0f), _sdrMaxWeightDelta(0.5f),
-				_sdrSparsity(0.2f), _sdrLearnThreshold(0.02f), _sdrNoise(0.01f),
-				_sdrBaselineDecay(0.01f),
-				_sdrSensitivity(8.0f)
-			{}
-		};
-
-		struct PredictionNode {
-			std::vector<Connection> _feedBackConnections;
-			std::vector<Connection> _predictiveConnections;
-
-			Connection _bias;
-
-			float _state;
-			float _statePrev;
-
-			float _activation;
-			float _activationPrev;
-
-			float _baseline;
-
-			PredictionNode()
-				: _state(0.0f), _statePrev(0.0f), _activation(0.0f), _activationPrev(0.0f), _baseline(0.0f)
-			{}
-		};
-
-		struct InputPredictionNode {
-			std::vector<Connection> _feedBackConnections;
-
-			Connection _bias;
-
-			float _state;
-			float _statePrev;
-
-			float _activation;
-			float _activationPrev;
-
-			InputPredictionNode()
-				: _state(0.0f), _statePrev(0.0f), _activation(0.0f), _activationPrev(0.0f)
-			{}
-		};
-
-		struct Layer {
-			IRSDR _sdr;
-
-			std::vector<PredictionNode> _predictionNodes;
-		};
-
-		static float sigmoid(float x) {
-			return 1.0f / (1.0f + std::exp(-x));
-		}
-
-	private:
-		std::vector<LayerDesc> _layerDescs;
-		std::vector<Layer> _layers;
-
-		std::vector<InputPredictionNode> _inputPredictionNodes;
-
-
-	public:
-		float _learnInputFeedBack;
-
-		IPredictiveRSDR()
-			: _learnInputFeedBack(0.05f)
-		{}
-
-		void createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator);
-
-		void simStep(std::mt19937 &generator, bool learn = true);
-
-		void setInput(int index, float value) {
-			_layers.front()._sdr.setVisibleState(index, value);
-		}
-
-		void setInput(int x, int y, float value) {
-			setInput(x + y * _layerDescs.front()._width, value);
-		}
-
-		float getPrediction(int index) const {
-			return _inputPredictionNodes[index]._state;
-		}
-
-		float getPrediction(int x, int y) const {
-			return getPrediction(x + y * _layers.front()._sdr.getVisibleWidth());
-		}
-
-		const std::vector<LayerDesc> &getLayerDescs() const {
-			return _layerDescs;
-		}
-
-		const std::vector<Layer> &getLayers() const {
-			return _layers;
-		}
-	};
+#pragma once
+
+#include "IRSDR.h"
+
+#include <system/ThreadPool.h>
+
+#include <memory>
+
+namespace sdr {
+	class IPredictiveRSDR {
+	public:
+		struct Connection {
+			unsigned short _index;
+
+			float _weight;
+		};
+
+		struct ReverseConnection {
+			int _node;
+			int _connection;
+		};
+
+		// Connections grouped by the unit they read from. Those of unit u are [_offsets[u], _offsets[u + 1])
+		struct ReverseMap {
+			std::vector<int> _offsets;
+			std::vector<ReverseConnection> _connections;
+		};
+
+		struct LayerDesc {
+			int _width, _height;
+
+			int _receptiveRadius, _recurrentRadius, _lateralRadius, _predictiveRadius, _feedBackRadius;
+
+			float _learnFeedForward, _learnRecurrent, _learnLateral;
+
+			float _learnFeedBack, _learnPrediction;
+
+			int _sdrIterSettle, _sdrIterMeasure;
+			float _sdrLeak;
+			float _sdrLambda;
+			float _sdrHiddenDecay;
+			float _sdrWeightDecay;
+			float _sdrMaxWeightDelta;
+			float _sdrSparsity;
+			float _sdrLearnThreshold;
+			float _sdrNoise;
+			float _sdrBaselineDecay;
+			float _sdrSensitivity;
+
+			LayerDesc()
+				: _width(16), _height(16),
+				_receptiveRadius(3), _recurrentRadius(3), _lateralRadius(3), _predictiveRadius(3), _feedBackRadius(3),
+				_learnFeedForward(0.01f), _learnRecurrent(0.01f), _learnLateral(0.2f),
+				_learnFeedBack(0.05f), _learnPrediction(0.05f),
+				_sdrIterSettle(30), _sdrIterMeasure(5),
+				_sdrLeak(0.3f), _sdrLambda(0.95f), _sdrHiddenDecay(0.01f), _sdrWeightDecay(0.0f), _sdrMaxWeightDelta(0.5f),
+				_sdrSparsity(0.2f), _sdrLearnThreshold(0.02f), _sdrNoise(0.01f),
+				_sdrBaselineDecay(0.01f),
+				_sdrSensitivity(8.0f)
+			{}
+		};
+
+		struct PredictionNode {
+			std::vector<Connection> _feedBackConnections;
+			std::vector<Connection> _predictiveConnections;
+
+			Connection _bias;
+
+			float _state;
+			float _statePrev;
+
+			float _activation;
+			float _activationPrev;
+
+			float _baseline;
+
+			PredictionNode()
+				: _state(0.0f), _statePrev(0.0f), _activation(0.0f), _activationPrev(0.0f), _baseline(0.0f)
+			{}
+		};
+
+		struct InputPredictionNode {
+			std::vector<Connection> _feedBackConnections;
+
+			Connection _bias;
+
+			float _state;
+			float _statePrev;
+
+			float _activation;
+			float _activationPrev;
+
+			InputPredictionNode()
+				: _state(0.0f), _statePrev(0.0f), _activation(0.0f), _activationPrev(0.0f)
+			{}
+		};
+
+		struct Layer {
+			IRSDR _sdr;
+
+			std::vector<PredictionNode> _predictionNodes;
+
+			ReverseMap _feedBackMap;
+			ReverseMap _predictiveMap;
+		};
+
+		static float sigmoid(float x) {
+			return 1.0f / (1.0f + std::exp(-x));
+		}
+
+	private:
+		std::vector<LayerDesc> _layerDescs;
+		std::vector<Layer> _layers;
+
+		std::vector<InputPredictionNode> _inputPredictionNodes;
+
+		ReverseMap _inputFeedBackMap;
+
+		const float* _boundInputs;
+
+		int _stepsSinceRecompute;
+
+		std::vector<float> _predictionErrors;
+
+		// Incremental prediction of one layer and of the inputs
+		void predictIncremental(int l, bool learn, std::vector<float> &rewards);
+		void predictInputsIncremental(bool learn);
+
+		// Fraction of the units read by the prediction nodes of layer l (the input prediction nodes for l < 0) that changed state this step
+		float getInputChange(int l) const;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+	public:
+		float _learnInputFeedBack;
+
+		// Instead of recomputing every prediction node activation, update the previous ones by the weight changes and by the
+		// inputs that changed state. Cost then scales with activity rather than layer size. The incremental pass runs serially,
+		// and every _fullRecomputeInterval steps a full recompute removes the accumulated rounding error.
+		// A layer whose inputs changed by more than _incrementalMaxChange is recomputed in full, which is cheaper then
+		bool _incrementalPrediction;
+		int _fullRecomputeInterval;
+		float _incrementalMaxChange;
+
+		IPredictiveRSDR()
+			: _boundInputs(nullptr), _stepsSinceRecompute(0), _learnInputFeedBack(0.05f),
+			_incrementalPrediction(false), _fullRecomputeInterval(64), _incrementalMaxChange(0.2f)
+		{}
+
+		void createRandom(int inputWidth, int inputHeight, int inputFeedBackRadius, const std::vector<LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator);
+
+		void simStep(std::mt19937 &generator, bool learn = true);
+
+		// Splits the prediction nodes of each layer across the pool, layer by layer. Results do not depend on the number of threads
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+		}
+
+		void setInput(int index, float value) {
+			_layers.front()._sdr.setVisibleState(index, value);
+		}
+
+		void setInput(int x, int y, float value) {
+			setInput(x + y * _layers.front()._sdr.getVisibleWidth(), value);
+		}
+
+		// inputWidth * inputHeight values, row by row
+		void setInputs(const float* inputs) {
+			_layers.front()._sdr.setVisibleStates(inputs);
+		}
+
+		void setInputs(const std::vector<float> &inputs) {
+			setInputs(inputs.data());
+		}
+
+		// Reads the inputs from a caller-owned buffer at the start of every simStep, nullptr unbinds
+		void bindInputs(const float* inputs) {
+			_boundInputs = inputs;
+		}
+
+		float getPrediction(int index) const {
+			return _inputPredictionNodes[index]._state;
+		}
+
+		float getPrediction(int x, int y) const {
+			return getPrediction(x + y * _layers.front()._sdr.getVisibleWidth());
+		}
+
+		void getPredictions(float* predictions) const {
+			for (int i = 0; i < _inputPredictionNodes.size(); i++)
+				predictions[i] = _inputPredictionNodes[i]._state;
+		}
+
+		void getPredictions(std::vector<float> &predictions) const {
+			predictions.resize(_inputPredictionNodes.size());
+
+			getPredictions(predictions.data());
+		}
+
+		int getNumInputs() const {
+			return _inputPredictionNodes.size();
+		}
+
+		const std::vector<LayerDesc> &getLayerDescs() const {
+			return _layerDescs;
+		}
+
+		const std::vector<Layer> &getLayers() const {
+			return _layers;
+		}
+	};
 }
\ No newline at end of file
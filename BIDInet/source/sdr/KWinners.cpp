@@ -0,0 +1,65 @@
+#include "KWinners.h"
+
+#include <algorithm>
+
+using namespace sdr;
+
+void KWinners::inhibit(const float* activations, int width, int height, int radius, float sparsity, float* states) {
+	if (radius >= width - 1 && radius >= height - 1)
+		inhibitGlobal(activations, width, height, sparsity, states);
+	else
+		inhibitLocal(activations, width, height, radius, sparsity, states);
+}
+
+void KWinners::inhibitGlobal(const float* activations, int width, int height, float sparsity, float* states) {
+	int numUnits = width * height;
+
+	// Every unit neighbours every other unit, so the number of neighbours at least as active follows from one sort
+	_sorted.assign(activations, activations + numUnits);
+
+	std::sort(_sorted.begin(), _sorted.end());
+
+	float numActive = sparsity * static_cast<float>(numUnits - 1);
+
+	for (int i = 0; i < numUnits; i++) {
+		int numAtLeast = _sorted.end() - std::lower_bound(_sorted.begin(), _sorted.end(), activations[i]);
+
+		// Do not count the unit itself
+		int inhibition = activations[i] >= activations[i] ? numAtLeast - 1 : numAtLeast;
+
+		states[i] = inhibition < numActive ? 1.0f : 0.0f;
+	}
+}
+
+void KWinners::inhibitLocal(const float* activations, int width, int height, int radius, float sparsity, float* states) {
+	for (int y = 0; y < height; y++) {
+		int yLower = std::max(0, y - radius);
+		int yUpper = std::min(height - 1, y + radius);
+
+		for (int x = 0; x < width; x++) {
+			int xLower = std::max(0, x - radius);
+			int xUpper = std::min(width - 1, x + radius);
+
+			float thisActivation = activations[x + y * width];
+
+			float numActive = sparsity * static_cast<float>((xUpper - xLower + 1) * (yUpper - yLower + 1) - 1);
+
+			// The unit itself is counted by the row scan
+			int inhibition = thisActivation >= thisActivation ? -1 : 0;
+
+			// Rows are contiguous, count a whole row at a time and stop once the unit has lost
+			for (int ly = yLower; ly <= yUpper && inhibition < numActive; ly++) {
+				const float* row = &activations[ly * width];
+
+				int count = 0;
+
+				for (int lx = xLower; lx <= xUpper; lx++)
+					count += row[lx] >= thisActivation ? 1 : 0;
+
+				inhibition += count;
+			}
+
+			states[x + y * width] = inhibition < numActive ? 1.0f : 0.0f;
+		}
+	}
+}
\ No newline at end of file
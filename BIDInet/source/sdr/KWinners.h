@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+namespace sdr {
+	// Local k-winners-take-all over a 2D sheet. A unit is active if fewer than sparsity * (number of neighbours) of its neighbours
+	// within radius (clipped to the sheet, excluding itself) have an activation at least as high as its own. This is the rule
+	// RSDR used to apply by counting over per unit lateral connection lists
+	class KWinners {
+	private:
+		// Sorted activations when the radius covers the whole sheet
+		std::vector<float> _sorted;
+
+		void inhibitGlobal(const float* activations, int width, int height, float sparsity, float* states);
+		void inhibitLocal(const float* activations, int width, int height, int radius, float sparsity, float* states);
+
+	public:
+		// activations and states hold width * height values, row by row
+		void inhibit(const float* activations, int width, int height, int radius, float sparsity, float* states);
+	};
+}
\ No newline at end of file
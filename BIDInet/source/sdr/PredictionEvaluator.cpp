@@ -0,0 +1,151 @@
+#include "PredictionEvaluator.h"
+
+#include <chrono>
+#include <algorithm>
+
+using namespace sdr;
+
+void PredictionEvaluator::evaluate(const Config &config, const data::TimeSeries &dataset, Result &result) const {
+	std::mt19937 generator(config._seed);
+
+	IPredictiveRSDR prsdr;
+
+	prsdr.createRandom(config._inputWidth, config._inputHeight, config._inputFeedBackRadius, config._layerDescs,
+		config._initMinWeight, config._initMaxWeight, config._initMinInhibition, config._initMaxInhibition, config._initThreshold, generator);
+
+	const int numLayers = config._layerDescs.size();
+
+	const int numInputs = prsdr.getNumInputs();
+	const int numUsed = std::min(numInputs, dataset.getNumColumns());
+
+	std::vector<float> inputs(numInputs, 0.0f);
+	std::vector<float> predictions;
+
+	std::vector<std::vector<float>> statesPrev(numLayers);
+
+	for (int l = 0; l < numLayers; l++)
+		statesPrev[l].assign(prsdr.getLayers()[l]._sdr.getNumHidden(), 0.0f);
+
+	result._name = config._name;
+	result._numSteps = 0;
+	result._stepErrors.clear();
+	result._stepErrors.reserve(dataset.getNumRows() * _numPasses);
+	result._sparsities.assign(numLayers, 0.0f);
+	result._stabilities.assign(numLayers, 0.0f);
+
+	double errorSum = 0.0;
+	int numMeasured = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int pass = 0; pass < _numPasses; pass++)
+		for (size_t r = 0; r < dataset.getNumRows(); r++) {
+			for (int i = 0; i < numUsed; i++)
+				inputs[i] = dataset.get(r, i);
+
+			// Error of the prediction made last step for this frame
+			prsdr.getPredictions(predictions);
+
+			float error = 0.0f;
+
+			for (int i = 0; i < numUsed; i++) {
+				float delta = predictions[i] - inputs[i];
+
+				error += delta * delta;
+			}
+
+			error /= std::max(1, numUsed);
+
+			result._stepErrors.push_back(error);
+
+			prsdr.setInputs(inputs);
+
+			prsdr.simStep(generator, _learn);
+
+			bool measure = result._numSteps >= _warmUpSteps;
+
+			if (measure) {
+				errorSum += error;
+
+				numMeasured++;
+			}
+
+			for (int l = 0; l < numLayers; l++) {
+				const IRSDR &sdr = prsdr.getLayers()[l]._sdr;
+
+				int numActive = 0;
+
+				float total = 0.0f;
+				float overlap = 0.0f;
+
+				for (int hi = 0; hi < sdr.getNumHidden(); hi++) {
+					float state = sdr.getHiddenState(hi);
+
+					if (state > 0.0f)
+						numActive++;
+
+					total += state;
+					overlap += std::min(state, statesPrev[l][hi]);
+
+					statesPrev[l][hi] = state;
+				}
+
+				if (measure) {
+					result._sparsities[l] += static_cast<float>(numActive) / std::max(1, sdr.getNumHidden());
+					result._stabilities[l] += total > 0.0f ? overlap / total : 1.0f;
+				}
+			}
+
+			result._numSteps++;
+		}
+
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+	float measuredInv = 1.0f / std::max(1, numMeasured);
+
+	result._meanError = errorSum * measuredInv;
+
+	for (int l = 0; l < numLayers; l++) {
+		result._sparsities[l] *= measuredInv;
+		result._stabilities[l] *= measuredInv;
+	}
+
+	result._stepsPerSecond = seconds > 0.0f ? result._numSteps / seconds : 0.0f;
+}
+
+void PredictionEvaluator::evaluate(const std::vector<Config> &configs, const data::TimeSeries &dataset, std::vector<Result> &results, sys::ThreadPool* pool) const {
+	results.resize(configs.size());
+
+	sys::parallelFor(pool, configs.size(), [&](int i) {
+		evaluate(configs[i], dataset, results[i]);
+	});
+}
+
+void PredictionEvaluator::writeResults(std::ostream &os, const std::vector<Result> &results) {
+	int maxLayers = 0;
+
+	for (int i = 0; i < results.size(); i++)
+		maxLayers = std::max(maxLayers, static_cast<int>(results[i]._sparsities.size()));
+
+	os << "name,steps,meanError,stepsPerSecond";
+
+	for (int l = 0; l < maxLayers; l++)
+		os << ",sparsity" << l << ",stability" << l;
+
+	os << std::endl;
+
+	for (int i = 0; i < results.size(); i++) {
+		const Result &result = results[i];
+
+		os << result._name << "," << result._numSteps << "," << result._meanError << "," << result._stepsPerSecond;
+
+		for (int l = 0; l < maxLayers; l++) {
+			if (l < result._sparsities.size())
+				os << "," << result._sparsities[l] << "," << result._stabilities[l];
+			else
+				os << ",,";
+		}
+
+		os << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "IPredictiveRSDR.h"
+
+#include <data/TimeSeries.h>
+#include <system/ThreadPool.h>
+
+#include <string>
+#include <iostream>
+
+namespace sdr {
+	// Streams a time series through IPredictiveRSDR hierarchies without any window and measures prediction error,
+	// SDR sparsity and stability and throughput. Several configurations can be evaluated at once, one per thread
+	class PredictionEvaluator {
+	public:
+		// Everything needed to create one hierarchy
+		struct Config {
+			std::string _name;
+
+			int _inputWidth, _inputHeight;
+			int _inputFeedBackRadius;
+
+			std::vector<IPredictiveRSDR::LayerDesc> _layerDescs;
+
+			float _initMinWeight, _initMaxWeight;
+			float _initMinInhibition, _initMaxInhibition;
+			float _initThreshold;
+
+			unsigned int _seed;
+
+			Config()
+				: _inputWidth(8), _inputHeight(8), _inputFeedBackRadius(8),
+				_layerDescs(2),
+				_initMinWeight(-0.01f), _initMaxWeight(0.01f),
+				_initMinInhibition(0.01f), _initMaxInhibition(0.05f),
+				_initThreshold(0.1f),
+				_seed(1234)
+			{}
+		};
+
+		struct Result {
+			std::string _name;
+
+			int _numSteps;
+
+			// Squared error of the prediction of every frame, averaged over the inputs the dataset fills
+			std::vector<float> _stepErrors;
+
+			// Averages over the measured steps (all but the warm up)
+			float _meanError;
+
+			// Per layer: fraction of hidden units that are active, and how much of the activity carries over from the previous step
+			std::vector<float> _sparsities;
+			std::vector<float> _stabilities;
+
+			float _stepsPerSecond;
+
+			Result()
+				: _numSteps(0), _meanError(0.0f), _stepsPerSecond(0.0f)
+			{}
+		};
+
+		int _numPasses;
+		int _warmUpSteps;
+		bool _learn;
+
+		PredictionEvaluator()
+			: _numPasses(1), _warmUpSteps(100), _learn(true)
+		{}
+
+		// Row r of the dataset becomes input frame r, columns in order and zeros after them
+		void evaluate(const Config &config, const data::TimeSeries &dataset, Result &result) const;
+
+		// One configuration per task, runs serially when pool is null
+		void evaluate(const std::vector<Config> &configs, const data::TimeSeries &dataset, std::vector<Result> &results, sys::ThreadPool* pool) const;
+
+		// One row per result, comma separated with a header
+		static void writeResults(std::ostream &os, const std::vector<Result> &results);
+	};
+}
\ No newline at end of file
@@ -1,341 +1,340 @@
-#include "QPRSDR.h"
-
-#include <iostream>
-
-using namespace sdr;
-
-void QPRSDR::createRandom(int inputWidth, int inputHeight, int firstLayerPredictionRadius, const std::vector<int> &actionIndices, const std::vector<int> &antiActionIndices, const std::vector<IPredictiveRSDR::LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
-	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
-	
-	_prsdr.createRandom(inputWidth, inputHeight, firstLayerPredictionRadius, layerDescs, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
-
-	_actionNodeIndices.resize(inputWidth * inputHeight);
-	_antiActionNodeIndices.resize(_actionNodeIndices.size());
-
-	for (int i = 0; i < _actionNodeIndices.size(); i++)
-		_actionNodeIndices[i] = -1;
-
-	for (int i = 0; i < actionIndices.size(); i++)
-		_actionNodeIndices[actionIndices[i]] = i;
-
-	for (int i = 0; i < _antiActionNodeIndices.size(); i++)
-		_antiActionNodeIndices[i] = -1;
-
-	for (int i = 0; i < antiActionIndices.size(); i++)
-		_antiActionNodeIndices[antiActionIndices[i]] = i;
-
-	_qConnections.resize(layerDescs.back()._width * layerDescs.back()._height);
-
-	for (int i = 0; i < _qConnections.size(); i++)
-		_qConnections[i]._weight = weightDist(generator) / _qConnections.size();
-
-	_qFunctionLayers.resize(layerDescs.size());
-
-	int widthPrev = inputWidth;
-	int heightPrev = inputHeight;
-
-	for (int l = 0; l < layerDescs.size(); l++) {
-		_qFunctionLayers[l]._qFunctionNodes.resize(layerDescs[l]._width * layerDescs[l]._height);
-
-		int feedForwardSize = std::pow(layerDescs[l]._receptiveRadius * 2 + 1, 2);
-
-		float hiddenToPrevHiddenWidth = static_cast<float>(widthPrev) / static_cast<float>(layerDescs[l]._width);
-		float hiddenToPrevHiddenHeight = static_cast<float>(heightPrev) / static_cast<float>(layerDescs[l]._height);
-
-		for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-			QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-			q._bias._weight = weightDist(generator);
-
-			int hx = qi % layerDescs[l]._width;
-			int hy = qi / layerDescs[l]._width;
-
-			// Feed Forward
-			q._feedForwardConnections.reserve(feedForwardSize);
-
-			int centerX = std::round(hx * hiddenToPrevHiddenWidth);
-			int centerY = std::round(hy * hiddenToPrevHiddenHeight);
-
-			for (int dx = -layerDescs[l]._receptiveRadius; dx <= layerDescs[l]._receptiveRadius; dx++)
-				for (int dy = -layerDescs[l]._receptiveRadius; dy <= layerDescs[l]._receptiveRadius; dy++) {
-					int hox = centerX + dx;
-					int hoy = centerY + dy;
-
-					if (hox >= 0 && hox < widthPrev && hoy >= 0 && hoy < heightPrev) {
-						int hio = hox + hoy * widthPrev;
-
-						Connection c;
-
-						c._weight = weightDist(generator);
-						c._index = hio;
-
-						if (l == 0) {
-							if (_actionNodeIndices[hio] != -1)
-								q._feedForwardConnections.push_back(c);
-						}
-						else {
-							if (!_qFunctionLayers[l - 1]._qFunctionNodes[c._index]._feedForwardConnections.empty())
-								q._feedForwardConnections.push_back(c);
-						}
-					}
-				}
-
-			q._feedForwardConnections.shrink_to_fit();
-		}
-
-		widthPrev = layerDescs[l]._width;
-		heightPrev = layerDescs[l]._height;
-	}
-	
-	_actionNodes.resize(actionIndices.size() + antiActionIndices.size());
-
-	for (int i = 0; i < actionIndices.size(); i++)
-		_actionNodes[i]._inputIndex = actionIndices[i];
-
-	for (int i = 0; i < antiActionIndices.size(); i++)
-		_actionNodes[actionIndices.size() + i]._inputIndex = antiActionIndices[i];
-}
-
-void QPRSDR::simStep(float reward, std::mt19937 &generator, bool learn) {
-	_prsdr.simStep(generator, learn);
-
-	int halfNumActions = _actionNodes.size() / 2;
-
-	// Starting action is predicted action
-	for (int i = 0; i < _actionNodes.size(); i++)
-		_actionNodes[i]._predictedAction = _actionNodes[i]._deriveAction = std::min(1.0f, std::max(-1.0f, _prsdr.getPrediction(_actionNodes[i]._inputIndex)));
-
-	// Derive action
-	for (int iter = 0; iter < _actionDeriveIterations; iter++) {
-		// Feed forward
-		for (int l = 0; l < _qFunctionLayers.size(); l++) {
-			if (l > 0) {
-				int prevLayerIndex = l - 1;
-
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					float sum = 0.0f;// q._bias._weight;
-
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-						sum += q._feedForwardConnections[ci]._weight *_qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._state;
-
-					q._state = sigmoid(sum) * _prsdr.getLayers()[l]._predictionNodes[qi]._state;
-
-					// Zero error for later
-					q._error = 0.0f;
-				}
-			}
-			else {
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					float sum = 0.0f;// q._bias._weight;
-
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-						sum += q._feedForwardConnections[ci]._weight * _actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._deriveAction;
-
-					q._state = sigmoid(sum) * _prsdr.getLayers()[l]._predictionNodes[qi]._state;
-
-					// Zero error for later
-					q._error = 0.0f;
-				}
-			}
-		}
-
-		// Zero action error for later
-		for (int i = 0; i < _actionNodes.size(); i++)
-			_actionNodes[i]._error = 0.0f;
-
-		// Final Q layer
-		float q = 0.0f;
-
-		for (int i = 0; i < _qFunctionLayers.back()._qFunctionNodes.size(); i++)
-			q += _qConnections[i]._weight * _qFunctionLayers.back()._qFunctionNodes[i]._state;
-
-		// Propagate to first layer
-		for (int i = 0; i < _qFunctionLayers.back()._qFunctionNodes.size(); i++)
-			_qFunctionLayers.back()._qFunctionNodes[i]._error = _qConnections[i]._weight;
-
-		// Backpropagate positive Q error
-		for (int l = _qFunctionLayers.size() - 1; l >= 0; l--) {
-			if (l > 0) {
-				int prevLayerIndex = l - 1;
-
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					// Find complete error for this node
-					q._error = q._error * q._state * (1.0f - q._state);// (q._state, _reluLeak);
-
-					// Propagate error to other nodes
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-						_qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._error += q._error * q._feedForwardConnections[ci]._weight;
-				}
-			}
-			else {
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					// Find complete error for this node
-					q._error = q._error * q._state * (1.0f - q._state);
-
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-						_actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._error += q._error * q._feedForwardConnections[ci]._weight;
-				}
-			}
-		}
-
-		// Update derive action
-		for (int i = 0; i < halfNumActions; i++)
-			_actionNodes[i]._deriveAction = std::min(1.0f, std::max(-1.0f, _actionNodes[i]._deriveAction + (_actionNodes[i]._error > 0.0f ? 1.0f : -1.0f) * _actionDeriveAlpha));
-	
-		// Set anti actions
-		for (int i = 0; i < halfNumActions; i++)
-			_actionNodes[halfNumActions + i]._deriveAction = 1.0f - _actionNodes[i]._deriveAction;
-	}
-
-	// Explore
-	std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
-	std::normal_distribution<float> pertDist(0.0f, _explorationStdDev);
-
-	for (int i = 0; i < halfNumActions; i++) {
-		if (dist01(generator) < _explorationBreak)
-			_actionNodes[i]._exploratoryAction = dist01(generator);
-		else
-			_actionNodes[i]._exploratoryAction = std::min(1.0f, std::max(-1.0f, _actionNodes[i]._deriveAction + pertDist(generator)));
-	}
-
-	// Set anti actions
-	for (int i = 0; i < halfNumActions; i++)
-		_actionNodes[halfNumActions + i]._exploratoryAction = 1.0f - _actionNodes[i]._exploratoryAction;
-
-	// Final feed-forward pass to calculate Q
-	for (int l = 0; l < _qFunctionLayers.size(); l++) {
-		if (l > 0) {
-			int prevLayerIndex = l - 1;
-
-			for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-				QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-				float sum = 0.0f;// q._bias._weight;
-
-				for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-					sum += q._feedForwardConnections[ci]._weight *_qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._state;
-
-				q._state = sigmoid(sum) * _prsdr.getLayers()[l]._predictionNodes[qi]._state;
-
-				// Zero erro again
-				q._error = 0.0f;
-			}
-		}
-		else {
-			for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-				QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-				float sum = 0.0f;// q._bias._weight;
-
-				for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-					sum += q._feedForwardConnections[ci]._weight * _actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._exploratoryAction;
-
-				q._state = sigmoid(sum) * _prsdr.getLayers()[l]._predictionNodes[qi]._state;
-
-				// Zero error again
-				q._error = 0.0f;
-			}
-		}
-	}
-
-	float q = 0.0f;
-
-	for (int i = 0; i < _qFunctionLayers.back()._qFunctionNodes.size(); i++)
-		q += _qConnections[i]._weight * _qFunctionLayers.back()._qFunctionNodes[i]._state;
-
-	float tdError = reward + _gamma * q - _prevValue;
-
-	float qAlphaTdError = _qAlpha * tdError;
-	float actionAlphaTdError = _actionAlpha * tdError;
-
-	std::cout << q << std::endl;
-
-	_prevValue = q;
-
-	// Update weights
-	if (learn) {
-		// Propagate to first layer
-		for (int i = 0; i < _qFunctionLayers.back()._qFunctionNodes.size(); i++)
-			_qFunctionLayers.back()._qFunctionNodes[i]._error = _qConnections[i]._weight;
-
-		// Backpropagate positive error
-		for (int l = _qFunctionLayers.size() - 1; l >= 0; l--) {
-			if (l > 0) {
-				int prevLayerIndex = l - 1;
-
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					// Find complete error for this node
-					q._error = q._error * q._state * (1.0f - q._state);
-
-					// Propagate error to other nodes
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-						_qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._error += q._error * q._feedForwardConnections[ci]._weight;
-				}
-			}
-			else {
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					// Find complete error for this node
-					q._error = q._error * q._state * (1.0f - q._state);
-
-					//for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
-					//	_actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._error += q._error * q._feedForwardConnections[ci]._weight;
-				}
-			}
-		}
-
-		// Update weights and traces
-		for (int l = 0; l < _qFunctionLayers.size(); l++) {
-			if (l > 0) {
-				int prevLayerIndex = l - 1;
-
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					q._bias._weight += actionAlphaTdError * q._bias._trace;
-
-					q._bias._trace = _gammaLambda * q._bias._trace + q._error;
-
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++) {
-						q._feedForwardConnections[ci]._weight += actionAlphaTdError * q._feedForwardConnections[ci]._trace;
-							
-						q._feedForwardConnections[ci]._trace = _gammaLambda * q._feedForwardConnections[ci]._trace + q._error * _qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._state;
-					}
-				}
-			}
-			else {
-				for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
-					QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
-
-					q._bias._weight += actionAlphaTdError * q._bias._trace;
-
-					q._bias._trace = _gammaLambda * q._bias._trace + q._error;
-
-					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++) {
-						q._feedForwardConnections[ci]._weight += actionAlphaTdError * q._feedForwardConnections[ci]._trace;
-
-						q._feedForwardConnections[ci]._trace = _gammaLambda * q._feedForwardConnections[ci]._trace + q._error * _actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._exploratoryAction;
-					}
-				}
-			}
-		}
-	}
-
-	// Q connections
-	for (int i = 0; i < _qConnections.size(); i++) {
-		_qConnections[i]._weight += qAlphaTdError * _qConnections[i]._trace;
-
-		_qConnections[i]._trace = _gammaLambda * _qConnections[i]._trace + _qFunctionLayers.back()._qFunctionNodes[i]._state;
-	}
+#include "QPRSDR.h"
+
+#include <iostream>
+
+using namespace sdr;
+
+void QPRSDR::createRandom(int inputWidth, int inputHeight, int firstLayerPredictionRadius, const std::vector<int> &actionIndices, const std::vector<int> &antiActionIndices, const std::vector<IPredictiveRSDR::LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator) {
+	std::uniform_real_distribution<float> weightDist(initMinWeight, initMaxWeight);
+	
+	_prsdr.createRandom(inputWidth, inputHeight, firstLayerPredictionRadius, layerDescs, initMinWeight, initMaxWeight, initMinInhibition, initMaxInhibition, initThreshold, generator);
+
+	_actionNodeIndices.resize(inputWidth * inputHeight);
+	_antiActionNodeIndices.resize(_actionNodeIndices.size());
+
+	for (int i = 0; i < _actionNodeIndices.size(); i++)
+		_actionNodeIndices[i] = -1;
+
+	for (int i = 0; i < actionIndices.size(); i++)
+		_actionNodeIndices[actionIndices[i]] = i;
+
+	for (int i = 0; i < _antiActionNodeIndices.size(); i++)
+		_antiActionNodeIndices[i] = -1;
+
+	for (int i = 0; i < antiActionIndices.size(); i++)
+		_antiActionNodeIndices[antiActionIndices[i]] = i;
+
+	_qConnections.resize(layerDescs.back()._width * layerDescs.back()._height);
+
+	for (int i = 0; i < _qConnections.size(); i++)
+		_qConnections[i]._weight = weightDist(generator) / _qConnections.size();
+
+	_qFunctionLayers.resize(layerDescs.size());
+
+	int widthPrev = inputWidth;
+	int heightPrev = inputHeight;
+
+	for (int l = 0; l < layerDescs.size(); l++) {
+		_qFunctionLayers[l]._qFunctionNodes.resize(layerDescs[l]._width * layerDescs[l]._height);
+
+		int feedForwardSize = std::pow(layerDescs[l]._receptiveRadius * 2 + 1, 2);
+
+		float hiddenToPrevHiddenWidth = static_cast<float>(widthPrev) / static_cast<float>(layerDescs[l]._width);
+		float hiddenToPrevHiddenHeight = static_cast<float>(heightPrev) / static_cast<float>(layerDescs[l]._height);
+
+		for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
+			QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
+
+			q._bias._weight = weightDist(generator);
+
+			int hx = qi % layerDescs[l]._width;
+			int hy = qi / layerDescs[l]._width;
+
+			// Feed Forward
+			q._feedForwardConnections.reserve(feedForwardSize);
+
+			int centerX = std::round(hx * hiddenToPrevHiddenWidth);
+			int centerY = std::round(hy * hiddenToPrevHiddenHeight);
+
+			for (int dx = -layerDescs[l]._receptiveRadius; dx <= layerDescs[l]._receptiveRadius; dx++)
+				for (int dy = -layerDescs[l]._receptiveRadius; dy <= layerDescs[l]._receptiveRadius; dy++) {
+					int hox = centerX + dx;
+					int hoy = centerY + dy;
+
+					if (hox >= 0 && hox < widthPrev && hoy >= 0 && hoy < heightPrev) {
+						int hio = hox + hoy * widthPrev;
+
+						Connection c;
+
+						c._weight = weightDist(generator);
+						c._index = hio;
+
+						if (l == 0) {
+							if (_actionNodeIndices[hio] != -1)
+								q._feedForwardConnections.push_back(c);
+						}
+						else {
+							if (!_qFunctionLayers[l - 1]._qFunctionNodes[c._index]._feedForwardConnections.empty())
+								q._feedForwardConnections.push_back(c);
+						}
+					}
+				}
+
+			q._feedForwardConnections.shrink_to_fit();
+		}
+
+		widthPrev = layerDescs[l]._width;
+		heightPrev = layerDescs[l]._height;
+	}
+	
+	_actionNodes.resize(actionIndices.size() + antiActionIndices.size());
+
+	for (int i = 0; i < actionIndices.size(); i++)
+		_actionNodes[i]._inputIndex = actionIndices[i];
+
+	for (int i = 0; i < antiActionIndices.size(); i++)
+		_actionNodes[actionIndices.size() + i]._inputIndex = antiActionIndices[i];
+
+	_deriveActionsPrev.assign(_actionNodes.size(), 0.0f);
+	_deriveActionsPrev2.assign(_actionNodes.size(), 0.0f);
+	_actionValues.assign(_actionNodes.size() / 2, 0.0f);
+	_exploratoryActions.assign(_actionNodes.size() / 2, 0.0f);
+
+	// Reverse connections, in the order the serial backpropagation used to accumulate errors
+	for (int l = 0; l < _qFunctionLayers.size(); l++)
+		for (int qi = 0; qi < _qFunctionLayers[l]._qFunctionNodes.size(); qi++) {
+			QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
+
+			for (int ci = 0; ci < q._feedForwardConnections.size(); ci++) {
+				ReverseConnection rc;
+
+				rc._nodeIndex = qi;
+				rc._connectionIndex = ci;
+
+				if (l == 0)
+					_actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._reverseConnections.push_back(rc);
+				else
+					_qFunctionLayers[l - 1]._qFunctionNodes[q._feedForwardConnections[ci]._index]._reverseConnections.push_back(rc);
+			}
+		}
+}
+
+float QPRSDR::activateQ(bool exploratory) {
+	for (int l = 0; l < _qFunctionLayers.size(); l++) {
+		// Nodes only read the layer below, so each layer is split across the pool
+		sys::parallelFor(_threadPool.get(), _qFunctionLayers[l]._qFunctionNodes.size(), [&](int qi) {
+			QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
+
+			float sum = 0.0f;// q._bias._weight;
+
+			if (l > 0) {
+				int prevLayerIndex = l - 1;
+
+				for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
+					sum += q._feedForwardConnections[ci]._weight *_qFunctionLayers[prevLayerIndex]._qFunctionNodes[q._feedForwardConnections[ci]._index]._state;
+			}
+			else {
+				for (int ci = 0; ci < q._feedForwardConnections.size(); ci++) {
+					const ActionNode &a = _actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]];
+
+					sum += q._feedForwardConnections[ci]._weight * (exploratory ? a._exploratoryAction : a._deriveAction);
+				}
+			}
+
+			q._state = sigmoid(sum) * _prsdr.getLayers()[l]._predictionNodes[qi]._state;
+
+			// Zero error for later
+			q._error = 0.0f;
+		});
+	}
+
+	// Final Q layer, summed in node order so the result does not depend on the pool
+	float q = 0.0f;
+
+	for (int i = 0; i < _qFunctionLayers.back()._qFunctionNodes.size(); i++)
+		q += _qConnections[i]._weight * _qFunctionLayers.back()._qFunctionNodes[i]._state;
+
+	return q;
+}
+
+void QPRSDR::backpropagateQ(bool toActions) {
+	QFunctionLayer &lastLayer = _qFunctionLayers.back();
+
+	// Propagate to last layer
+	sys::parallelFor(_threadPool.get(), lastLayer._qFunctionNodes.size(), [&](int qi) {
+		QFunctionNode &q = lastLayer._qFunctionNodes[qi];
+
+		q._error = _qConnections[qi]._weight;
+
+		// Find complete error for this node
+		q._error = q._error * q._state * (1.0f - q._state);
+	});
+
+	// Every node gathers the errors of the nodes above that read it, so layers split across the pool without write conflicts
+	for (int l = _qFunctionLayers.size() - 1; l > 0; l--) {
+		const QFunctionLayer &layer = _qFunctionLayers[l];
+
+		sys::parallelFor(_threadPool.get(), _qFunctionLayers[l - 1]._qFunctionNodes.size(), [&](int pi) {
+			QFunctionNode &p = _qFunctionLayers[l - 1]._qFunctionNodes[pi];
+
+			float error = 0.0f;
+
+			for (int ri = 0; ri < p._reverseConnections.size(); ri++) {
+				const QFunctionNode &q = layer._qFunctionNodes[p._reverseConnections[ri]._nodeIndex];
+
+				error += q._error * q._feedForwardConnections[p._reverseConnections[ri]._connectionIndex]._weight;
+			}
+
+			// Find complete error for this node
+			p._error = error * p._state * (1.0f - p._state);
+		});
+	}
+
+	if (toActions) {
+		const QFunctionLayer &layer = _qFunctionLayers.front();
+
+		sys::parallelFor(_threadPool.get(), _actionNodes.size(), [&](int i) {
+			ActionNode &a = _actionNodes[i];
+
+			float error = 0.0f;
+
+			for (int ri = 0; ri < a._reverseConnections.size(); ri++) {
+				const QFunctionNode &q = layer._qFunctionNodes[a._reverseConnections[ri]._nodeIndex];
+
+				error += q._error * q._feedForwardConnections[a._reverseConnections[ri]._connectionIndex]._weight;
+			}
+
+			a._error = error;
+		});
+	}
+}
+
+void QPRSDR::simStep(float reward, std::mt19937 &generator, bool learn) {
+	_prsdr.simStep(generator, learn);
+
+	int halfNumActions = _actionNodes.size() / 2;
+
+	// Starting action is predicted action
+	for (int i = 0; i < _actionNodes.size(); i++)
+		_actionNodes[i]._predictedAction = _actionNodes[i]._deriveAction = std::min(1.0f, std::max(-1.0f, _prsdr.getPrediction(_actionNodes[i]._inputIndex)));
+
+	// Derive action
+	for (int iter = 0; iter < _actionDeriveIterations; iter++) {
+		for (int i = 0; i < _actionNodes.size(); i++) {
+			_deriveActionsPrev2[i] = _deriveActionsPrev[i];
+			_deriveActionsPrev[i] = _actionNodes[i]._deriveAction;
+		}
+
+		activateQ(false);
+
+		// Backpropagate positive Q error
+		backpropagateQ(true);
+
+		// Update derive action
+		for (int i = 0; i < halfNumActions; i++)
+			_actionNodes[i]._deriveAction = std::min(1.0f, std::max(-1.0f, _actionNodes[i]._deriveAction + (_actionNodes[i]._error > 0.0f ? 1.0f : -1.0f) * _actionDeriveAlpha));
+	
+		// Set anti actions
+		for (int i = 0; i < halfNumActions; i++)
+			_actionNodes[halfNumActions + i]._deriveAction = 1.0f - _actionNodes[i]._deriveAction;
+
+		// The Q function does not change while deriving, so once the actions repeat (a fixed point or a cycle of two)
+		// the remaining iterations are known, as in deep::ActionOptimizer
+		bool fixed = true;
+		bool cycle = iter > 0;
+
+		for (int i = 0; i < _actionNodes.size(); i++) {
+			fixed = fixed && _actionNodes[i]._deriveAction == _deriveActionsPrev[i];
+			cycle = cycle && _actionNodes[i]._deriveAction == _deriveActionsPrev2[i];
+		}
+
+		if (fixed || cycle) {
+			if (!fixed && (_actionDeriveIterations - 1 - iter) % 2 == 1)
+				for (int i = 0; i < _actionNodes.size(); i++)
+					_actionNodes[i]._deriveAction = _deriveActionsPrev[i];
+
+			break;
+		}
+	}
+
+	// Explore
+	for (int i = 0; i < halfNumActions; i++)
+		_actionValues[i] = _actionNodes[i]._deriveAction;
+
+	deep::ActionOptimizer::explore(_actionValues.data(), _exploratoryActions.data(), halfNumActions, -1.0f, 1.0f, _explorationStdDev, _explorationBreak, generator);
+
+	for (int i = 0; i < halfNumActions; i++)
+		_actionNodes[i]._exploratoryAction = _exploratoryActions[i];
+
+	// Set anti actions
+	for (int i = 0; i < halfNumActions; i++)
+		_actionNodes[halfNumActions + i]._exploratoryAction = 1.0f - _actionNodes[i]._exploratoryAction;
+
+	// Final feed-forward pass to calculate Q
+	float q = activateQ(true);
+
+	float tdError = reward + _gamma * q - _prevValue;
+
+	float qAlphaTdError = _qAlpha * tdError;
+	float actionAlphaTdError = _actionAlpha * tdError;
+
+	std::cout << q << std::endl;
+
+	_prevValue = q;
+
+	// Update weights
+	if (learn) {
+		backpropagateQ(false);
+
+		_traceStep++;
+
+		// Update weights and traces, every node only changes its own connections
+		for (int l = 0; l < _qFunctionLayers.size(); l++) {
+			sys::parallelFor(_threadPool.get(), _qFunctionLayers[l]._qFunctionNodes.size(), [&](int qi) {
+				QFunctionNode &q = _qFunctionLayers[l]._qFunctionNodes[qi];
+
+				if (_sparseTraces && !q._tracesLive) {
+					if (q._state == 0.0f)
+						return;
+
+					// Trace decay missed since the node was dropped
+					float traceDecay = std::pow(_gammaLambda, _traceStep - 1 - q._traceStamp);
+
+					q._bias._trace *= traceDecay;
+
+					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
+						q._feedForwardConnections[ci]._trace *= traceDecay;
+				}
+
+				q._bias._weight += actionAlphaTdError * q._bias._trace;
+
+				q._bias._trace = _gammaLambda * q._bias._trace + q._error;
+
+				for (int ci = 0; ci < q._feedForwardConnections.size(); ci++) {
+					float input = l > 0 ? _qFunctionLayers[l - 1]._qFunctionNodes[q._feedForwardConnections[ci]._index]._state : _actionNodes[_actionNodeIndices[q._feedForwardConnections[ci]._index]]._exploratoryAction;
+
+					q._feedForwardConnections[ci]._weight += actionAlphaTdError * q._feedForwardConnections[ci]._trace;
+
+					q._feedForwardConnections[ci]._trace = _gammaLambda * q._feedForwardConnections[ci]._trace + q._error * input;
+				}
+
+				if (_sparseTraces) {
+					float maxTrace = std::abs(q._bias._trace);
+
+					for (int ci = 0; ci < q._feedForwardConnections.size(); ci++)
+						maxTrace = std::max(maxTrace, std::abs(q._feedForwardConnections[ci]._trace));
+
+					q._tracesLive = maxTrace > _traceEpsilon;
+					q._traceStamp = _traceStep;
+				}
+			});
+		}
+	}
+
+	// Q connections
+	for (int i = 0; i < _qConnections.size(); i++) {
+		_qConnections[i]._weight += qAlphaTdError * _qConnections[i]._trace;
+
+		_qConnections[i]._trace = _gammaLambda * _qConnections[i]._trace + _qFunctionLayers.back()._qFunctionNodes[i]._state;
+	}
 }
\ No newline at end of file
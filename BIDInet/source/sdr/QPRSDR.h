@@ -1,128 +1,210 @@
-#pragma once
-
-#include "IPredictiveRSDR.h"
-
-#include <algorithm>
-
-namespace sdr {
-	class QPRSDR {
-	public:
-		struct Connection {
-			unsigned short _index;
-
-			float _weight;
-			float _trace;
-
-			Connection()
-				: _trace(0.0f)
-			{}
-		};
-
-		struct QFunctionNode {
-			float _state;
-			float _error;
-
-			Connection _bias;
-			
-			std::vector<Connection> _feedForwardConnections;
-
-			QFunctionNode()
-				: _state(0.0f), _error(0.0f)
-			{}
-		};
-
-		struct QFunctionLayer {
-			std::vector<QFunctionNode> _qFunctionNodes;
-		};
-
-		struct ActionNode {
-			float _predictedAction;
-			float _deriveAction;
-			float _exploratoryAction;
-
-			float _error;
-
-			int _inputIndex;
-
-			ActionNode()
-				: _predictedAction(0.0f),
-				_deriveAction(0.0f),
-				_exploratoryAction(0.0f),
-				_error(0.0f)
-			{}
-		};
-
-	private:
-		IPredictiveRSDR _prsdr;
-
-		std::vector<QFunctionLayer> _qFunctionLayers;
-		std::vector<Connection> _qConnections;
-
-		std::vector<ActionNode> _actionNodes;
-		std::vector<int> _actionNodeIndices;
-		std::vector<int> _antiActionNodeIndices;
-
-		float _prevValue;
-
-	public:
-		static float sigmoid(float x) {
-			return 1.0f / (1.0f + std::exp(-x));
-		}
-
-		static float relu(float x, float leak) {
-			return 1.0f + (x > 0.0f && x < 1.0f ? x : leak * x);
-		}
-
-		static float relud(float x, float leak) {
-			return x > 0.0f && x < 1.0f ? 1.0f : leak;
-		}
-
-		float _qAlpha;
-		float _actionAlpha;
-		int _actionDeriveIterations;
-		float _actionDeriveAlpha;
-		float _reluLeak;
-
-		float _explorationBreak;
-		float _explorationStdDev;
-
-		float _gamma;
-		float _gammaLambda;
-
-		QPRSDR()
-			: _qAlpha(0.01f),
-			_actionAlpha(0.1f),
-			_actionDeriveIterations(32),
-			_actionDeriveAlpha(0.05f),
-			_reluLeak(0.01f),
-			_explorationBreak(0.01f),
-			_explorationStdDev(0.05f),
-			_gamma(0.99f),
-			_gammaLambda(0.98f)
-		{}
-
-		void createRandom(int inputWidth, int inputHeight, int firstLayerPredictionRadius, const std::vector<int> &actionIndices, const std::vector<int> &antiActionIndices, const std::vector<IPredictiveRSDR::LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator);
-
-		void simStep(float reward, std::mt19937 &generator, bool learn = true);
-
-		void setState(int index, float state) {
-			_prsdr.setInput(index, state);
-		}
-
-		void setState(int x, int y, float state) {
-			_prsdr.setInput(x, y, state);
-		}
-
-		float getAction(int index) const {
-			return _actionNodes[_actionNodeIndices[index]]._exploratoryAction;
-		}
-
-		float getAction(int x, int y) const {
-			return _actionNodes[_actionNodeIndices[x + y * _prsdr.getLayers().front()._sdr.getVisibleWidth()]]._exploratoryAction;
-		}
-
-		float getActionRel(int index) const {
-			return _actionNodes[index]._exploratoryAction;
-		}
-	};
+#pragma once
+
+#include "IPredictiveRSDR.h"
+
+#include "../deep/ActionOptimizer.h"
+
+#include <algorithm>
+
+namespace sdr {
+	class QPRSDR {
+	public:
+		struct Connection {
+			unsigned short _index;
+
+			float _weight;
+			float _trace;
+
+			Connection()
+				: _trace(0.0f)
+			{}
+		};
+
+		// Connection _connectionIndex of node _nodeIndex in the layer above
+		struct ReverseConnection {
+			int _nodeIndex;
+			int _connectionIndex;
+		};
+
+		struct QFunctionNode {
+			float _state;
+			float _error;
+
+			Connection _bias;
+			
+			std::vector<Connection> _feedForwardConnections;
+
+			// Feed forward connections of the layer above that read this node
+			std::vector<ReverseConnection> _reverseConnections;
+
+			// Whether the bias and feed forward traces are maintained, and the step they were last
+			bool _tracesLive;
+			int _traceStamp;
+
+			QFunctionNode()
+				: _state(0.0f), _error(0.0f), _tracesLive(true), _traceStamp(0)
+			{}
+		};
+
+		struct QFunctionLayer {
+			std::vector<QFunctionNode> _qFunctionNodes;
+		};
+
+		struct ActionNode {
+			float _predictedAction;
+			float _deriveAction;
+			float _exploratoryAction;
+
+			float _error;
+
+			int _inputIndex;
+
+			// Feed forward connections of the first Q function layer that read this action
+			std::vector<ReverseConnection> _reverseConnections;
+
+			ActionNode()
+				: _predictedAction(0.0f),
+				_deriveAction(0.0f),
+				_exploratoryAction(0.0f),
+				_error(0.0f)
+			{}
+		};
+
+	private:
+		IPredictiveRSDR _prsdr;
+
+		std::vector<QFunctionLayer> _qFunctionLayers;
+		std::vector<Connection> _qConnections;
+
+		std::vector<ActionNode> _actionNodes;
+		std::vector<int> _actionNodeIndices;
+		std::vector<int> _antiActionNodeIndices;
+
+		// Scratch for action derivation and exploration
+		std::vector<float> _deriveActionsPrev;
+		std::vector<float> _deriveActionsPrev2;
+		std::vector<float> _actionValues;
+		std::vector<float> _exploratoryActions;
+
+		float _prevValue;
+
+		// Number of learning steps so far
+		int _traceStep;
+
+		std::shared_ptr<sys::ThreadPool> _threadPool;
+
+		// Activates the Q function layers from the derived or the exploratory actions, returns Q
+		float activateQ(bool exploratory);
+
+		// Errors of the Q function nodes, and of the actions if toActions
+		void backpropagateQ(bool toActions);
+
+	public:
+		static float sigmoid(float x) {
+			return 1.0f / (1.0f + std::exp(-x));
+		}
+
+		static float relu(float x, float leak) {
+			return 1.0f + (x > 0.0f && x < 1.0f ? x : leak * x);
+		}
+
+		static float relud(float x, float leak) {
+			return x > 0.0f && x < 1.0f ? 1.0f : leak;
+		}
+
+		float _qAlpha;
+		float _actionAlpha;
+		int _actionDeriveIterations;
+		float _actionDeriveAlpha;
+		float _reluLeak;
+
+		float _explorationBreak;
+		float _explorationStdDev;
+
+		float _gamma;
+		float _gammaLambda;
+
+		// A Q function node is gated by the state of its prediction node, so while that is 0 the node's error is 0 and its
+		// traces only decay by _gammaLambda. With this set, such a node is dropped once all its traces fell below
+		// _traceEpsilon, and catches up on the missed decay when its prediction node activates again
+		bool _sparseTraces;
+		float _traceEpsilon;
+
+		QPRSDR()
+			: _traceStep(0),
+			_qAlpha(0.01f),
+			_actionAlpha(0.1f),
+			_actionDeriveIterations(32),
+			_actionDeriveAlpha(0.05f),
+			_reluLeak(0.01f),
+			_explorationBreak(0.01f),
+			_explorationStdDev(0.05f),
+			_gamma(0.99f),
+			_gammaLambda(0.98f),
+			_sparseTraces(false),
+			_traceEpsilon(0.0001f)
+		{}
+
+		void createRandom(int inputWidth, int inputHeight, int firstLayerPredictionRadius, const std::vector<int> &actionIndices, const std::vector<int> &antiActionIndices, const std::vector<IPredictiveRSDR::LayerDesc> &layerDescs, float initMinWeight, float initMaxWeight, float initMinInhibition, float initMaxInhibition, float initThreshold, std::mt19937 &generator);
+
+		void simStep(float reward, std::mt19937 &generator, bool learn = true);
+
+		// Splits the Q function layers node by node across the pool, and hands it to the IPredictiveRSDR as well.
+		// Results do not depend on the number of threads
+		void setThreadPool(const std::shared_ptr<sys::ThreadPool> &threadPool) {
+			_threadPool = threadPool;
+
+			_prsdr.setThreadPool(threadPool);
+		}
+
+		void setState(int index, float state) {
+			_prsdr.setInput(index, state);
+		}
+
+		void setState(int x, int y, float state) {
+			_prsdr.setInput(x, y, state);
+		}
+
+		// inputWidth * inputHeight values, row by row
+		void setStates(const float* states) {
+			_prsdr.setInputs(states);
+		}
+
+		void setStates(const std::vector<float> &states) {
+			_prsdr.setInputs(states);
+		}
+
+		// Reads the states from a caller-owned buffer at the start of every simStep, nullptr unbinds
+		void bindStates(const float* states) {
+			_prsdr.bindInputs(states);
+		}
+
+		float getAction(int index) const {
+			return _actionNodes[_actionNodeIndices[index]]._exploratoryAction;
+		}
+
+		float getAction(int x, int y) const {
+			return _actionNodes[_actionNodeIndices[x + y * _prsdr.getLayers().front()._sdr.getVisibleWidth()]]._exploratoryAction;
+		}
+
+		float getActionRel(int index) const {
+			return _actionNodes[index]._exploratoryAction;
+		}
+
+		// All getActionRel values in one go
+		void getActions(float* actions) const {
+			for (int i = 0; i < _actionNodes.size(); i++)
+				actions[i] = _actionNodes[i]._exploratoryAction;
+		}
+
+		void getActions(std::vector<float> &actions) const {
+			actions.resize(getNumActions());
+
+			getActions(actions.data());
+		}
+
+		int getNumActions() const {
+			return _actionNodes.size();
+		}
+	};
 }
\ No newline at end of file
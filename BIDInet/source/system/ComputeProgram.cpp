@@ -0,0 +1,52 @@
+#include "ComputeProgram.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace sys;
+
+bool ComputeProgram::loadFromFile(const std::string &fileName, ComputeSystem &cs, const std::string &options) {
+	std::ifstream fromFile(fileName);
+
+	if (!fromFile.is_open()) {
+		std::cerr << "Could not open " << fileName << std::endl;
+
+		return false;
+	}
+
+	std::stringstream source;
+
+	source << fromFile.rdbuf();
+
+	std::string code = source.str();
+
+	cl::Program::Sources sources(1, std::make_pair(code.c_str(), code.length()));
+
+	_program = cl::Program(cs.getContext(), sources);
+
+	std::vector<cl::Device> devices(1, cs.getDevice());
+
+	if (_program.build(devices, options.c_str()) != CL_SUCCESS) {
+		std::cerr << "Could not build " << fileName << ":" << std::endl;
+		std::cerr << _program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(cs.getDevice()) << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+cl::Kernel ComputeProgram::createKernel(const std::string &name) const {
+	cl_int error;
+
+	cl::Kernel kernel(_program, name.c_str(), &error);
+
+	if (error != CL_SUCCESS) {
+		std::cerr << "Could not create kernel " << name << ": " << error << std::endl;
+
+		return cl::Kernel();
+	}
+
+	return kernel;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ComputeSystem.h"
+
+namespace sys {
+	class ComputeProgram {
+	private:
+		cl::Program _program;
+
+	public:
+		// Builds the program for the device of cs, prints the build log on failure
+		bool loadFromFile(const std::string &fileName, ComputeSystem &cs, const std::string &options = "");
+
+		// Returns a null kernel (and prints why) if it does not exist
+		cl::Kernel createKernel(const std::string &name) const;
+
+		cl::Program &getProgram() {
+			return _program;
+		}
+	};
+}
\ No newline at end of file
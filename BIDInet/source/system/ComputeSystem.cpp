@@ -0,0 +1,52 @@
+#include "ComputeSystem.h"
+
+#include <vector>
+#include <iostream>
+
+using namespace sys;
+
+bool ComputeSystem::create(DeviceType type) {
+	cl_device_type clType = type == _cpu ? CL_DEVICE_TYPE_CPU : (type == _gpu ? CL_DEVICE_TYPE_GPU : CL_DEVICE_TYPE_ALL);
+
+	std::vector<cl::Platform> platforms;
+
+	cl::Platform::get(&platforms);
+
+	for (int pi = 0; pi < platforms.size(); pi++) {
+		std::vector<cl::Device> devices;
+
+		if (platforms[pi].getDevices(clType, &devices) != CL_SUCCESS || devices.empty())
+			continue;
+
+		_platform = platforms[pi];
+		_device = devices.front();
+
+		cl_int error;
+
+		_context = cl::Context(_device, nullptr, nullptr, nullptr, &error);
+
+		if (error != CL_SUCCESS) {
+			std::cerr << "Could not create an OpenCL context: " << error << std::endl;
+
+			return false;
+		}
+
+		_queue = cl::CommandQueue(_context, _device, 0, &error);
+
+		if (error != CL_SUCCESS) {
+			std::cerr << "Could not create an OpenCL command queue: " << error << std::endl;
+
+			return false;
+		}
+
+		return true;
+	}
+
+	std::cerr << "No OpenCL device of the requested type" << std::endl;
+
+	return false;
+}
+
+std::string ComputeSystem::getDeviceName() const {
+	return _device.getInfo<CL_DEVICE_NAME>();
+}
\ No newline at end of file
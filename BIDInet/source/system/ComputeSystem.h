@@ -0,0 +1,50 @@
+#pragma once
+
+#define CL_USE_DEPRECATED_OPENCL_1_2_APIS
+
+#if defined(__APPLE__)
+#include <OpenCL/cl.hpp>
+#else
+#include <CL/cl.hpp>
+#endif
+
+#include <string>
+
+namespace sys {
+	// OpenCL platform, device, context and in-order queue. CPU implementations such as PoCL run the same kernels
+	// as GPUs, so wide layers can be data-parallel without a GPU
+	class ComputeSystem {
+	public:
+		enum DeviceType {
+			_cpu, _gpu, _all
+		};
+
+	private:
+		cl::Platform _platform;
+		cl::Device _device;
+		cl::Context _context;
+		cl::CommandQueue _queue;
+
+	public:
+		// Takes the first device of the requested type over all platforms. Returns false if there is none
+		bool create(DeviceType type);
+
+		std::string getDeviceName() const;
+
+		cl::Platform &getPlatform() {
+			return _platform;
+		}
+
+		cl::Device &getDevice() {
+			return _device;
+		}
+
+		cl::Context &getContext() {
+			return _context;
+		}
+
+		cl::CommandQueue &getQueue() {
+			return _queue;
+		}
+	};
+}
\ No newline at end of file
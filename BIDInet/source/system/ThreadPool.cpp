@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace sys;
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stop = true;
+	}
+
+	_workCondition.notify_all();
+
+	for (int t = 0; t < _workers.size(); t++)
+		_workers[t].join();
+}
+
+void ThreadPool::create(int numWorkers) {
+	if (numWorkers < 0)
+		numWorkers = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+	_workers.reserve(numWorkers);
+
+	for (int t = 0; t < numWorkers; t++)
+		_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+void ThreadPool::runTasks() {
+	int i;
+
+	while ((i = _next++) < _count)
+		(*_task)(i);
+}
+
+void ThreadPool::workerLoop() {
+	unsigned long generation = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			_workCondition.wait(lock, [&] { return _stop || _generation != generation; });
+
+			if (_stop)
+				return;
+
+			generation = _generation;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if (--_pending == 0)
+				_doneCondition.notify_one();
+		}
+	}
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &task) {
+	if (_workers.empty() || count <= 1) {
+		for (int i = 0; i < count; i++)
+			task(i);
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_task = &task;
+		_count = count;
+		_next = 0;
+		_pending = _workers.size();
+
+		_generation++;
+	}
+
+	_workCondition.notify_all();
+
+	runTasks();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_doneCondition.wait(lock, [&] { return _pending == 0; });
+
+	_task = nullptr;
+}
+
+void sys::parallelFor(ThreadPool* pool, int count, const std::function<void(int)> &task) {
+	if (pool != nullptr)
+		pool->parallelFor(count, task);
+	else {
+		for (int i = 0; i < count; i++)
+			task(i);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+
+namespace sys {
+	// Fixed set of worker threads for data-parallel loops. The calling thread takes part in every loop.
+	// Not reentrant: do not call parallelFor from inside a task.
+	class ThreadPool {
+	private:
+		std::vector<std::thread> _workers;
+
+		std::mutex _mutex;
+		std::condition_variable _workCondition;
+		std::condition_variable _doneCondition;
+
+		const std::function<void(int)>* _task;
+		int _count;
+		std::atomic<int> _next;
+		int _pending;
+		unsigned long _generation;
+		bool _stop;
+
+		void workerLoop();
+		void runTasks();
+
+	public:
+		ThreadPool()
+			: _task(nullptr), _count(0), _next(0), _pending(0), _generation(0), _stop(false)
+		{}
+
+		~ThreadPool();
+
+		// numWorkers < 0 uses one worker per hardware thread besides the caller
+		void create(int numWorkers = -1);
+
+		// Runs task(i) for every i in [0, count), returns once all are done
+		void parallelFor(int count, const std::function<void(int)> &task);
+
+		int getNumThreads() const {
+			return _workers.size() + 1;
+		}
+	};
+
+	// Runs serially when pool is null
+	void parallelFor(ThreadPool* pool, int count, const std::function<void(int)> &task);
+}
\ No newline at end of file
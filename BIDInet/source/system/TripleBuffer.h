@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+
+namespace sys {
+	// Lock-free hand-over of the latest value from one producer thread to one consumer thread.
+	// Neither side ever waits: the producer always has a buffer of its own to fill, the consumer always reads the most recent
+	// complete one. Values published faster than they are read are dropped. A write buffer holds stale data, fill it completely
+	template<class T>
+	class TripleBuffer {
+	private:
+		static const int _fresh = 4;
+
+		T _buffers[3];
+
+		// Index of the buffer between the two threads, or'ed with _fresh if the consumer has not seen it yet
+		std::atomic<int> _middle;
+
+		int _write;
+		int _read;
+
+	public:
+		TripleBuffer()
+			: _middle(1), _write(0), _read(2)
+		{}
+
+		// Producer side
+		T &getWriteBuffer() {
+			return _buffers[_write];
+		}
+
+		void publish() {
+			_write = _middle.exchange(_write | _fresh, std::memory_order_acq_rel) & ~_fresh;
+		}
+
+		// True once the last published value has been taken, so the producer can skip building values nobody would see
+		bool isConsumed() const {
+			return (_middle.load(std::memory_order_acquire) & _fresh) == 0;
+		}
+
+		// Consumer side. Returns false (keeping the current read buffer) if nothing new was published
+		bool acquire() {
+			if ((_middle.load(std::memory_order_acquire) & _fresh) == 0)
+				return false;
+
+			_read = _middle.exchange(_read, std::memory_order_acq_rel) & ~_fresh;
+
+			return true;
+		}
+
+		const T &getReadBuffer() const {
+			return _buffers[_read];
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "FrameSource.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace video;
+
+void FrameSource::start(const DecodeFunction &decode, int width, int height, float scale, int capacity) {
+	stop();
+
+	_decode = decode;
+
+	_width = width;
+	_height = height;
+	_scale = scale;
+	_capacity = std::max(1, capacity);
+
+	_frames.clear();
+
+	_finished = false;
+	_stop = false;
+
+	_thread = std::thread(&FrameSource::decodeLoop, this);
+}
+
+void FrameSource::stop() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stop = true;
+	}
+
+	_notFull.notify_all();
+
+	if (_thread.joinable())
+		_thread.join();
+
+	_finished = true;
+}
+
+void FrameSource::decodeLoop() {
+	RawFrame raw;
+
+	std::vector<float> frame;
+
+	while (_decode(raw)) {
+		frame.resize(_width * _height);
+
+		rescaleGray(raw, _scale, _width, _height, frame.data());
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_notFull.wait(lock, [this] { return _stop || _frames.size() < _capacity; });
+
+		if (_stop)
+			break;
+
+		_frames.push_back(std::vector<float>());
+		_frames.back().swap(frame);
+
+		if (!_freeFrames.empty()) {
+			frame.swap(_freeFrames.back());
+
+			_freeFrames.pop_back();
+		}
+
+		lock.unlock();
+
+		_notEmpty.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_finished = true;
+	}
+
+	_notEmpty.notify_all();
+}
+
+bool FrameSource::pop(std::vector<float> &frame) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_notEmpty.wait(lock, [this] { return _finished || !_frames.empty(); });
+
+	if (_frames.empty())
+		return false;
+
+	frame.swap(_frames.front());
+
+	// The caller's old buffer is recycled for decoding
+	if (!_frames.front().empty() && _freeFrames.size() < _capacity)
+		_freeFrames.push_back(std::move(_frames.front()));
+
+	_frames.pop_front();
+
+	lock.unlock();
+
+	_notFull.notify_one();
+
+	return true;
+}
+
+void FrameSource::rescaleGray(const RawFrame &raw, float scale, int width, int height, float* frame) {
+	const float scaleInv = 1.0f / scale;
+	const float channelsInv = 1.0f / (255.0f * raw._channels);
+
+	const int rowSize = raw._width * raw._channels;
+
+	for (int y = 0; y < height; y++) {
+		// Pixel centers of the output mapped into the raw frame, which is centered
+		float sy = (y + 0.5f - height * 0.5f) * scaleInv + raw._height * 0.5f - 0.5f;
+
+		int y0 = std::floor(sy);
+		float fy = sy - y0;
+
+		for (int x = 0; x < width; x++) {
+			float sx = (x + 0.5f - width * 0.5f) * scaleInv + raw._width * 0.5f - 0.5f;
+
+			int x0 = std::floor(sx);
+			float fx = sx - x0;
+
+			float value = 0.0f;
+
+			// Black outside the scaled frame, clamped to its edge inside like texture filtering does
+			if (sx >= -0.5f && sx <= raw._width - 0.5f && sy >= -0.5f && sy <= raw._height - 0.5f) {
+				int xa = std::max(0, x0);
+				int xb = std::min(raw._width - 1, x0 + 1);
+				int ya = std::max(0, y0);
+				int yb = std::min(raw._height - 1, y0 + 1);
+
+				const unsigned char* p00 = &raw._data[ya * rowSize + xa * raw._channels];
+				const unsigned char* p10 = &raw._data[ya * rowSize + xb * raw._channels];
+				const unsigned char* p01 = &raw._data[yb * rowSize + xa * raw._channels];
+				const unsigned char* p11 = &raw._data[yb * rowSize + xb * raw._channels];
+
+				int s00 = 0, s10 = 0, s01 = 0, s11 = 0;
+
+				for (int c = 0; c < raw._channels; c++) {
+					s00 += p00[c];
+					s10 += p10[c];
+					s01 += p01[c];
+					s11 += p11[c];
+				}
+
+				float top = s00 + (s10 - s00) * fx;
+				float bottom = s01 + (s11 - s01) * fx;
+
+				value = (top + (bottom - top) * fy) * channelsInv;
+			}
+
+			frame[x + y * width] = value;
+		}
+	}
+}
\ No newline at end of file
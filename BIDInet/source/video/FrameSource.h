@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace video {
+	// Pipeline stage between a video decoder and a learner. A background thread decodes, rescales and grayscales frames
+	// into a bounded queue of float frames, so decoding the next frames overlaps with learning on the current one
+	class FrameSource {
+	public:
+		// Interleaved 8-bit pixels as the decoder hands them over, row by row
+		struct RawFrame {
+			std::vector<unsigned char> _data;
+			int _width, _height;
+			int _channels;
+
+			RawFrame()
+				: _width(0), _height(0), _channels(0)
+			{}
+		};
+
+		// Fills the next frame, returns false at the end of the stream. Runs on the background thread
+		typedef std::function<bool(RawFrame &raw)> DecodeFunction;
+
+	private:
+		DecodeFunction _decode;
+
+		int _width, _height;
+		float _scale;
+		int _capacity;
+
+		std::deque<std::vector<float>> _frames;
+
+		// Buffers handed back by pop, reused so a running source does not allocate
+		std::vector<std::vector<float>> _freeFrames;
+
+		std::mutex _mutex;
+		std::condition_variable _notEmpty;
+		std::condition_variable _notFull;
+
+		bool _finished;
+		bool _stop;
+
+		std::thread _thread;
+
+		void decodeLoop();
+
+	public:
+		FrameSource()
+			: _width(0), _height(0), _scale(1.0f), _capacity(0), _finished(true), _stop(false)
+		{}
+
+		~FrameSource() {
+			stop();
+		}
+
+		// Output frames are width * height grayscale values in [0, 1]. Raw frames are scaled by scale around their center,
+		// anything outside of them is black. At most capacity frames are queued before the decoder waits
+		void start(const DecodeFunction &decode, int width, int height, float scale, int capacity = 8);
+
+		void stop();
+
+		// Waits for the next frame and swaps it into frame. Returns false once the stream has ended and the queue is empty
+		bool pop(std::vector<float> &frame);
+
+		int getWidth() const {
+			return _width;
+		}
+
+		int getHeight() const {
+			return _height;
+		}
+
+		// Bilinear rescale and channel average into width * height floats
+		static void rescaleGray(const RawFrame &raw, float scale, int width, int height, float* frame);
+	};
+}
\ No newline at end of file
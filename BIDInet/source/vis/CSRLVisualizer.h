@@ -1,17 +1,50 @@
-#pragma once
-
-#include <SFML/Graphics.hpp>
-#include <deep/CSRL.h>
-#include <memory>
-#include <algorithm>
-
-namespace vis {
-	class CSRLVisualizer {
-	private:
-		sf::RenderTexture _rt;
-	public:
-		void create(unsigned int width);
-
-		void update(sf::RenderTexture &target, const sf::Vector2f &position, const sf::Vector2f &scale, const deep::CSRL &csrl, int seed);
-	};
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <deep/CSRL.h>
+#include <memory>
+#include <algorithm>
+
+namespace vis {
+	class CSRLVisualizer {
+	public:
+		// What update draws of a CSRL layer
+		struct Layer {
+			int _width, _height;
+			int _cellsPerColumn;
+
+			std::vector<float> _hiddenStates;
+
+			// [column][cell]
+			std::vector<float> _cellStates;
+
+			Layer()
+				: _width(0), _height(0), _cellsPerColumn(0)
+			{}
+		};
+
+		// Small enough to take every frame, unlike a copy of the CSRL
+		struct State {
+			std::vector<Layer> _layers;
+		};
+
+	private:
+		sf::RenderTexture _rt;
+
+		State _state;
+
+	public:
+		// Copies what update draws into state, reusing its buffers
+		static void capture(const deep::CSRL &csrl, State &state);
+
+		void create(unsigned int width);
+
+		void update(sf::RenderTexture &target, const sf::Vector2f &position, const sf::Vector2f &scale, const State &state, int seed);
+
+		void update(sf::RenderTexture &target, const sf::Vector2f &position, const sf::Vector2f &scale, const deep::CSRL &csrl, int seed) {
+			capture(csrl, _state);
+
+			update(target, position, scale, _state, seed);
+		}
+	};
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "DodgeballVisualizer.h"
+
+#include <algorithm>
+
+void vis::renderDodgeball(sf::RenderTarget &rt, const Dodgeball &dodgeball) {
+	sf::Vector2f size = sf::Vector2f(rt.getSize().x, rt.getSize().y);
+
+	sf::RectangleShape r;
+
+	r.setFillColor(sf::Color::Transparent);
+	r.setOutlineColor(sf::Color::Green);
+	r.setOutlineThickness(size.x * dodgeball._agentFieldOutlineWidth);
+	r.setSize(sf::Vector2f(dodgeball._agentFieldRadius * size.x * 2.0f, dodgeball._agentFieldRadius * size.y * 2.0f));
+
+	r.setOrigin(r.getSize() * 0.5f);
+	r.setPosition(0.5f * size.x, 0.5f * size.y);
+
+	rt.draw(r);
+
+	for (int i = 0; i < dodgeball.getNumBalls(); i++) {
+		sf::CircleShape c;
+
+		c.setRadius(1.0f);
+		c.setOrigin(1.0f, 1.0f);
+		c.setScale(dodgeball._ballRadius * size.x, dodgeball._ballRadius * size.y);
+		c.setPosition(dodgeball.getBall(i)._x * size.x, size.y - dodgeball.getBall(i)._y * size.y);
+		c.setFillColor(sf::Color::Red);
+
+		rt.draw(c);
+	}
+
+	{
+		sf::CircleShape c;
+
+		c.setRadius(1.0f);
+		c.setOrigin(1.0f, 1.0f);
+		c.setScale(dodgeball._agentRadius * size.x, dodgeball._agentRadius * size.y);
+		c.setPosition(dodgeball.getAgentX() * size.x, size.y - dodgeball.getAgentY() * size.y);
+		c.setFillColor(sf::Color::Green);
+
+		rt.draw(c);
+	}
+}
+
+void vis::renderObservation(sf::RenderTarget &rt, const float* observation, int width, int height, float scale) {
+	sf::Image img;
+
+	img.create(width, height);
+
+	for (int x = 0; x < width; x++)
+		for (int y = 0; y < height; y++) {
+			sf::Uint8 v = 255.0f * std::min(1.0f, std::max(0.0f, observation[x + y * width]));
+
+			img.setPixel(x, y, sf::Color(v, v, v));
+		}
+
+	sf::Texture tex;
+
+	tex.loadFromImage(img);
+
+	sf::Sprite s;
+
+	s.setTexture(tex);
+
+	s.setScale(scale, scale);
+
+	rt.draw(s);
+}
+
+void vis::renderDodgeballSnapshot(sf::RenderTarget &rt, const DodgeballSnapshot &snapshot, float observationScale) {
+	renderDodgeball(rt, snapshot._dodgeball);
+
+	if (!snapshot._observation.empty())
+		renderObservation(rt, snapshot._observation.data(), snapshot._observationWidth, snapshot._observationHeight, observationScale);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <dodgeball/Dodgeball.h>
+
+#include <vector>
+
+namespace vis {
+	// Copy of the game and what the agent saw, for drawing on a VisualizationThread
+	struct DodgeballSnapshot {
+		Dodgeball _dodgeball;
+		std::vector<float> _observation;
+		int _observationWidth, _observationHeight;
+
+		DodgeballSnapshot()
+			: _observationWidth(0), _observationHeight(0)
+		{}
+
+		void set(const Dodgeball &dodgeball, const std::vector<float> &observation, int observationWidth, int observationHeight) {
+			_dodgeball = dodgeball;
+			_observation = observation;
+			_observationWidth = observationWidth;
+			_observationHeight = observationHeight;
+		}
+	};
+
+	// Window view of the game, the agent itself observes the CPU rasterization
+	void renderDodgeball(sf::RenderTarget &rt, const Dodgeball &dodgeball);
+
+	// Draws a rasterized observation as a grayscale image
+	void renderObservation(sf::RenderTarget &rt, const float* observation, int width, int height, float scale);
+
+	// Game with the observation in the corner
+	void renderDodgeballSnapshot(sf::RenderTarget &rt, const DodgeballSnapshot &snapshot, float observationScale);
+}
\ No newline at end of file
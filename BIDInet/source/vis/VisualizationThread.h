@@ -0,0 +1,128 @@
+#pragma once
+
+#include <SFML/Window.hpp>
+#include <SFML/Graphics.hpp>
+
+#include <system/TripleBuffer.h>
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <string>
+
+namespace vis {
+	// Owns a window on its own thread and draws the latest snapshot the learner published. Vsync only paces this thread:
+	// the learner fills a snapshot when the previous one has been drawn (wantsSnapshot) and otherwise keeps going, while
+	// the window redraws the last snapshot it got
+	template<class Snapshot>
+	class VisualizationThread {
+	public:
+		// Both run on the visualization thread, so GPU resources (textures, render textures) belong in init
+		typedef std::function<void(sf::RenderWindow &window)> InitFunction;
+		typedef std::function<void(sf::RenderWindow &window, const Snapshot &snapshot)> RenderFunction;
+
+	private:
+		sys::TripleBuffer<Snapshot> _snapshots;
+
+		std::thread _thread;
+
+		std::atomic<bool> _stop;
+		std::atomic<bool> _closed;
+
+		void run(unsigned int width, unsigned int height, const std::string &title, const InitFunction &init, const RenderFunction &render);
+
+	public:
+		VisualizationThread()
+			: _stop(false), _closed(false)
+		{}
+
+		~VisualizationThread() {
+			stop();
+		}
+
+		void start(unsigned int width, unsigned int height, const std::string &title, const InitFunction &init, const RenderFunction &render);
+
+		void stop();
+
+		// Learner side: only fill and publish a snapshot when this is true
+		bool wantsSnapshot() const {
+			return _snapshots.isConsumed();
+		}
+
+		Snapshot &getSnapshot() {
+			return _snapshots.getWriteBuffer();
+		}
+
+		void publish() {
+			_snapshots.publish();
+		}
+
+		// Window closed or escape pressed
+		bool isClosed() const {
+			return _closed;
+		}
+	};
+
+	template<class Snapshot>
+	void VisualizationThread<Snapshot>::start(unsigned int width, unsigned int height, const std::string &title, const InitFunction &init, const RenderFunction &render) {
+		stop();
+
+		_stop = false;
+		_closed = false;
+
+		_thread = std::thread(&VisualizationThread<Snapshot>::run, this, width, height, title, init, render);
+	}
+
+	template<class Snapshot>
+	void VisualizationThread<Snapshot>::stop() {
+		_stop = true;
+
+		if (_thread.joinable())
+			_thread.join();
+	}
+
+	template<class Snapshot>
+	void VisualizationThread<Snapshot>::run(unsigned int width, unsigned int height, const std::string &title, const InitFunction &init, const RenderFunction &render) {
+		sf::RenderWindow window;
+
+		sf::ContextSettings glContextSettings;
+		glContextSettings.antialiasingLevel = 4;
+
+		window.create(sf::VideoMode(width, height), title, sf::Style::Default, glContextSettings);
+
+		window.setFramerateLimit(60);
+		window.setVerticalSyncEnabled(true);
+
+		if (init)
+			init(window);
+
+		bool hasSnapshot = false;
+
+		while (!_stop) {
+			sf::Event windowEvent;
+
+			while (window.pollEvent(windowEvent)) {
+				if (windowEvent.type == sf::Event::Closed)
+					_closed = true;
+			}
+
+			if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
+				_closed = true;
+
+			if (_closed)
+				break;
+
+			if (_snapshots.acquire())
+				hasSnapshot = true;
+
+			window.clear();
+
+			if (hasSnapshot)
+				render(window, _snapshots.getReadBuffer());
+
+			window.display();
+		}
+
+		window.close();
+	}
+}
\ No newline at end of file